@@ -0,0 +1,284 @@
+#ifndef CTH_FROZEN_TABLE_H
+#define CTH_FROZEN_TABLE_H
+
+/*
+ * C reader for frozen table images (docs/frozen_format.md), the same files
+ * MappedHashTable reads in C++ and the frozen-table crate reads in Rust.
+ * Header-only C99, also valid C++. Lookups read the image in place, so a
+ * file mapped with cth_frozen_open() shares its pages with every process,
+ * whatever language it is written in, mapping the same file.
+ *
+ *     cth_frozen_table colors;
+ *     if (cth_frozen_open(&colors, "colors.frozen") != CTH_FROZEN_OK) ...;
+ *     const void* value;
+ *     size_t value_size;
+ *     if (cth_frozen_get(&colors, "red", 3, &value, &value_size) == 1) ...;
+ *     cth_frozen_close(&colors);
+ *
+ * Keys are looked up by their encoded bytes: strings as their bytes,
+ * integers as their little-endian bytes at their width (see
+ * cth_frozen_store_u32/u64).
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/* cth_frozen_open() needs POSIX: under a strict -std=c99, also define
+ * _POSIX_C_SOURCE=200809L. */
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CTH_FROZEN_HAVE_MMAP 1
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CTH_FROZEN_VERSION 1u
+#define CTH_FROZEN_HEADER_SIZE 80u
+#define CTH_FROZEN_ENTRY_SIZE 32u
+
+enum {
+    CTH_FROZEN_OK = 0,
+    CTH_FROZEN_EIO = -1,     /* the file cannot be opened or mapped */
+    CTH_FROZEN_EFORMAT = -2, /* not a valid frozen image */
+};
+
+typedef struct cth_frozen_table {
+    const uint8_t* image;
+    size_t image_size;
+    int owns_mapping;
+    uint64_t seed;
+    uint64_t bucket_mask;
+    uint64_t entry_count;
+    const uint8_t* buckets;
+    const uint8_t* entries;
+    const uint8_t* blob;
+    uint64_t blob_size;
+} cth_frozen_table;
+
+
+/* Little-endian loads and stores, independent of the host's byte order. */
+static inline uint32_t cth_frozen_load_u32(const void* p) {
+    const uint8_t* b = (const uint8_t*)p;
+    return (uint32_t)b[0] | (uint32_t)b[1] << 8 | (uint32_t)b[2] << 16 | (uint32_t)b[3] << 24;
+}
+
+static inline uint64_t cth_frozen_load_u64(const void* p) {
+    const uint8_t* b = (const uint8_t*)p;
+    return (uint64_t)cth_frozen_load_u32(b) | (uint64_t)cth_frozen_load_u32(b + 4) << 32;
+}
+
+static inline void cth_frozen_store_u32(void* p, uint32_t v) {
+    uint8_t* b = (uint8_t*)p;
+    for (int k = 0; k < 4; ++k) b[k] = (uint8_t)(v >> (8 * k));
+}
+
+static inline void cth_frozen_store_u64(void* p, uint64_t v) {
+    uint8_t* b = (uint8_t*)p;
+    for (int k = 0; k < 8; ++k) b[k] = (uint8_t)(v >> (8 * k));
+}
+
+
+/* wyhash (final4), bit for bit hash_policy::wyhash in C++. */
+static inline void cth__mum(uint64_t* a, uint64_t* b) {
+#if defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 cth__u128;
+    cth__u128 r = (cth__u128)*a * *b;
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+#else
+    uint64_t ha = *a >> 32, hb = *b >> 32, la = (uint32_t)*a, lb = (uint32_t)*b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32);
+    uint64_t c = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    *a = lo;
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+static inline uint64_t cth__mix(uint64_t a, uint64_t b) {
+    cth__mum(&a, &b);
+    return a ^ b;
+}
+
+static inline uint64_t cth__read3(const uint8_t* p, size_t k) {
+    return (uint64_t)p[0] << 16 | (uint64_t)p[k >> 1] << 8 | (uint64_t)p[k - 1];
+}
+
+static inline uint64_t cth_wyhash(const void* key, size_t len, uint64_t seed) {
+    static const uint64_t wyp[4] = {
+        0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull,
+    };
+    const uint8_t* p = (const uint8_t*)key;
+    uint64_t a = 0, b = 0;
+    seed ^= cth__mix(seed ^ wyp[0], wyp[1]);
+    if (len <= 16) {
+        if (len >= 4) {
+            a = (uint64_t)cth_frozen_load_u32(p) << 32 | cth_frozen_load_u32(p + ((len >> 3) << 2));
+            b = (uint64_t)cth_frozen_load_u32(p + len - 4) << 32 |
+                cth_frozen_load_u32(p + len - 4 - ((len >> 3) << 2));
+        } else if (len > 0) {
+            a = cth__read3(p, len);
+        }
+    } else {
+        size_t i = len;
+        if (i >= 48) {
+            uint64_t see1 = seed, see2 = seed;
+            do {
+                seed = cth__mix(cth_frozen_load_u64(p) ^ wyp[1], cth_frozen_load_u64(p + 8) ^ seed);
+                see1 = cth__mix(cth_frozen_load_u64(p + 16) ^ wyp[2], cth_frozen_load_u64(p + 24) ^ see1);
+                see2 = cth__mix(cth_frozen_load_u64(p + 32) ^ wyp[3], cth_frozen_load_u64(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i >= 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = cth__mix(cth_frozen_load_u64(p) ^ wyp[1], cth_frozen_load_u64(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = cth_frozen_load_u64(p + i - 16);
+        b = cth_frozen_load_u64(p + i - 8);
+    }
+    a ^= wyp[1];
+    b ^= seed;
+    cth__mum(&a, &b);
+    return cth__mix(a ^ wyp[0] ^ len, b ^ wyp[1]);
+}
+
+
+/*
+ * Read an image already in memory; the bytes must outlive the table.
+ * Checks the header and every section against `size`, so a truncated or
+ * corrupt image is rejected here (CTH_FROZEN_EFORMAT) rather than read out
+ * of bounds later.
+ */
+static inline int cth_frozen_view(cth_frozen_table* t, const void* data, size_t size) {
+    const uint8_t* image = (const uint8_t*)data;
+    uint64_t bucket_count, buckets_offset, entries_offset, blob_offset;
+    memset(t, 0, sizeof(*t));
+    if (size < CTH_FROZEN_HEADER_SIZE) return CTH_FROZEN_EFORMAT;
+    if (memcmp(image, "CTHFROZ", 8) != 0) return CTH_FROZEN_EFORMAT;
+    if (cth_frozen_load_u32(image + 8) != CTH_FROZEN_VERSION) return CTH_FROZEN_EFORMAT;
+
+    t->seed = cth_frozen_load_u64(image + 16);
+    bucket_count = cth_frozen_load_u64(image + 24);
+    t->entry_count = cth_frozen_load_u64(image + 32);
+    buckets_offset = cth_frozen_load_u64(image + 40);
+    entries_offset = cth_frozen_load_u64(image + 48);
+    blob_offset = cth_frozen_load_u64(image + 56);
+    t->blob_size = cth_frozen_load_u64(image + 64);
+
+    if (bucket_count == 0 || (bucket_count & (bucket_count - 1)) != 0) return CTH_FROZEN_EFORMAT;
+    if (t->entry_count > UINT32_MAX || bucket_count > size) return CTH_FROZEN_EFORMAT;
+    if (buckets_offset > size || (bucket_count + 1) * 4 > size - buckets_offset) return CTH_FROZEN_EFORMAT;
+    if (entries_offset > size || t->entry_count * CTH_FROZEN_ENTRY_SIZE > size - entries_offset) {
+        return CTH_FROZEN_EFORMAT;
+    }
+    if (blob_offset > size || t->blob_size > size - blob_offset) return CTH_FROZEN_EFORMAT;
+
+    t->image = image;
+    t->image_size = size;
+    t->bucket_mask = bucket_count - 1;
+    t->buckets = image + buckets_offset;
+    t->entries = image + entries_offset;
+    t->blob = image + blob_offset;
+    if (cth_frozen_load_u32(t->buckets) != 0 ||
+        cth_frozen_load_u32(t->buckets + 4 * bucket_count) != t->entry_count) {
+        memset(t, 0, sizeof(*t));
+        return CTH_FROZEN_EFORMAT;
+    }
+    return CTH_FROZEN_OK;
+}
+
+#ifdef CTH_FROZEN_HAVE_MMAP
+/* Map a frozen image file read-only. Release it with cth_frozen_close(). */
+static inline int cth_frozen_open(cth_frozen_table* t, const char* path) {
+    struct stat st;
+    void* data;
+    int result;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    memset(t, 0, sizeof(*t));
+    if (fd < 0) return CTH_FROZEN_EIO;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return CTH_FROZEN_EIO;
+    }
+    if (st.st_size < (off_t)CTH_FROZEN_HEADER_SIZE) {
+        close(fd);
+        return CTH_FROZEN_EFORMAT;
+    }
+    data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return CTH_FROZEN_EIO;
+    result = cth_frozen_view(t, data, (size_t)st.st_size);
+    if (result != CTH_FROZEN_OK) {
+        munmap(data, (size_t)st.st_size);
+        return result;
+    }
+    t->owns_mapping = 1;
+    return CTH_FROZEN_OK;
+}
+#endif
+
+/* Unmap a table from cth_frozen_open(); harmless on views. */
+static inline void cth_frozen_close(cth_frozen_table* t) {
+#ifdef CTH_FROZEN_HAVE_MMAP
+    if (t->owns_mapping && t->image) munmap((void*)t->image, t->image_size);
+#endif
+    memset(t, 0, sizeof(*t));
+}
+
+static inline uint64_t cth_frozen_size(const cth_frozen_table* t) { return t->entry_count; }
+
+/*
+ * Look up the key bytes [key, key + key_size). Returns 1 and points *value
+ * at the value bytes inside the image if found, 0 if absent, and
+ * CTH_FROZEN_EFORMAT if the entries examined are corrupt.
+ */
+static inline int cth_frozen_get(const cth_frozen_table* t, const void* key, size_t key_size,
+                                 const void** value, size_t* value_size) {
+    uint64_t h, b;
+    uint32_t first, last, i;
+    if (t->image == NULL) return 0;
+    h = cth_wyhash(key, key_size, t->seed);
+    b = h & t->bucket_mask;
+    first = cth_frozen_load_u32(t->buckets + 4 * b);
+    last = cth_frozen_load_u32(t->buckets + 4 * (b + 1));
+    if (last > t->entry_count) return CTH_FROZEN_EFORMAT;
+
+    for (i = first; i < last; ++i) {
+        const uint8_t* entry = t->entries + (size_t)CTH_FROZEN_ENTRY_SIZE * i;
+        uint64_t key_offset, value_offset;
+        uint32_t stored_key_size, stored_value_size;
+        if (cth_frozen_load_u64(entry) != h) continue;
+        key_offset = cth_frozen_load_u64(entry + 8);
+        value_offset = cth_frozen_load_u64(entry + 16);
+        stored_key_size = cth_frozen_load_u32(entry + 24);
+        stored_value_size = cth_frozen_load_u32(entry + 28);
+        if (key_offset > t->blob_size || stored_key_size > t->blob_size - key_offset ||
+            value_offset > t->blob_size || stored_value_size > t->blob_size - value_offset) {
+            return CTH_FROZEN_EFORMAT;
+        }
+        if (stored_key_size != key_size) continue;
+        if (key_size != 0 && memcmp(t->blob + key_offset, key, key_size) != 0) continue;
+        *value = t->blob + value_offset;
+        *value_size = stored_value_size;
+        return 1;
+    }
+    return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CTH_FROZEN_TABLE_H */
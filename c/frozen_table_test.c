@@ -0,0 +1,115 @@
+/*
+ * Checks the C reader against the shared golden image:
+ *
+ *     frozen_table_test testdata/frozen_v1.tsv testdata/frozen_v1.bin
+ *
+ * The image holds the TSV's string keys with u32 values, seed 42; every
+ * key must be found with its value, and the hash test vectors of
+ * docs/frozen_format.md must come out bit for bit.
+ */
+#include "frozen_table.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                    \
+    do {                                                               \
+        if (!(cond)) {                                                 \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++failures;                                                \
+        }                                                              \
+    } while (0)
+
+static void check_hash_vectors(void) {
+    static const struct {
+        size_t len;
+        uint64_t seed0, seed42;
+    } vectors[] = {
+        {0, 0x93228a4de0eec5a2ull, 0x2ac44db3deb05300ull},
+        {1, 0x8e6d4af7d310c8c4ull, 0x033b5aab97d9c425ull},
+        {3, 0x78c4aa0c972a522dull, 0xce9d66a797307f94ull},
+        {4, 0xe08aeeb68058fb32ull, 0xd97d61b5206c8513ull},
+        {8, 0xb4d6ac74d009e1d4ull, 0x3ed6827b249c2f37ull},
+        {15, 0x87edaf96d89a08efull, 0xa3945aeea738f410ull},
+        {16, 0x305fdea0ed4a2619ull, 0x9dbc2356533b4014ull},
+        {17, 0xd29ffdd201a46f9aull, 0x56e46ac1a9175c52ull},
+        {47, 0xe2cb58f6ab8e4419ull, 0xff37cfbd5256d21cull},
+        {48, 0xecbfb7ff9e3d9a97ull, 0x827717ed2564ebb4ull},
+        {49, 0x0691f11bac523a91ull, 0x7815fc5b6d4b56bcull},
+        {96, 0x948137d69794b570ull, 0x174effdbb7ffa0b0ull},
+        {100, 0x77ed9a7dfb9ac9b7ull, 0x8ad7f73a16686981ull},
+        {256, 0x139c96a974ad43cbull, 0xf9a18ee9194a4507ull},
+    };
+    uint8_t bytes[256];
+    size_t i;
+    for (i = 0; i < sizeof(bytes); ++i) bytes[i] = (uint8_t)i;
+    for (i = 0; i < sizeof(vectors) / sizeof(vectors[0]); ++i) {
+        CHECK(cth_wyhash(bytes, vectors[i].len, 0) == vectors[i].seed0);
+        CHECK(cth_wyhash(bytes, vectors[i].len, 42) == vectors[i].seed42);
+    }
+}
+
+static void check_golden(const char* tsv_path, const char* image_path) {
+    cth_frozen_table table;
+    char line[512];
+    size_t lines = 0;
+    const void* value;
+    size_t value_size;
+    FILE* tsv = fopen(tsv_path, "rb");
+    CHECK(tsv != NULL);
+    CHECK(cth_frozen_open(&table, image_path) == CTH_FROZEN_OK);
+    if (!tsv || !table.image) return;
+
+    while (fgets(line, sizeof(line), tsv)) {
+        char* tab = strchr(line, '\t');
+        size_t end = strcspn(line, "\r\n");
+        line[end] = '\0';
+        if (end == 0) continue;
+        CHECK(tab != NULL);
+        if (!tab) continue;
+        ++lines;
+        CHECK(cth_frozen_get(&table, line, (size_t)(tab - line), &value, &value_size) == 1);
+        CHECK(value_size == 4);
+        CHECK(cth_frozen_load_u32(value) == (uint32_t)strtoul(tab + 1, NULL, 10));
+    }
+    fclose(tsv);
+    CHECK(cth_frozen_size(&table) == lines);
+    CHECK(table.seed == 42);
+    CHECK(cth_frozen_get(&table, "nope", 4, &value, &value_size) == 0);
+    CHECK(cth_frozen_get(&table, "re", 2, &value, &value_size) == 0);
+    CHECK(cth_frozen_get(&table, "red\0", 4, &value, &value_size) == 0);
+
+    /* Corrupt copies are rejected up front. */
+    {
+        uint8_t* copy = (uint8_t*)malloc(table.image_size);
+        cth_frozen_table bad;
+        memcpy(copy, table.image, table.image_size);
+        CHECK(cth_frozen_view(&bad, copy, table.image_size) == CTH_FROZEN_OK);
+        CHECK(cth_frozen_view(&bad, copy, table.image_size - 8) == CTH_FROZEN_EFORMAT);
+        CHECK(cth_frozen_view(&bad, copy, 40) == CTH_FROZEN_EFORMAT);
+        copy[8] = 2; /* version */
+        CHECK(cth_frozen_view(&bad, copy, table.image_size) == CTH_FROZEN_EFORMAT);
+        copy[8] = 1;
+        cth_frozen_store_u64(copy + 24, 3); /* bucket count */
+        CHECK(cth_frozen_view(&bad, copy, table.image_size) == CTH_FROZEN_EFORMAT);
+        CHECK(bad.image == NULL && cth_frozen_get(&bad, "red", 3, &value, &value_size) == 0);
+        free(copy);
+    }
+    cth_frozen_close(&table);
+    CHECK(cth_frozen_open(&table, "/nonexistent/frozen.bin") == CTH_FROZEN_EIO);
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s GOLDEN.tsv GOLDEN.bin\n", argv[0]);
+        return 2;
+    }
+    check_hash_vectors();
+    check_golden(argv[1], argv[2]);
+    if (failures) return 1;
+    printf("C frozen table test passed.\n");
+    return 0;
+}
@@ -0,0 +1,66 @@
+#ifndef CAPACITY_POLICY_HPP
+#define CAPACITY_POLICY_HPP
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#include "hash_policy.hpp"
+
+// Capacity policies decide how a table grows and how a (well-mixed) hash is
+// reduced to a bucket index. Both avoid a runtime 64-bit division:
+//
+//   grow(capacity)           capacity to use after growing from `capacity`
+//   reduce(hash, capacity)   bucket index for a runtime capacity
+//   reduce_fixed<n>(hash)    bucket index for a compile-time capacity, which
+//                            the compiler strength-reduces to shifts and
+//                            multiplies
+//   partition(hash, n)       index among n (a power of two) independent
+//                            tables, taken from the bits reduce() depends
+//                            on least, so the entries of one partition
+//                            still spread over all of its buckets
+//
+// Masking only looks at the low bits and fastrange only at the high bits of
+// the hash, so callers are expected to mix weak hashes first (see
+// hash_policy::finalize).
+
+// Lemire's fastrange: maps hash uniformly onto [0, n) with one multiply.
+constexpr size_t fastrange(uint64_t hash, uint64_t n) {
+#if defined(__SIZEOF_INT128__)
+    return static_cast<size_t>((static_cast<__uint128_t>(hash) * n) >> 64);
+#else
+    uint64_t lo = hash, hi = n;
+    hash_policy::detail::mul128(lo, hi);
+    return static_cast<size_t>(hi);
+#endif
+}
+
+// Capacities are powers of two and indices are `hash & (capacity - 1)`.
+struct PowerOfTwoCapacity {
+    static constexpr size_t grow(size_t capacity) { return std::bit_ceil(capacity * 2); }
+
+    static constexpr size_t reduce(uint64_t hash, size_t capacity) {
+        return static_cast<size_t>(hash & (capacity - 1));
+    }
+
+    template <size_t n>
+    static constexpr size_t reduce_fixed(uint64_t hash) { return static_cast<size_t>(hash % n); }
+
+    static constexpr size_t partition(uint64_t hash, size_t n) {
+        return n == 1 ? 0 : static_cast<size_t>(hash >> (64 - std::countr_zero(n)));
+    }
+};
+
+// Capacities double and indices use fastrange, so any size works.
+struct FastRangeCapacity {
+    static constexpr size_t grow(size_t capacity) { return capacity * 2; }
+
+    static constexpr size_t reduce(uint64_t hash, size_t capacity) { return fastrange(hash, capacity); }
+
+    template <size_t n>
+    static constexpr size_t reduce_fixed(uint64_t hash) { return fastrange(hash, n); }
+
+    static constexpr size_t partition(uint64_t hash, size_t n) { return static_cast<size_t>(hash & (n - 1)); }
+};
+
+#endif // CAPACITY_POLICY_HPP
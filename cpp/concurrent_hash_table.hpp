@@ -0,0 +1,271 @@
+#ifndef CONCURRENT_HASH_TABLE_HPP
+#define CONCURRENT_HASH_TABLE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "capacity_policy.hpp"
+#include "epoch.hpp"
+#include "hash_policy.hpp"
+
+
+// Chained hash table for read-mostly data shared between threads.
+//
+// The layout is HashTable's: buckets of singly linked nodes, with the same
+// hash mixing and Capacity policy. The difference is that every link is
+// atomic and a published node is never modified:
+//
+//   - get/contains/visit take no lock and never wait. They run inside an
+//     EpochGuard, load the current bucket array and walk one chain.
+//   - Writers serialize on a mutex, which readers never touch. Inserting
+//     links a new node at the head of its chain; insert_or_assign and erase
+//     swing one link past the old node and retire it to the epoch domain.
+//   - grow() copies every entry into a new bucket array off to the side
+//     and publishes it with one atomic store. Readers still walking the old
+//     array keep seeing consistent chains until they leave their guard,
+//     after which the old array and its nodes are freed.
+//
+// All buckets live in the heap array, because the inline base tier of
+// HashTable could not be swapped atomically; base_size is the initial
+// bucket count. Growth copies K and V, so both must be copy-constructible.
+// get() returns the value by copy since a reference could outlive the node;
+// use visit() to read it in place.
+template <typename K, typename V, size_t base_size,
+          typename Hash = hash_policy::DefaultHash<K>,
+          typename KeyEqual = hash_policy::DefaultKeyEqual<K>,
+          typename Capacity = PowerOfTwoCapacity>
+class ConcurrentHashTable {
+    static_assert(base_size > 0, "ConcurrentHashTable needs at least one bucket");
+    static_assert(std::is_copy_constructible_v<K> && std::is_copy_constructible_v<V>,
+                  "grow() copies entries, so K and V must be copy-constructible");
+
+    struct Node {
+        const K key;
+        const V value;
+        std::atomic<Node*> next;
+
+        template <typename KArg, typename VArg>
+        Node(KArg&& k, VArg&& v, Node* n)
+            : key(std::forward<KArg>(k)), value(std::forward<VArg>(v)), next(n) {}
+    };
+
+    // A bucket array together with the nodes reachable from it.
+    struct Buckets {
+        size_t capacity;
+        std::unique_ptr<std::atomic<Node*>[]> heads;
+
+        explicit Buckets(size_t n) : capacity(n), heads(new std::atomic<Node*>[n]) {
+            for (size_t i = 0; i < n; ++i) heads[i].store(nullptr, std::memory_order_relaxed);
+        }
+
+        ~Buckets() {
+            for (size_t i = 0; i < capacity; ++i) {
+                Node* node = heads[i].load(std::memory_order_relaxed);
+                while (node) delete std::exchange(node, node->next.load(std::memory_order_relaxed));
+            }
+        }
+    };
+
+    template <typename Q>
+    static constexpr bool lookup_with =
+        hash_policy::is_transparent_v<Hash, KeyEqual> && !std::is_same_v<Q, K>;
+
+    [[no_unique_address]] Hash hasher;
+    [[no_unique_address]] KeyEqual key_eq;
+    std::atomic<Buckets*> buckets;
+    std::atomic<size_t> num_entries{0};
+    std::mutex write_mutex;
+
+    template <typename Q>
+    size_t hash_of(const Q& key) const {
+        return static_cast<size_t>(hash_policy::finalize<Hash>(static_cast<uint64_t>(hasher(key))));
+    }
+
+    static size_t index_for(size_t hash, size_t capacity) {
+        if (capacity == base_size) return Capacity::template reduce_fixed<base_size>(hash);
+        return Capacity::reduce(hash, capacity);
+    }
+
+    // Caller holds an EpochGuard or the write mutex.
+    template <typename Q>
+    const Node* find_node(const Q& key) const {
+        const Buckets* b = buckets.load(std::memory_order_acquire);
+        const Node* node = b->heads[index_for(hash_of(key), b->capacity)].load(std::memory_order_acquire);
+        for (; node; node = node->next.load(std::memory_order_acquire)) {
+            if (key_eq(node->key, key)) return node;
+        }
+        return nullptr;
+    }
+
+    // Link that points at the node holding `key`, or nullptr. Caller holds
+    // the write mutex.
+    template <typename Q>
+    std::atomic<Node*>* find_link(Buckets* b, const Q& key) {
+        std::atomic<Node*>* link = &b->heads[index_for(hash_of(key), b->capacity)];
+        for (Node* node; (node = link->load(std::memory_order_relaxed)); link = &node->next) {
+            if (key_eq(node->key, key)) return link;
+        }
+        return nullptr;
+    }
+
+    // Rebuild into Capacity::grow(capacity) buckets. Caller holds the write
+    // mutex.
+    void grow_locked() {
+        Buckets* old_buckets = buckets.load(std::memory_order_relaxed);
+        auto fresh = std::make_unique<Buckets>(Capacity::grow(old_buckets->capacity));
+
+        for (size_t i = 0; i < old_buckets->capacity; ++i) {
+            Node* node = old_buckets->heads[i].load(std::memory_order_relaxed);
+            for (; node; node = node->next.load(std::memory_order_relaxed)) {
+                auto& head = fresh->heads[index_for(hash_of(node->key), fresh->capacity)];
+                head.store(new Node(node->key, node->value, head.load(std::memory_order_relaxed)),
+                           std::memory_order_relaxed);
+            }
+        }
+
+        buckets.store(fresh.release(), std::memory_order_release);
+        EpochDomain::global().retire(old_buckets);
+    }
+
+    template <typename KArg, typename M>
+    bool insert_impl(KArg&& key, M&& value, bool assign) {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        Buckets* b = buckets.load(std::memory_order_relaxed);
+
+        if (std::atomic<Node*>* link = find_link(b, key)) {
+            if (!assign) return false;
+            Node* old = link->load(std::memory_order_relaxed);
+            Node* node = new Node(std::forward<KArg>(key), std::forward<M>(value),
+                                  old->next.load(std::memory_order_relaxed));
+            link->store(node, std::memory_order_release);
+            EpochDomain::global().retire(old);
+            return false;
+        }
+
+        const size_t n = num_entries.load(std::memory_order_relaxed);
+        if ((n + 1) * 10 > b->capacity * 7) {  // keep load factor below 0.7
+            grow_locked();
+            b = buckets.load(std::memory_order_relaxed);
+        }
+
+        auto& head = b->heads[index_for(hash_of(key), b->capacity)];
+        head.store(new Node(std::forward<KArg>(key), std::forward<M>(value),
+                            head.load(std::memory_order_relaxed)),
+                   std::memory_order_release);
+        num_entries.store(n + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    template <typename Q>
+    bool erase_impl(const Q& key) {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        std::atomic<Node*>* link = find_link(buckets.load(std::memory_order_relaxed), key);
+        if (!link) return false;  // Key not found
+
+        Node* node = link->load(std::memory_order_relaxed);
+        link->store(node->next.load(std::memory_order_relaxed), std::memory_order_release);
+        num_entries.fetch_sub(1, std::memory_order_relaxed);
+        EpochDomain::global().retire(node);
+        return true;
+    }
+
+    template <typename Q, typename F>
+    bool visit_impl(const Q& key, F&& f) const {
+        EpochGuard guard;
+        const Node* node = find_node(key);
+        if (!node) return false;
+        std::forward<F>(f)(node->value);
+        return true;
+    }
+
+    template <typename Q>
+    std::optional<V> get_impl(const Q& key) const {
+        EpochGuard guard;
+        const Node* node = find_node(key);
+        if (!node) return std::nullopt;  // Key not found
+        return node->value;
+    }
+
+public:
+    ConcurrentHashTable() : buckets(new Buckets(base_size)) {}
+
+    explicit ConcurrentHashTable(const Hash& hash, const KeyEqual& equal = KeyEqual())
+        : hasher(hash), key_eq(equal), buckets(new Buckets(base_size)) {}
+
+    // Destruction must not race with any other member call.
+    ~ConcurrentHashTable() { delete buckets.load(std::memory_order_relaxed); }
+
+    ConcurrentHashTable(const ConcurrentHashTable&) = delete;
+    ConcurrentHashTable& operator=(const ConcurrentHashTable&) = delete;
+
+    // Snapshot values; they may be stale by the time they are used.
+    size_t size() const { return num_entries.load(std::memory_order_relaxed); }
+
+    size_t bucket_count() const {
+        EpochGuard guard;
+        return buckets.load(std::memory_order_acquire)->capacity;
+    }
+
+    // Insert a key-value pair if the key is absent. Returns whether it was
+    // inserted; an existing key keeps its value.
+    bool insert(const K& key, const V& value) { return insert_impl(key, value, false); }
+    bool insert(K&& key, V&& value) { return insert_impl(std::move(key), std::move(value), false); }
+
+    // Insert, or replace the value of an existing key. Returns whether the
+    // key was inserted. Readers see either the old or the new value.
+    template <typename M>
+    bool insert_or_assign(const K& key, M&& value) {
+        return insert_impl(key, std::forward<M>(value), true);
+    }
+
+    template <typename M>
+    bool insert_or_assign(K&& key, M&& value) {
+        return insert_impl(std::move(key), std::forward<M>(value), true);
+    }
+
+    // Copy of the value associated with a key
+    std::optional<V> get(const K& key) const { return get_impl(key); }
+
+    template <typename Q> requires lookup_with<Q>
+    std::optional<V> get(const Q& key) const { return get_impl(key); }
+
+    // Call f(const V&) on the value of `key` without copying it. The
+    // reference must not escape f. Returns whether the key was found.
+    template <typename F>
+    bool visit(const K& key, F&& f) const { return visit_impl(key, std::forward<F>(f)); }
+
+    template <typename Q, typename F> requires lookup_with<Q>
+    bool visit(const Q& key, F&& f) const { return visit_impl(key, std::forward<F>(f)); }
+
+    bool contains(const K& key) const {
+        EpochGuard guard;
+        return find_node(key) != nullptr;
+    }
+
+    template <typename Q> requires lookup_with<Q>
+    bool contains(const Q& key) const {
+        EpochGuard guard;
+        return find_node(key) != nullptr;
+    }
+
+    // Remove the key-value pair associated with a key
+    bool erase(const K& key) { return erase_impl(key); }
+
+    template <typename Q> requires lookup_with<Q>
+    bool erase(const Q& key) { return erase_impl(key); }
+
+    // Move to the next Capacity step; readers switch over atomically.
+    void grow() {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        grow_locked();
+    }
+};
+
+
+#endif // CONCURRENT_HASH_TABLE_HPP
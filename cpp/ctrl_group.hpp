@@ -0,0 +1,187 @@
+#ifndef CTRL_GROUP_HPP
+#define CTRL_GROUP_HPP
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+// Define HASH_TABLE_NO_SIMD to force the portable group implementation.
+#if !defined(HASH_TABLE_NO_SIMD)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CTRL_GROUP_SSE2 1
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#define CTRL_GROUP_AVX2 1
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#define CTRL_GROUP_NEON 1
+#include <arm_neon.h>
+#endif
+#endif
+
+
+// Control byte of an open-addressing slot. Full slots store a 7-bit tag
+// taken from the key's hash (0x00-0x7f); the high bit marks special states.
+enum class Ctrl : uint8_t {
+    empty = 0x80,
+    deleted = 0xfe,
+};
+
+inline constexpr bool is_full(uint8_t c) { return (c & 0x80) == 0; }
+
+
+// Set of matching positions within a group. Each position is one bit,
+// spaced 1 << shift bits apart (SSE2/AVX2 movemask gives dense bits, the
+// SWAR and NEON paths give one bit per byte or nibble).
+template <typename T, int shift>
+class GroupMask {
+    T bits;
+
+public:
+    explicit GroupMask(T b) : bits(b) {}
+
+    explicit operator bool() const { return bits != 0; }
+
+    int lowest() const { return std::countr_zero(bits) >> shift; }
+
+    // Iterate positions from lowest to highest
+    GroupMask& operator++() {
+        bits &= bits - 1;
+        return *this;
+    }
+    int operator*() const { return lowest(); }
+    GroupMask begin() const { return *this; }
+    GroupMask end() const { return GroupMask(0); }
+    bool operator!=(const GroupMask& other) const { return bits != other.bits; }
+};
+
+
+// Portable fallback: eight control bytes at a time in a 64-bit word.
+struct GroupPortable {
+    static constexpr int width = 8;
+    using Mask = GroupMask<uint64_t, 3>;
+
+    static constexpr uint64_t lsbs = 0x0101010101010101ull;
+    static constexpr uint64_t msbs = 0x8080808080808080ull;
+
+    uint64_t ctrl;
+
+    explicit GroupPortable(const uint8_t* pos) {
+        std::memcpy(&ctrl, pos, sizeof(ctrl));
+        if constexpr (std::endian::native == std::endian::big) {
+            ctrl = __builtin_bswap64(ctrl);
+        }
+    }
+
+    // May report a false positive in a byte above a real match; callers
+    // always confirm with a key compare.
+    Mask match(uint8_t tag) const {
+        uint64_t x = ctrl ^ (lsbs * tag);
+        return Mask((x - lsbs) & ~x & msbs);
+    }
+
+    Mask match_empty() const { return Mask(ctrl & ~(ctrl << 6) & msbs); }
+
+    Mask match_empty_or_deleted() const { return Mask(ctrl & msbs); }
+};
+
+
+#if defined(CTRL_GROUP_SSE2)
+struct GroupSse2 {
+    static constexpr int width = 16;
+    using Mask = GroupMask<uint32_t, 0>;
+
+    __m128i ctrl;
+
+    explicit GroupSse2(const uint8_t* pos)
+        : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos))) {}
+
+    Mask match(uint8_t tag) const {
+        auto eq = _mm_cmpeq_epi8(ctrl, _mm_set1_epi8(static_cast<char>(tag)));
+        return Mask(static_cast<uint32_t>(_mm_movemask_epi8(eq)));
+    }
+
+    Mask match_empty() const {
+        auto eq = _mm_cmpeq_epi8(ctrl, _mm_set1_epi8(static_cast<char>(Ctrl::empty)));
+        return Mask(static_cast<uint32_t>(_mm_movemask_epi8(eq)));
+    }
+
+    Mask match_empty_or_deleted() const {
+        return Mask(static_cast<uint32_t>(_mm_movemask_epi8(ctrl)));
+    }
+};
+#endif
+
+
+#if defined(CTRL_GROUP_AVX2)
+struct GroupAvx2 {
+    static constexpr int width = 32;
+    using Mask = GroupMask<uint32_t, 0>;
+
+    __m256i ctrl;
+
+    explicit GroupAvx2(const uint8_t* pos)
+        : ctrl(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos))) {}
+
+    Mask match(uint8_t tag) const {
+        auto eq = _mm256_cmpeq_epi8(ctrl, _mm256_set1_epi8(static_cast<char>(tag)));
+        return Mask(static_cast<uint32_t>(_mm256_movemask_epi8(eq)));
+    }
+
+    Mask match_empty() const {
+        auto eq = _mm256_cmpeq_epi8(ctrl, _mm256_set1_epi8(static_cast<char>(Ctrl::empty)));
+        return Mask(static_cast<uint32_t>(_mm256_movemask_epi8(eq)));
+    }
+
+    Mask match_empty_or_deleted() const {
+        return Mask(static_cast<uint32_t>(_mm256_movemask_epi8(ctrl)));
+    }
+};
+#endif
+
+
+#if defined(CTRL_GROUP_NEON)
+// NEON has no movemask; narrowing each 16-bit lane by 4 packs the compare
+// result into one nibble per byte, and keeping a single bit of each nibble
+// gives a mask with positions four bits apart.
+struct GroupNeon {
+    static constexpr int width = 16;
+    using Mask = GroupMask<uint64_t, 2>;
+
+    uint8x16_t ctrl;
+
+    explicit GroupNeon(const uint8_t* pos) : ctrl(vld1q_u8(pos)) {}
+
+    static uint64_t to_bits(uint8x16_t eq) {
+        uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(eq), 4);
+        return vget_lane_u64(vreinterpret_u64_u8(narrowed), 0) & 0x8888888888888888ull;
+    }
+
+    Mask match(uint8_t tag) const { return Mask(to_bits(vceqq_u8(ctrl, vdupq_n_u8(tag)))); }
+
+    Mask match_empty() const {
+        return Mask(to_bits(vceqq_u8(ctrl, vdupq_n_u8(static_cast<uint8_t>(Ctrl::empty)))));
+    }
+
+    Mask match_empty_or_deleted() const {
+        return Mask(to_bits(vcltzq_s8(vreinterpretq_s8_u8(ctrl))));
+    }
+};
+#endif
+
+
+// Widest group the target supports.
+#if defined(CTRL_GROUP_AVX2)
+using CtrlGroup = GroupAvx2;
+#elif defined(CTRL_GROUP_SSE2)
+using CtrlGroup = GroupSse2;
+#elif defined(CTRL_GROUP_NEON)
+using CtrlGroup = GroupNeon;
+#else
+using CtrlGroup = GroupPortable;
+#endif
+
+
+#endif // CTRL_GROUP_HPP
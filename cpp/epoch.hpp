@@ -0,0 +1,194 @@
+#ifndef EPOCH_HPP
+#define EPOCH_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+
+// Epoch-based reclamation for structures with lock-free readers.
+//
+// A reader brackets its accesses with an EpochGuard, which publishes the
+// global epoch it observed in a per-thread record: a load, a store and a
+// fence, so entering and leaving are wait-free. Writers unlink an object
+// and hand it to retire(); it is freed once the global epoch has advanced
+// twice since, at which point no reader that could have seen it is still
+// inside a guard. The epoch only advances when every active reader has
+// caught up with it, so a reader that never leaves its guard delays
+// reclamation (not progress).
+//
+// One process-wide domain, EpochDomain::global(), serves every table.
+// Per-thread records are allocated on a thread's first guard and recycled
+// when the thread exits.
+class EpochDomain {
+    struct alignas(64) Record {
+        // 0 while outside any guard, otherwise the epoch observed on entry
+        std::atomic<uint64_t> epoch{0};
+        std::atomic<bool> in_use{true};
+        Record* next = nullptr;
+        size_t depth = 0;  // nesting level, only touched by the owner
+    };
+
+    struct Retired {
+        uint64_t epoch;
+        void* object;
+        void (*deleter)(void*);
+    };
+
+    // Returns the calling thread's record to the pool when it exits.
+    struct LocalRecord {
+        Record* record = nullptr;
+        ~LocalRecord() {
+            if (record) record->in_use.store(false, std::memory_order_release);
+        }
+    };
+
+    std::atomic<uint64_t> global_epoch{1};
+    std::atomic<Record*> records{nullptr};
+
+    std::mutex retire_mutex;
+    std::vector<Retired> retired;
+
+    Record* acquire_record() {
+        for (Record* r = records.load(std::memory_order_acquire); r; r = r->next) {
+            bool expected = false;
+            if (!r->in_use.load(std::memory_order_relaxed) &&
+                r->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                return r;
+            }
+        }
+        Record* r = new Record;
+        r->next = records.load(std::memory_order_relaxed);
+        while (!records.compare_exchange_weak(r->next, r, std::memory_order_release,
+                                              std::memory_order_relaxed)) {}
+        return r;
+    }
+
+    Record* local_record() {
+        thread_local LocalRecord local;
+        if (!local.record) local.record = acquire_record();
+        return local.record;
+    }
+
+    // Advance the epoch if every thread inside a guard has observed the
+    // current one. Called with retire_mutex held.
+    void try_advance() {
+        const uint64_t current = global_epoch.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        for (Record* r = records.load(std::memory_order_acquire); r; r = r->next) {
+            uint64_t e = r->epoch.load(std::memory_order_acquire);
+            if (e != 0 && e != current) return;
+        }
+        global_epoch.store(current + 1, std::memory_order_release);
+    }
+
+    // Free everything retired at least two epochs ago. Called with
+    // retire_mutex held; the objects are deleted after it is released.
+    std::vector<Retired> collect() {
+        const uint64_t current = global_epoch.load(std::memory_order_acquire);
+        std::vector<Retired> ready;
+        size_t kept = 0;
+        for (Retired& item : retired) {
+            if (item.epoch + 2 <= current) {
+                ready.push_back(item);
+            } else {
+                retired[kept++] = item;
+            }
+        }
+        retired.resize(kept);
+        return ready;
+    }
+
+    static void free_all(const std::vector<Retired>& items) {
+        for (const Retired& item : items) item.deleter(item.object);
+    }
+
+    // The per-thread record is cached in a single thread_local, so there is
+    // exactly one domain.
+    EpochDomain() = default;
+
+public:
+    EpochDomain(const EpochDomain&) = delete;
+    EpochDomain& operator=(const EpochDomain&) = delete;
+
+    // Nothing can still be reading once the domain itself goes away.
+    ~EpochDomain() {
+        free_all(retired);
+        for (Record* r = records.load(std::memory_order_relaxed); r;) {
+            Record* next = r->next;
+            delete r;
+            r = next;
+        }
+    }
+
+    static EpochDomain& global() {
+        static EpochDomain domain;
+        return domain;
+    }
+
+    void enter() {
+        Record* r = local_record();
+        if (r->depth++ != 0) return;
+        r->epoch.store(global_epoch.load(std::memory_order_acquire), std::memory_order_relaxed);
+        // Order the publication before every load the reader makes next.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    void leave() {
+        Record* r = local_record();
+        if (--r->depth != 0) return;
+        r->epoch.store(0, std::memory_order_release);
+    }
+
+    // Schedule `object` for deletion once no reader can reach it. The
+    // caller must already have unlinked it from the shared structure.
+    template <typename T>
+    void retire(T* object) {
+        retire(object, [](void* p) { delete static_cast<T*>(p); });
+    }
+
+    void retire(void* object, void (*deleter)(void*)) {
+        std::vector<Retired> ready;
+        {
+            std::lock_guard<std::mutex> lock(retire_mutex);
+            retired.push_back({global_epoch.load(std::memory_order_acquire), object, deleter});
+            try_advance();
+            ready = collect();
+        }
+        free_all(ready);
+    }
+
+    // Free whatever can be freed now without retiring anything new.
+    void reclaim() {
+        std::vector<Retired> ready;
+        {
+            std::lock_guard<std::mutex> lock(retire_mutex);
+            try_advance();
+            ready = collect();
+        }
+        free_all(ready);
+    }
+
+    size_t pending() {
+        std::lock_guard<std::mutex> lock(retire_mutex);
+        return retired.size();
+    }
+};
+
+
+// RAII reader section for an EpochDomain. Guards nest.
+class EpochGuard {
+    EpochDomain& domain;
+
+public:
+    explicit EpochGuard(EpochDomain& d = EpochDomain::global()) : domain(d) { domain.enter(); }
+    ~EpochGuard() { domain.leave(); }
+
+    EpochGuard(const EpochGuard&) = delete;
+    EpochGuard& operator=(const EpochGuard&) = delete;
+};
+
+
+#endif // EPOCH_HPP
@@ -0,0 +1,288 @@
+#ifndef FROZEN_FORMAT_HPP
+#define FROZEN_FORMAT_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "hash_policy.hpp"
+
+
+// Flat, pointer-free image of a frozen hash table, written once and then
+// mapped read-only by MappedHashTable (mapped_hash_table.hpp), the C reader
+// (c/frozen_table.h) or the Rust one (rust/frozen-table). The normative
+// spec, with hash test vectors, is docs/frozen_format.md.
+//
+// Every integer is little-endian and every section is 8-byte aligned, so
+// the image can be mapped at any address, on any platform:
+//
+//   offset  size  header field
+//        0     8  magic "CTHFROZ\0"
+//        8     4  version (1)
+//       12     4  flags (0)
+//       16     8  seed
+//       24     8  bucket_count, a power of two
+//       32     8  entry_count
+//       40     8  buckets_offset: bucket_count + 1 u32 entry indices
+//       48     8  entries_offset: entry_count 32-byte entries
+//       56     8  blob_offset: key and value bytes
+//       64     8  blob_size
+//       72     8  reserved (0)
+//
+//   entry: u64 hash, u64 key_offset, u64 value_offset, u32 key_size,
+//          u32 value_size (offsets relative to blob_offset)
+//
+// A key hashes as hash_policy::wyhash(key bytes, seed) and lives in bucket
+// hash & (bucket_count - 1). Entries are sorted by bucket, so the entries of
+// bucket b are [buckets[b], buckets[b + 1]) and a lookup scans one short,
+// contiguous run comparing the stored hash before the key bytes.
+//
+// Keys and values are stored as bytes through FrozenCodec: integers and
+// enums as their little-endian bytes, std::string as its characters, other
+// trivially copyable types as their object representation (which is only
+// portable between identical ABIs).
+namespace frozen {
+
+inline constexpr char magic[8] = {'C', 'T', 'H', 'F', 'R', 'O', 'Z', '\0'};
+inline constexpr uint32_t version = 1;
+inline constexpr size_t header_size = 80;
+inline constexpr size_t entry_size = 32;
+
+namespace detail {
+
+template <typename T>
+T byteswap(T v) {
+    if constexpr (sizeof(T) == 2) return static_cast<T>(__builtin_bswap16(static_cast<uint16_t>(v)));
+    if constexpr (sizeof(T) == 4) return static_cast<T>(__builtin_bswap32(static_cast<uint32_t>(v)));
+    if constexpr (sizeof(T) == 8) return static_cast<T>(__builtin_bswap64(static_cast<uint64_t>(v)));
+    return v;
+}
+
+// Byte-wise during constant evaluation (freeze_static), where memcpy is
+// not available.
+template <typename T>
+constexpr T load_le(const std::byte* p) {
+    if (std::is_constant_evaluated()) {
+        T v = 0;
+        for (size_t k = 0; k < sizeof(T); ++k) v |= static_cast<T>(std::to_integer<T>(p[k]) << (8 * k));
+        return v;
+    }
+    T v{};
+    std::memcpy(&v, p, sizeof(T));
+    if constexpr (std::endian::native == std::endian::big && sizeof(T) > 1) {
+        v = byteswap(v);
+    }
+    return v;
+}
+
+template <typename T>
+constexpr void store_le(std::byte* p, T v) {
+    if (std::is_constant_evaluated()) {
+        for (size_t k = 0; k < sizeof(T); ++k) p[k] = static_cast<std::byte>(v >> (8 * k));
+        return;
+    }
+    if constexpr (std::endian::native == std::endian::big && sizeof(T) > 1) {
+        v = byteswap(v);
+    }
+    std::memcpy(p, &v, sizeof(T));
+}
+
+constexpr void copy_bytes(std::byte* out, std::string_view bytes) {
+    if (std::is_constant_evaluated()) {
+        for (size_t i = 0; i < bytes.size(); ++i) out[i] = static_cast<std::byte>(bytes[i]);
+        return;
+    }
+    if (!bytes.empty()) std::memcpy(out, bytes.data(), bytes.size());
+}
+
+constexpr size_t align8(size_t n) { return (n + 7) & ~size_t{7}; }
+
+} // namespace detail
+
+
+// Byte encoding of keys and values. with_bytes(v, f) calls f with the
+// encoded bytes as a string_view (without allocating for fixed-size types);
+// decode turns stored bytes back into view_type.
+template <typename T, typename = void>
+struct FrozenCodec {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "frozen tables store integers, enums, std::string and trivially copyable types");
+
+    using view_type = T;
+    using lookup_type = T;
+
+    template <typename F>
+    static decltype(auto) with_bytes(const T& v, F&& f) {
+        return f(std::string_view(reinterpret_cast<const char*>(&v), sizeof(T)));
+    }
+
+    static T decode(std::string_view bytes) {
+        T v;
+        std::memcpy(&v, bytes.data(), sizeof(T));
+        return v;
+    }
+};
+
+template <typename T>
+struct FrozenCodec<T, std::enable_if_t<hash_policy::is_integral_key_v<T>>> {
+    using view_type = T;
+    using lookup_type = T;
+    using bits_type = std::conditional_t<sizeof(T) == 1, uint8_t,
+                      std::conditional_t<sizeof(T) == 2, uint16_t,
+                      std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>>;
+
+    template <typename F>
+    static constexpr decltype(auto) with_bytes(const T& v, F&& f) {
+        std::array<char, sizeof(T)> buffer{};
+        const auto bits = static_cast<bits_type>(v);
+        for (size_t k = 0; k < sizeof(T); ++k) buffer[k] = static_cast<char>(bits >> (8 * k));
+        return f(std::string_view(buffer.data(), sizeof(T)));
+    }
+
+    static T decode(std::string_view bytes) {
+        return static_cast<T>(detail::load_le<bits_type>(reinterpret_cast<const std::byte*>(bytes.data())));
+    }
+};
+
+template <>
+struct FrozenCodec<std::string> {
+    using view_type = std::string_view;  // points into the mapped image
+    using lookup_type = std::string_view;
+
+    template <typename F>
+    static constexpr decltype(auto) with_bytes(std::string_view v, F&& f) { return f(v); }
+
+    static constexpr std::string_view decode(std::string_view bytes) { return bytes; }
+};
+
+// Same bytes as std::string, so either type reads the other's images.
+template <>
+struct FrozenCodec<std::string_view> : FrozenCodec<std::string> {};
+
+
+// Serialize key-value pairs (any range of pair-like elements, e.g. a
+// std::vector<std::pair<K, V>>) into a frozen image. Throws
+// std::invalid_argument on duplicate keys. Usable in constant expressions
+// for integer, enum and std::string_view keys and values (freeze_static).
+template <typename K, typename V, typename Range>
+constexpr std::vector<std::byte> freeze(const Range& pairs, uint64_t seed = 0) {
+    using namespace detail;
+
+    struct Pending {
+        uint64_t hash;
+        size_t key_offset, key_size, value_offset, value_size;
+    };
+    std::vector<Pending> pending;
+    std::string blob;
+
+    for (const auto& [key, value] : pairs) {
+        Pending p{};
+        p.key_offset = blob.size();
+        p.hash = FrozenCodec<K>::with_bytes(key, [&](std::string_view bytes) {
+            blob.append(bytes);
+            return hash_policy::wyhash(bytes, seed);
+        });
+        p.key_size = blob.size() - p.key_offset;
+        blob.resize(align8(blob.size()));
+        p.value_offset = blob.size();
+        FrozenCodec<V>::with_bytes(value, [&](std::string_view bytes) { blob.append(bytes); });
+        p.value_size = blob.size() - p.value_offset;
+        blob.resize(align8(blob.size()));
+        if (p.key_size > UINT32_MAX || p.value_size > UINT32_MAX) {
+            throw std::length_error("Key or value too large for a frozen table.");
+        }
+        pending.push_back(p);
+    }
+    if (pending.size() > UINT32_MAX) throw std::length_error("Too many entries for a frozen table.");
+
+    const uint64_t bucket_count = std::bit_ceil(std::max<size_t>(pending.size(), 1));
+    auto bucket_of = [&](const Pending& p) { return p.hash & (bucket_count - 1); };
+    auto key_of = [&](const Pending& p) { return std::string_view(blob).substr(p.key_offset, p.key_size); };
+    std::sort(pending.begin(), pending.end(), [&](const Pending& a, const Pending& b) {
+        if (bucket_of(a) != bucket_of(b)) return bucket_of(a) < bucket_of(b);
+        return a.hash != b.hash ? a.hash < b.hash : key_of(a) < key_of(b);
+    });
+
+    for (size_t i = 1; i < pending.size(); ++i) {
+        if (pending[i].hash == pending[i - 1].hash && key_of(pending[i]) == key_of(pending[i - 1])) {
+            throw std::invalid_argument("Duplicate key in frozen table.");
+        }
+    }
+
+    const size_t buckets_offset = header_size;
+    const size_t entries_offset = align8(buckets_offset + 4 * (bucket_count + 1));
+    const size_t blob_offset = entries_offset + entry_size * pending.size();
+    std::vector<std::byte> image(blob_offset + blob.size());
+    std::byte* out = image.data();
+
+    copy_bytes(out, std::string_view(magic, sizeof(magic)));
+    store_le<uint32_t>(out + 8, version);
+    store_le<uint32_t>(out + 12, 0);
+    store_le<uint64_t>(out + 16, seed);
+    store_le<uint64_t>(out + 24, bucket_count);
+    store_le<uint64_t>(out + 32, pending.size());
+    store_le<uint64_t>(out + 40, buckets_offset);
+    store_le<uint64_t>(out + 48, entries_offset);
+    store_le<uint64_t>(out + 56, blob_offset);
+    store_le<uint64_t>(out + 64, blob.size());
+    store_le<uint64_t>(out + 72, 0);
+
+    size_t e = 0;
+    for (uint64_t b = 0; b <= bucket_count; ++b) {
+        while (e < pending.size() && bucket_of(pending[e]) < b) ++e;
+        store_le<uint32_t>(out + buckets_offset + 4 * b, static_cast<uint32_t>(e));
+    }
+    for (size_t i = 0; i < pending.size(); ++i) {
+        std::byte* entry = out + entries_offset + entry_size * i;
+        store_le<uint64_t>(entry, pending[i].hash);
+        store_le<uint64_t>(entry + 8, pending[i].key_offset);
+        store_le<uint64_t>(entry + 16, pending[i].value_offset);
+        store_le<uint32_t>(entry + 24, static_cast<uint32_t>(pending[i].key_size));
+        store_le<uint32_t>(entry + 28, static_cast<uint32_t>(pending[i].value_size));
+    }
+    copy_bytes(out + blob_offset, blob);
+    return image;
+}
+
+// freeze() at compile time, into a std::array of exactly the image's size.
+// `pairs` is a constexpr callable returning the pairs:
+//
+//     alignas(8) static constexpr auto colors = frozen::freeze_static<std::string_view, uint32_t, [] {
+//         return std::array{std::pair{std::string_view("red"), 1u}, std::pair{std::string_view("blue"), 2u}};
+//     }>();
+//     auto table = MappedHashTable<std::string_view, uint32_t>::view(colors);
+//
+// The image is byte for byte what freeze() and frozen_gen produce for the
+// same pairs and seed. Keys and values must be integers, enums or
+// std::string_view.
+template <typename K, typename V, auto pairs, uint64_t seed = 0>
+consteval auto freeze_static() {
+    constexpr size_t size = freeze<K, V>(pairs(), seed).size();
+    std::array<std::byte, size> image{};
+    const std::vector<std::byte> bytes = freeze<K, V>(pairs(), seed);
+    std::copy(bytes.begin(), bytes.end(), image.begin());
+    return image;
+}
+
+// Serialize pairs straight to a file. Throws std::runtime_error if the file
+// cannot be written.
+template <typename K, typename V, typename Range>
+void write_frozen(const std::string& path, const Range& pairs, uint64_t seed = 0) {
+    const std::vector<std::byte> image = freeze<K, V>(pairs, seed);
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(image.data()), static_cast<std::streamsize>(image.size()));
+    if (!file.flush()) throw std::runtime_error("Cannot write frozen table to " + path);
+}
+
+} // namespace frozen
+
+#endif // FROZEN_FORMAT_HPP
@@ -0,0 +1,127 @@
+// frozen_gen: build a frozen table image (frozen_format.hpp) from a TSV
+// file, for services that read it from C, C++ or Rust.
+//
+//     frozen_gen [--seed N] [--key TYPE] [--value TYPE] INPUT.tsv OUTPUT
+//
+// Each line of INPUT is KEY<TAB>VALUE; keys and values cannot contain tabs
+// or newlines, empty lines are skipped and a trailing '\r' is dropped.
+// TYPE is string (the default), u8, u16, u32, u64, i8, i16, i32 or i64.
+// Integers are stored as their little-endian bytes, so a u32 key is looked
+// up by the 4 bytes of its value.
+
+#include "frozen_format.hpp"
+
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace {
+
+template <typename T>
+struct Tag {
+    using type = T;
+};
+
+// Call f(Tag<T>{}) for the C++ type named by `name`.
+template <typename F>
+void with_type(std::string_view name, F&& f) {
+    if (name == "string") return f(Tag<std::string>{});
+    if (name == "u8") return f(Tag<uint8_t>{});
+    if (name == "u16") return f(Tag<uint16_t>{});
+    if (name == "u32") return f(Tag<uint32_t>{});
+    if (name == "u64") return f(Tag<uint64_t>{});
+    if (name == "i8") return f(Tag<int8_t>{});
+    if (name == "i16") return f(Tag<int16_t>{});
+    if (name == "i32") return f(Tag<int32_t>{});
+    if (name == "i64") return f(Tag<int64_t>{});
+    throw std::invalid_argument("unknown type " + std::string(name));
+}
+
+template <typename T>
+T parse_field(std::string_view text, size_t line) {
+    if constexpr (std::is_same_v<T, std::string>) {
+        return std::string(text);
+    } else {
+        T value{};
+        auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+        if (error != std::errc() || end != text.data() + text.size()) {
+            throw std::invalid_argument("line " + std::to_string(line) + ": not a valid integer: " +
+                                        std::string(text));
+        }
+        return value;
+    }
+}
+
+template <typename K, typename V>
+void generate(const std::string& input, const std::string& output, uint64_t seed) {
+    std::ifstream in(input, std::ios::binary);
+    if (!in) throw std::runtime_error("cannot open " + input);
+
+    std::vector<std::pair<K, V>> pairs;
+    std::string text;
+    for (size_t line = 1; std::getline(in, text); ++line) {
+        if (!text.empty() && text.back() == '\r') text.pop_back();
+        if (text.empty()) continue;
+        const size_t tab = text.find('\t');
+        if (tab == std::string::npos || text.find('\t', tab + 1) != std::string::npos) {
+            throw std::invalid_argument("line " + std::to_string(line) + ": expected KEY<TAB>VALUE");
+        }
+        const std::string_view fields(text);
+        pairs.emplace_back(parse_field<K>(fields.substr(0, tab), line),
+                           parse_field<V>(fields.substr(tab + 1), line));
+    }
+    frozen::write_frozen<K, V>(output, pairs, seed);
+    std::cout << output << ": " << pairs.size() << " entries\n";
+}
+
+int usage() {
+    std::cerr << "usage: frozen_gen [--seed N] [--key TYPE] [--value TYPE] INPUT.tsv OUTPUT\n"
+                 "TYPE: string (default), u8, u16, u32, u64, i8, i16, i32, i64\n";
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint64_t seed = 0;
+    std::string key_type = "string", value_type = "string";
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if ((arg == "--seed" || arg == "--key" || arg == "--value") && i + 1 < argc) {
+            const std::string value = argv[++i];
+            if (arg == "--key") {
+                key_type = value;
+            } else if (arg == "--value") {
+                value_type = value;
+            } else {
+                auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), seed);
+                if (error != std::errc() || end != value.data() + value.size()) return usage();
+            }
+        } else if (!arg.empty() && arg[0] == '-') {
+            return usage();
+        } else {
+            files.push_back(arg);
+        }
+    }
+    if (files.size() != 2) return usage();
+
+    try {
+        with_type(key_type, [&](auto key) {
+            with_type(value_type, [&](auto value) {
+                generate<typename decltype(key)::type, typename decltype(value)::type>(files[0], files[1], seed);
+            });
+        });
+    } catch (const std::exception& e) {
+        std::cerr << "frozen_gen: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,642 @@
+#ifndef HASH_POLICY_HPP
+#define HASH_POLICY_HPP
+
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#if defined(__SSE4_2__) && !defined(HASH_TABLE_NO_SIMD)
+#include <nmmintrin.h>
+#define HASH_POLICY_CRC32C_SSE42 1
+#elif defined(__ARM_FEATURE_CRC32) && !defined(HASH_TABLE_NO_SIMD)
+#include <arm_acle.h>
+#define HASH_POLICY_CRC32C_ARM 1
+#endif
+
+// Hashing policies that can be evaluated in constant expressions.
+//
+// std::hash is neither constexpr nor stable across implementations, so the
+// compile-time tables hash with these instead. Keys are read byte by byte in
+// little-endian order, which keeps the results identical at compile time and
+// at runtime on every platform.
+
+namespace hash_policy {
+
+namespace detail {
+
+// Full 64x64 -> 128 bit multiply, returned as the (lo, hi) halves.
+constexpr void mul128(uint64_t& a, uint64_t& b) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = static_cast<__uint128_t>(a) * b;
+    a = static_cast<uint64_t>(r);
+    b = static_cast<uint64_t>(r >> 64);
+#else
+    uint64_t ha = a >> 32, hb = b >> 32, la = static_cast<uint32_t>(a), lb = static_cast<uint32_t>(b);
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32);
+    uint64_t c = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+    a = lo;
+    b = hi;
+#endif
+}
+
+constexpr uint64_t wymix(uint64_t a, uint64_t b) {
+    mul128(a, b);
+    return a ^ b;
+}
+
+// Little-endian loads. Compilers do not always fuse the byte loop into one
+// load, so runtime calls on little-endian targets load directly.
+template <typename T>
+inline T load_native(const void* p) {
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    return v;
+}
+
+constexpr uint64_t read8(std::string_view s, size_t i) {
+    if (!std::is_constant_evaluated() && std::endian::native == std::endian::little) {
+        return load_native<uint64_t>(s.data() + i);
+    }
+    uint64_t v = 0;
+    for (size_t k = 0; k < 8; ++k) {
+        v |= static_cast<uint64_t>(static_cast<unsigned char>(s[i + k])) << (8 * k);
+    }
+    return v;
+}
+
+constexpr uint64_t read4(std::string_view s, size_t i) {
+    if (!std::is_constant_evaluated() && std::endian::native == std::endian::little) {
+        return load_native<uint32_t>(s.data() + i);
+    }
+    uint64_t v = 0;
+    for (size_t k = 0; k < 4; ++k) {
+        v |= static_cast<uint64_t>(static_cast<unsigned char>(s[i + k])) << (8 * k);
+    }
+    return v;
+}
+
+constexpr uint64_t read3(std::string_view s, size_t n) {
+    return (static_cast<uint64_t>(static_cast<unsigned char>(s[0])) << 16) |
+           (static_cast<uint64_t>(static_cast<unsigned char>(s[n >> 1])) << 8) |
+           static_cast<uint64_t>(static_cast<unsigned char>(s[n - 1]));
+}
+
+inline constexpr uint64_t wyp[4] = {
+    0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull,
+    0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull,
+};
+
+// Integral and enum keys are hashed by value, widened to 64 bits.
+template <typename T>
+constexpr uint64_t integral_bits(T key) {
+    if constexpr (std::is_enum_v<T>) {
+        return static_cast<uint64_t>(static_cast<std::underlying_type_t<T>>(key));
+    } else {
+        return static_cast<uint64_t>(key);
+    }
+}
+
+} // namespace detail
+
+template <typename T>
+inline constexpr bool is_integral_key_v = std::is_integral_v<T> || std::is_enum_v<T>;
+
+inline constexpr uint64_t fnv_offset_basis = 0xcbf29ce484222325ull;
+inline constexpr uint64_t fnv_prime = 0x100000001b3ull;
+
+// FNV-1a over a byte string.
+constexpr uint64_t fnv1a(std::string_view bytes, uint64_t seed = fnv_offset_basis) {
+    uint64_t h = seed;
+    for (char c : bytes) {
+        h ^= static_cast<unsigned char>(c);
+        h *= fnv_prime;
+    }
+    return h;
+}
+
+// FNV-1a over the 8 little-endian bytes of an integer.
+constexpr uint64_t fnv1a(uint64_t value, uint64_t seed = fnv_offset_basis) {
+    uint64_t h = seed;
+    for (int i = 0; i < 8; ++i) {
+        h ^= (value >> (8 * i)) & 0xff;
+        h *= fnv_prime;
+    }
+    return h;
+}
+
+// wyhash (final4 layout) over a byte string.
+constexpr uint64_t wyhash(std::string_view s, uint64_t seed = 0) {
+    using namespace detail;
+    const size_t len = s.size();
+    seed ^= wymix(seed ^ wyp[0], wyp[1]);
+    uint64_t a = 0, b = 0;
+    if (len <= 16) {
+        if (len >= 4) {
+            a = (read4(s, 0) << 32) | read4(s, (len >> 3) << 2);
+            b = (read4(s, len - 4) << 32) | read4(s, len - 4 - ((len >> 3) << 2));
+        } else if (len > 0) {
+            a = read3(s, len);
+        }
+    } else {
+        size_t p = 0, i = len;
+        if (i >= 48) {
+            uint64_t see1 = seed, see2 = seed;
+            do {
+                seed = wymix(read8(s, p) ^ wyp[1], read8(s, p + 8) ^ seed);
+                see1 = wymix(read8(s, p + 16) ^ wyp[2], read8(s, p + 24) ^ see1);
+                see2 = wymix(read8(s, p + 32) ^ wyp[3], read8(s, p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i >= 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = wymix(read8(s, p) ^ wyp[1], read8(s, p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = read8(s, p + i - 16);
+        b = read8(s, p + i - 8);
+    }
+    a ^= wyp[1];
+    b ^= seed;
+    mul128(a, b);
+    return wymix(a ^ wyp[0] ^ len, b ^ wyp[1]);
+}
+
+// wyhash's 64-bit integer mixer.
+constexpr uint64_t wyhash(uint64_t value, uint64_t seed = 0) {
+    using namespace detail;
+    uint64_t a = value ^ wyp[0];
+    uint64_t b = seed ^ wyp[1];
+    mul128(a, b);
+    return wymix(a ^ wyp[0], b ^ wyp[1]);
+}
+
+namespace detail {
+
+inline constexpr uint64_t xxh_prime32_1 = 0x9e3779b1ull;
+inline constexpr uint64_t xxh_prime32_2 = 0x85ebca77ull;
+inline constexpr uint64_t xxh_prime32_3 = 0xc2b2ae3dull;
+inline constexpr uint64_t xxh_prime64_1 = 0x9e3779b185ebca87ull;
+inline constexpr uint64_t xxh_prime64_2 = 0xc2b2ae3d27d4eb4full;
+inline constexpr uint64_t xxh_prime64_3 = 0x165667b19e3779f9ull;
+inline constexpr uint64_t xxh_prime64_4 = 0x85ebca77c2b2ae63ull;
+inline constexpr uint64_t xxh_prime64_5 = 0x27d4eb2f165667c5ull;
+inline constexpr uint64_t xxh_prime_mx1 = 0x165667919e3779f9ull;
+inline constexpr uint64_t xxh_prime_mx2 = 0x9fb21c651e98df25ull;
+
+inline constexpr size_t xxh3_secret_size = 192;
+
+// XXH3's default secret (XXH3_kSecret).
+inline constexpr unsigned char xxh3_secret[xxh3_secret_size] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+constexpr uint64_t secret8(const unsigned char* secret, size_t i) {
+    if (!std::is_constant_evaluated() && std::endian::native == std::endian::little) {
+        return load_native<uint64_t>(secret + i);
+    }
+    uint64_t v = 0;
+    for (size_t k = 0; k < 8; ++k) v |= static_cast<uint64_t>(secret[i + k]) << (8 * k);
+    return v;
+}
+
+constexpr uint64_t secret4(const unsigned char* secret, size_t i) {
+    if (!std::is_constant_evaluated() && std::endian::native == std::endian::little) {
+        return load_native<uint32_t>(secret + i);
+    }
+    uint64_t v = 0;
+    for (size_t k = 0; k < 4; ++k) v |= static_cast<uint64_t>(secret[i + k]) << (8 * k);
+    return v;
+}
+
+constexpr uint64_t rotl64(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+constexpr uint64_t bswap64(uint64_t x) {
+    uint64_t r = 0;
+    for (int k = 0; k < 8; ++k) r |= ((x >> (8 * k)) & 0xff) << (8 * (7 - k));
+    return r;
+}
+
+constexpr uint64_t bswap32(uint64_t x) {
+    return ((x & 0xff) << 24) | ((x & 0xff00) << 8) | ((x >> 8) & 0xff00) | ((x >> 24) & 0xff);
+}
+
+constexpr uint64_t mul128_fold64(uint64_t a, uint64_t b) { return wymix(a, b); }
+
+constexpr uint64_t xxh64_avalanche(uint64_t h) {
+    h ^= h >> 33;
+    h *= xxh_prime64_2;
+    h ^= h >> 29;
+    h *= xxh_prime64_3;
+    return h ^ (h >> 32);
+}
+
+constexpr uint64_t xxh3_avalanche(uint64_t h) {
+    h ^= h >> 37;
+    h *= xxh_prime_mx1;
+    return h ^ (h >> 32);
+}
+
+constexpr uint64_t xxh3_rrmxmx(uint64_t h, uint64_t len) {
+    h ^= rotl64(h, 49) ^ rotl64(h, 24);
+    h *= xxh_prime_mx2;
+    h ^= (h >> 35) + len;
+    h *= xxh_prime_mx2;
+    return h ^ (h >> 28);
+}
+
+constexpr uint64_t xxh3_mix16(std::string_view s, size_t i, const unsigned char* secret, size_t j,
+                              uint64_t seed) {
+    return mul128_fold64(read8(s, i) ^ (secret8(secret, j) + seed),
+                         read8(s, i + 8) ^ (secret8(secret, j + 8) - seed));
+}
+
+// XXH3's 4..8 byte path on the two 32-bit halves of a 64-bit input.
+constexpr uint64_t xxh3_4to8(uint64_t lo, uint64_t hi, uint64_t len, uint64_t seed) {
+    seed ^= bswap32(seed & 0xffffffff) << 32;
+    const uint64_t bitflip = (secret8(xxh3_secret, 8) ^ secret8(xxh3_secret, 16)) - seed;
+    return xxh3_rrmxmx((hi + (lo << 32)) ^ bitflip, len);
+}
+
+constexpr uint64_t xxh3_short(std::string_view s, uint64_t seed) {
+    const unsigned char* secret = xxh3_secret;
+    const size_t len = s.size();
+    if (len > 8) {
+        const uint64_t lo = read8(s, 0) ^ ((secret8(secret, 24) ^ secret8(secret, 32)) + seed);
+        const uint64_t hi = read8(s, len - 8) ^ ((secret8(secret, 40) ^ secret8(secret, 48)) - seed);
+        return xxh3_avalanche(len + bswap64(lo) + hi + mul128_fold64(lo, hi));
+    }
+    if (len >= 4) return xxh3_4to8(read4(s, 0), read4(s, len - 4), len, seed);
+    if (len > 0) {
+        const uint64_t c1 = static_cast<unsigned char>(s[0]);
+        const uint64_t c2 = static_cast<unsigned char>(s[len >> 1]);
+        const uint64_t c3 = static_cast<unsigned char>(s[len - 1]);
+        const uint64_t combined = (c1 << 16) | (c2 << 24) | c3 | (static_cast<uint64_t>(len) << 8);
+        const uint64_t bitflip = (secret4(secret, 0) ^ secret4(secret, 4)) + seed;
+        return xxh64_avalanche(combined ^ bitflip);
+    }
+    return xxh64_avalanche(seed ^ secret8(secret, 56) ^ secret8(secret, 64));
+}
+
+constexpr uint64_t xxh3_medium(std::string_view s, uint64_t seed) {
+    const unsigned char* secret = xxh3_secret;
+    const size_t len = s.size();
+    uint64_t acc = len * xxh_prime64_1;
+    if (len <= 128) {
+        if (len > 32) {
+            if (len > 64) {
+                if (len > 96) {
+                    acc += xxh3_mix16(s, 48, secret, 96, seed);
+                    acc += xxh3_mix16(s, len - 64, secret, 112, seed);
+                }
+                acc += xxh3_mix16(s, 32, secret, 64, seed);
+                acc += xxh3_mix16(s, len - 48, secret, 80, seed);
+            }
+            acc += xxh3_mix16(s, 16, secret, 32, seed);
+            acc += xxh3_mix16(s, len - 32, secret, 48, seed);
+        }
+        acc += xxh3_mix16(s, 0, secret, 0, seed);
+        acc += xxh3_mix16(s, len - 16, secret, 16, seed);
+        return xxh3_avalanche(acc);
+    }
+    for (size_t i = 0; i < 8; ++i) acc += xxh3_mix16(s, 16 * i, secret, 16 * i, seed);
+    acc = xxh3_avalanche(acc);
+    for (size_t i = 8; i < len / 16; ++i) acc += xxh3_mix16(s, 16 * i, secret, 16 * (i - 8) + 3, seed);
+    acc += xxh3_mix16(s, len - 16, secret, 136 - 17, seed);
+    return xxh3_avalanche(acc);
+}
+
+constexpr void xxh3_accumulate_512(uint64_t (&acc)[8], std::string_view s, size_t i,
+                                   const unsigned char* secret, size_t j) {
+    for (size_t lane = 0; lane < 8; ++lane) {
+        const uint64_t data = read8(s, i + 8 * lane);
+        const uint64_t key = data ^ secret8(secret, j + 8 * lane);
+        acc[lane ^ 1] += data;
+        acc[lane] += (key & 0xffffffff) * (key >> 32);
+    }
+}
+
+constexpr void xxh3_scramble(uint64_t (&acc)[8], const unsigned char* secret, size_t j) {
+    for (size_t lane = 0; lane < 8; ++lane) {
+        acc[lane] = (acc[lane] ^ (acc[lane] >> 47) ^ secret8(secret, j + 8 * lane)) * xxh_prime32_1;
+    }
+}
+
+// Inputs over 240 bytes: 8 lanes of 64-bit accumulators over 64-byte
+// stripes, scrambled after every 1 KiB block. A non-zero seed derives a
+// custom secret, as XXH3_64bits_withSeed does.
+constexpr uint64_t xxh3_long(std::string_view s, uint64_t seed) {
+    unsigned char derived[xxh3_secret_size] = {};
+    const unsigned char* secret = xxh3_secret;
+    if (seed != 0) {
+        for (size_t i = 0; i < xxh3_secret_size; i += 16) {
+            const uint64_t lo = secret8(xxh3_secret, i) + seed;
+            const uint64_t hi = secret8(xxh3_secret, i + 8) - seed;
+            for (size_t k = 0; k < 8; ++k) {
+                derived[i + k] = static_cast<unsigned char>(lo >> (8 * k));
+                derived[i + 8 + k] = static_cast<unsigned char>(hi >> (8 * k));
+            }
+        }
+        secret = derived;
+    }
+
+    constexpr size_t stripe = 64;
+    constexpr size_t stripes_per_block = (xxh3_secret_size - stripe) / 8;
+    constexpr size_t block = stripe * stripes_per_block;
+    const size_t len = s.size();
+    uint64_t acc[8] = {xxh_prime32_3, xxh_prime64_1, xxh_prime64_2, xxh_prime64_3,
+                       xxh_prime64_4, xxh_prime32_2, xxh_prime64_5, xxh_prime32_1};
+
+    const size_t blocks = (len - 1) / block;
+    for (size_t b = 0; b < blocks; ++b) {
+        for (size_t n = 0; n < stripes_per_block; ++n) {
+            xxh3_accumulate_512(acc, s, b * block + n * stripe, secret, n * 8);
+        }
+        xxh3_scramble(acc, secret, xxh3_secret_size - stripe);
+    }
+    const size_t last_stripes = ((len - 1) - block * blocks) / stripe;
+    for (size_t n = 0; n < last_stripes; ++n) {
+        xxh3_accumulate_512(acc, s, blocks * block + n * stripe, secret, n * 8);
+    }
+    xxh3_accumulate_512(acc, s, len - stripe, secret, xxh3_secret_size - stripe - 7);
+
+    uint64_t result = len * xxh_prime64_1;
+    for (size_t i = 0; i < 4; ++i) {
+        result += mul128_fold64(acc[2 * i] ^ secret8(secret, 11 + 16 * i),
+                                acc[2 * i + 1] ^ secret8(secret, 11 + 16 * i + 8));
+    }
+    return xxh3_avalanche(result);
+}
+
+} // namespace detail
+
+// XXH3-64 over a byte string; matches XXH3_64bits_withSeed.
+constexpr uint64_t xxh3(std::string_view s, uint64_t seed = 0) {
+    if (s.size() <= 16) return detail::xxh3_short(s, seed);
+    if (s.size() <= 240) return detail::xxh3_medium(s, seed);
+    return detail::xxh3_long(s, seed);
+}
+
+// XXH3-64 over the 8 little-endian bytes of an integer, without going
+// through a byte string.
+constexpr uint64_t xxh3(uint64_t value, uint64_t seed = 0) {
+    return detail::xxh3_4to8(value & 0xffffffff, value >> 32, 8, seed);
+}
+
+namespace detail {
+
+// CRC32C (Castagnoli, reflected polynomial 0x82f63b78), one table lookup
+// per byte; the constant-evaluated and portable path of crc32c below.
+constexpr std::array<uint32_t, 256> make_crc32c_table() {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k) c = (c >> 1) ^ (0x82f63b78u & (0u - (c & 1)));
+        table[i] = c;
+    }
+    return table;
+}
+
+inline constexpr std::array<uint32_t, 256> crc32c_table = make_crc32c_table();
+
+constexpr uint32_t crc32c_bytes(uint32_t crc, uint64_t value, int bytes) {
+    for (int k = 0; k < bytes; ++k) {
+        crc = (crc >> 8) ^ crc32c_table[(crc ^ static_cast<uint32_t>(value >> (8 * k))) & 0xff];
+    }
+    return crc;
+}
+
+} // namespace detail
+
+// CRC32C step over the 8 little-endian bytes of value (no pre- or
+// post-inversion), as the SSE4.2 crc32 instruction computes it. Compiled
+// with SSE4.2 (e.g. -msse4.2) or the ARMv8 CRC extension, runtime calls use
+// the instruction; constant evaluation and other targets use a table.
+constexpr uint32_t crc32c(uint32_t crc, uint64_t value) {
+#if defined(HASH_POLICY_CRC32C_SSE42) || defined(HASH_POLICY_CRC32C_ARM)
+    if (!std::is_constant_evaluated()) {
+#if defined(HASH_POLICY_CRC32C_SSE42)
+        return static_cast<uint32_t>(_mm_crc32_u64(crc, value));
+#else
+        return __crc32cd(crc, value);
+#endif
+    }
+#endif
+    return detail::crc32c_bytes(crc, value, 8);
+}
+
+constexpr uint32_t crc32c(uint32_t crc, uint32_t value) {
+#if defined(HASH_POLICY_CRC32C_SSE42) || defined(HASH_POLICY_CRC32C_ARM)
+    if (!std::is_constant_evaluated()) {
+#if defined(HASH_POLICY_CRC32C_SSE42)
+        return _mm_crc32_u32(crc, value);
+#else
+        return __crc32cw(crc, value);
+#endif
+    }
+#endif
+    return detail::crc32c_bytes(crc, value, 4);
+}
+
+// Cheap finalizer for weak hashes such as the identity std::hash<int>: one
+// 64x64 -> 128 bit multiply folded back to 64 bits, so every input bit
+// reaches both the low bits (used by masking) and the high bits (used by
+// fastrange and by tags).
+constexpr uint64_t mix(uint64_t h) {
+    return detail::wymix(h, 0x9e3779b97f4a7c15ull);
+}
+
+// A hash functor declares `using is_avalanching = std::true_type;` (or
+// void) when every input bit already affects every output bit; the runtime
+// tables then reduce its result to a bucket as is, and mix anything else
+// before the reduction.
+template <typename Hash, typename = void>
+inline constexpr bool is_avalanching_v = false;
+
+template <typename Hash>
+inline constexpr bool is_avalanching_v<Hash, std::void_t<typename Hash::is_avalanching>> =
+    !std::is_same_v<typename Hash::is_avalanching, std::false_type>;
+
+// The hash a table reduces to a bucket, from the 64-bit result of Hash.
+template <typename Hash>
+constexpr uint64_t finalize(uint64_t h) {
+    if constexpr (is_avalanching_v<Hash>) {
+        return h;
+    } else {
+        return mix(h);
+    }
+}
+
+// Hash functors usable both at compile time and at runtime. They accept any
+// integral/enum key and anything convertible to std::string_view.
+struct Fnv1aHash {
+    template <typename T, std::enable_if_t<is_integral_key_v<T>, int> = 0>
+    constexpr uint64_t operator()(T key) const { return fnv1a(detail::integral_bits(key)); }
+
+    constexpr uint64_t operator()(std::string_view key) const { return fnv1a(key); }
+};
+
+struct WyHash {
+    using is_avalanching = std::true_type;
+
+    template <typename T, std::enable_if_t<is_integral_key_v<T>, int> = 0>
+    constexpr uint64_t operator()(T key) const { return wyhash(detail::integral_bits(key)); }
+
+    constexpr uint64_t operator()(std::string_view key) const { return wyhash(key); }
+};
+
+struct Xxh3Hash {
+    using is_avalanching = std::true_type;
+
+    template <typename T, std::enable_if_t<is_integral_key_v<T>, int> = 0>
+    constexpr uint64_t operator()(T key) const { return xxh3(detail::integral_bits(key)); }
+
+    constexpr uint64_t operator()(std::string_view key) const { return xxh3(key); }
+};
+
+// Integer keys only. CRC32C is a bijection on 32-bit inputs, so CRCs of the
+// two halves (one instruction each, independent) keep 64-bit keys distinct;
+// but CRC is linear, so the tables still mix the result.
+struct Crc32cHash {
+    using is_avalanching = std::false_type;
+
+    template <typename T, std::enable_if_t<is_integral_key_v<T>, int> = 0>
+    constexpr uint64_t operator()(T key) const {
+        const uint64_t bits = detail::integral_bits(key);
+        return (static_cast<uint64_t>(crc32c(0u, static_cast<uint32_t>(bits >> 32))) << 32) |
+               crc32c(0u, bits);
+    }
+};
+
+// Transparent std::hash for string keys: std::string, std::string_view and
+// const char* all hash (identically) without building a temporary string.
+struct StringHash {
+    using is_transparent = void;
+
+    size_t operator()(std::string_view key) const { return std::hash<std::string_view>{}(key); }
+};
+
+template <typename K>
+struct default_hash { using type = std::hash<K>; };
+
+template <>
+struct default_hash<std::string> { using type = StringHash; };
+
+template <typename K>
+struct default_key_equal { using type = std::equal_to<K>; };
+
+template <>
+struct default_key_equal<std::string> { using type = std::equal_to<>; };
+
+// Functors a runtime table uses when none are given: std::hash and
+// operator==, made transparent for std::string keys.
+template <typename K>
+using DefaultHash = typename default_hash<K>::type;
+
+template <typename K>
+using DefaultKeyEqual = typename default_key_equal<K>::type;
+
+// What the runtime tables require of their functors: Hash maps a const K&
+// to an integer, KeyEqual compares two of them.
+template <typename Hash, typename K>
+concept hasher_for = requires(const Hash& hash, const K& key) {
+    { hash(key) } -> std::convertible_to<uint64_t>;
+};
+
+template <typename KeyEqual, typename K>
+concept key_equal_for = requires(const KeyEqual& equal, const K& key) {
+    { equal(key, key) } -> std::convertible_to<bool>;
+};
+
+// Heterogeneous lookup is enabled when both functors opt in.
+template <typename Hash, typename KeyEqual, typename = void>
+inline constexpr bool is_transparent_v = false;
+
+template <typename Hash, typename KeyEqual>
+inline constexpr bool is_transparent_v<Hash, KeyEqual,
+    std::void_t<typename Hash::is_transparent, typename KeyEqual::is_transparent>> = true;
+
+// What a HashTable keeps of each entry's hash (its StoredHash parameter),
+// trading memory for CPU on keys that are expensive to hash or compare:
+//
+//   NoStoredHash      nothing, the default: every compare calls KeyEqual and
+//                     every resize hashes the keys again
+//   StoreHash         the full hash, next to the entry: compares against a
+//                     different hash skip KeyEqual, and resizes never call
+//                     Hash
+//   StoreFingerprint  32 bits of it, for half the memory. The table then
+//                     indexes buckets with the fingerprint widened to 64
+//                     bits (table_hash), so the stored bits still give the
+//                     bucket for any capacity and resizes need no Hash call
+//                     either. Only 32 bits vary, though: buckets spread as
+//                     well up to 2^32 of them (across all shards), and past
+//                     that each key is confined to a fraction of them
+//
+// table_hash(h) maps a finalized hash to the one the table works with,
+// store() keeps that in an entry's `type` and load() recovers it.
+struct NoStoredHash {
+    static constexpr bool enabled = false;
+    struct type {};
+
+    static constexpr uint64_t table_hash(uint64_t h) { return h; }
+    static constexpr type store(uint64_t) { return {}; }
+};
+
+struct StoreHash {
+    static constexpr bool enabled = true;
+    using type = uint64_t;
+
+    static constexpr uint64_t table_hash(uint64_t h) { return h; }
+    static constexpr type store(uint64_t h) { return h; }
+    static constexpr uint64_t load(type stored) { return stored; }
+};
+
+struct StoreFingerprint {
+    static constexpr bool enabled = true;
+    using type = uint32_t;
+
+    // Both halves of the hash fold into the fingerprint. It stays as the
+    // low bits (read by masking, and all that store() keeps), while the
+    // high bits (read by fastrange and the shard partitions) get a
+    // bijective multiplicative mix of it (murmur3's fmix32) rather than a
+    // copy, so a shard's bits say nothing about its entries' buckets.
+    static constexpr uint64_t table_hash(uint64_t h) { return load(static_cast<uint32_t>(h ^ (h >> 32))); }
+    static constexpr type store(uint64_t h) { return static_cast<uint32_t>(h); }
+    static constexpr uint64_t load(type stored) {
+        uint32_t high = stored;
+        high ^= high >> 16;
+        high *= 0x85ebca6b;
+        high ^= high >> 13;
+        high *= 0xc2b2ae35;
+        high ^= high >> 16;
+        return uint64_t{high} << 32 | stored;
+    }
+};
+
+} // namespace hash_policy
+
+#endif // HASH_POLICY_HPP
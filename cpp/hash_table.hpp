@@ -2,40 +2,122 @@
 #define HASH_TABLE_HPP
 
 #include <iostream>
+#include <algorithm>
 #include <array>
+#include <bit>
+#include <chrono>
+#include <concepts>
+#include <iterator>
 #include <memory>
 #include <utility>
 #include <optional>
+#include <functional>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <vector>
 
+#include "capacity_policy.hpp"
+#include "hash_policy.hpp"
+#include "lookup_task.hpp"
+#include "parallel.hpp"
+#include "prefetch.hpp"
+#include "slab_allocator.hpp"
+#include "table_layout.hpp"
+#include "table_stats.hpp"
 
-template <typename K, typename V>
-struct HashNode {
+
+// Key-value pair of a HashTable. The inline base tier stores bare entries;
+// everything else lives in HashNodes, which add the chain pointer.
+//
+// stored_hash is what the table's StoredHash policy keeps of the key's hash
+// (hash_policy::StoreHash, ...); with the default NoStoredHash it is empty
+// and takes no space. Entries destructure like a pair, as [key, value].
+template <typename K, typename V, typename StoredHash = hash_policy::NoStoredHash>
+struct HashEntry {
     K key;
     V value;
-    std::unique_ptr<HashNode<K, V>> next;
+    [[no_unique_address]] typename StoredHash::type stored_hash{};
 
     // Default constructor
-    HashNode() : key(), value(), next(nullptr) {}
+    HashEntry() : key(), value() {}
 
     // Constructor with key and value
-    HashNode(const K& k, const V& v) : key(k), value(v), next(nullptr) {}
+    HashEntry(const K& k, const V& v) : key(k), value(v) {}
+
+    // Constructor taking key and value by move
+    HashEntry(K&& k, V&& v) : key(std::move(k)), value(std::move(v)) {}
+
+    // Piecewise constructor, building key and value in place from argument
+    // tuples (see HashTable::try_emplace)
+    template <typename... KArgs, typename... VArgs>
+    HashEntry(std::piecewise_construct_t, std::tuple<KArgs...> k, std::tuple<VArgs...> v)
+        : key(std::make_from_tuple<K>(std::move(k))),
+          value(std::make_from_tuple<V>(std::move(v))) {}
+
+    HashEntry(HashEntry&&) = default;
+    HashEntry& operator=(HashEntry&&) = default;
+
+    // Copies are deleted to prevent accidental copies
+    HashEntry(const HashEntry&) = delete;
+    HashEntry& operator=(const HashEntry&) = delete;
+
+    // Tuple-like access for structured bindings
+    template <size_t I>
+    auto& get() & {
+        if constexpr (I == 0) return key; else return value;
+    }
+
+    template <size_t I>
+    const auto& get() const& {
+        if constexpr (I == 0) return key; else return value;
+    }
+
+    template <size_t I>
+    auto&& get() && {
+        if constexpr (I == 0) return std::move(key); else return std::move(value);
+    }
+};
+
+template <typename K, typename V, typename StoredHash>
+struct std::tuple_size<HashEntry<K, V, StoredHash>> : std::integral_constant<size_t, 2> {};
+
+template <size_t I, typename K, typename V, typename StoredHash>
+struct std::tuple_element<I, HashEntry<K, V, StoredHash>> {
+    using type = std::conditional_t<I == 0, K, V>;
+};
+
+
+// Node of a HashTable bucket chain. The chain pointer is a plain pointer:
+// nodes are created and destroyed by the owning table through its
+// allocator, so a node carries no deleter or allocator state of its own.
+template <typename K, typename V, typename StoredHash = hash_policy::NoStoredHash>
+struct HashNode : HashEntry<K, V, StoredHash> {
+    using Entry = HashEntry<K, V, StoredHash>;
+
+    HashNode* next = nullptr;
+
+    // Same constructors as HashEntry, with no successor
+    using Entry::Entry;
+
+    // Constructor taking over an entry (key, value and stored hash)
+    explicit HashNode(Entry&& entry) : Entry(std::move(entry)) {}
 
     // Constructor with key, value, and next pointer
-    HashNode(const K& k, const V& v, std::unique_ptr<HashNode<K, V>> nextNode)
-        : key(k), value(v), next(std::move(nextNode)) {}
+    HashNode(const K& k, const V& v, HashNode* nextNode)
+        : Entry(k, v), next(nextNode) {}
 
     // Move constructor
     HashNode(HashNode&& other) noexcept
-        : key(std::move(other.key)),
-          value(std::move(other.value)),
-          next(std::move(other.next)) {}
+        : Entry(std::move(other)),
+          next(std::exchange(other.next, nullptr)) {}
 
     // Move assignment operator
     HashNode& operator=(HashNode&& other) noexcept {
         if (this != &other) {
-            key = std::move(other.key);
-            value = std::move(other.value);
-            next = std::move(other.next);
+            Entry::operator=(std::move(other));
+            next = std::exchange(other.next, nullptr);
         }
         return *this;
     }
@@ -48,220 +130,1497 @@ struct HashNode {
 };
 
 
-template <typename K, typename V, size_t base_size>
+// Chained hash table with a fixed-size inline base tier and a growable heap
+// tier. Both tiers share one index space of base_size + heap_size buckets:
+// buckets below base_size live in base_array, the rest in heap_array.
+//
+// A base slot is a bare {key, value} HashEntry with no engaged flag and no
+// chain pointer: occupancy is a bitmap next to the slots, and the rest of a
+// base bucket's chain hangs off base_chains, an array allocated on the first
+// base collision (or the first grow()). A table that never chains in its
+// base tier pays sizeof(K) + sizeof(V) plus one bit per base slot.
+//
+// That is the inline_base layout; table_layout_traits (table_layout.hpp)
+// picks it or one of two others at compile time from K, V and base_size.
+// With node_base the base slots are chain heads and every entry is a node
+// that never moves, for large or non-movable values. With direct, small
+// integer and enum keys index the base tier themselves, unhashed, and the
+// table never grows. Configurations that cannot work (base_size == 0, a
+// key Hash or KeyEqual cannot handle, ...) fail a static_assert up front.
+//
+// Growth is incremental. grow() only allocates the larger heap array; the
+// old one stays alive next to it and every insert/erase migrates a few old
+// buckets into the new layout, so no single operation rehashes the whole
+// table. While a migration is in flight lookups check the new bucket first
+// and then the old one, unless that old bucket was already migrated.
+// Shrinking works the same way: erase starts migrating to a smaller layout
+// once the load factor drops below 0.0875, and rehash(n)/shrink_to_fit()
+// resize on request.
+//
+// Capacity picks the growth schedule and the hash -> bucket reduction
+// (masking or fastrange, see capacity_policy.hpp). While the heap tier is
+// empty the capacity is exactly base_size, a compile-time constant. Hashes
+// are passed through hash_policy::mix first, so identity hashes spread over
+// all buckets, unless Hash is tagged is_avalanching (hash_policy::WyHash,
+// hash_policy::Xxh3Hash).
+//
+// Hash and KeyEqual default to std::hash and operator==; for std::string
+// keys the defaults are transparent, so get/erase/contains accept a
+// std::string_view or const char* without building a temporary. Any other
+// pair of functors that both define is_transparent enables the same.
+//
+// Overflow nodes and the heap bucket arrays come from Allocator, rebound to
+// HashNode and HashNode* respectively. With SlabAllocator (slab_allocator.hpp)
+// nodes are carved from contiguous chunks and recycled through a free list;
+// if K and V are trivially destructible and no other table or copy shares
+// the arena, the destructor then skips walking the chains and leaves the
+// chunks to the arena.
+//
+// Stats is an instrumentation policy (table_stats.hpp). The default,
+// NoTableStats, compiles to nothing; with TableStats the table records
+// probe-length histograms of lookups and inserts, hits and misses, grow
+// count and time, and live heap bytes, read through stats().
+//
+// StoredHash (hash_policy.hpp) makes every entry keep its hash, or a 32-bit
+// fingerprint of it: chain walks then skip KeyEqual on entries whose hash
+// differs, and grows, shrinks and migrations reuse the stored hash instead
+// of calling Hash again. Worth it for long string keys and the like; the
+// default NoStoredHash keeps entries as they are.
+//
+// from_range allocates all of a table's overflow nodes as one block (see
+// bulk_build); those nodes stay in their block until the table is
+// destroyed, and erasing one only destroys its contents.
+template <typename K, typename V, size_t base_size,
+          typename Hash = hash_policy::DefaultHash<K>,
+          typename KeyEqual = hash_policy::DefaultKeyEqual<K>,
+          typename Capacity = PowerOfTwoCapacity,
+          typename Allocator = std::allocator<std::pair<const K, V>>,
+          typename Stats = NoTableStats,
+          typename StoredHash = hash_policy::NoStoredHash>
 class HashTable {
-    std::array<std::optional<HashNode<K, V>>, base_size> base_array;//this can be constexpr
-    std::unique_ptr<std::unique_ptr<HashNode<K, V>>[]> heap_array = nullptr;
+    using Entry = HashEntry<K, V, StoredHash>;
+    using Node = HashNode<K, V, StoredHash>;
+    using NodeAlloc = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+    using NodeTraits = std::allocator_traits<NodeAlloc>;
+    using BucketAlloc = typename std::allocator_traits<Allocator>::template rebind_alloc<Node*>;
+    using BucketTraits = std::allocator_traits<BucketAlloc>;
+
+    static constexpr TableLayout layout = table_layout_traits<K, V, base_size>::layout;
+    static constexpr bool inline_base = layout != TableLayout::node_base;
+    static constexpr bool direct = layout == TableLayout::direct;
+
+    static_assert(base_size > 0, "HashTable needs a base tier of at least one bucket");
+    static_assert(direct || hash_policy::hasher_for<Hash, K>,
+                  "Hash cannot hash a const K&: specialize std::hash<K> or pass a Hash functor");
+    static_assert(hash_policy::key_equal_for<KeyEqual, K> &&
+                  (!std::is_same_v<KeyEqual, std::equal_to<K>> || std::equality_comparable<K>),
+                  "KeyEqual cannot compare two const K&: define operator== or pass a KeyEqual functor");
+    static_assert(!direct || (direct_key_range_v<K> != 0 && direct_key_range_v<K> <= base_size),
+                  "TableLayout::direct needs an integer or enum key of at most 16 bits "
+                  "and a base slot for each of its values");
+    static_assert(!inline_base || (std::is_move_constructible_v<K> && std::is_move_constructible_v<V>),
+                  "Inline base slots move entries around; non-movable keys or values need "
+                  "TableLayout::node_base (see table_layout_traits)");
+    static_assert(NodeTraits::propagate_on_container_move_assignment::value ||
+                  NodeTraits::is_always_equal::value,
+                  "HashTable moves its nodes wholesale and needs an allocator that propagates on move");
+
+    static constexpr bool skip_node_destruction =
+        allocator_is_arena<NodeAlloc>::value &&
+        std::is_trivially_destructible_v<K> && std::is_trivially_destructible_v<V>;
+
+    // Whether destroy() may leave the nodes to the arena: only while this
+    // table holds its only copy, so the chunks go when the table does. A
+    // shared arena outlives the table and gets its nodes back one by one.
+    bool leave_nodes_to_arena() const {
+        if constexpr (skip_node_destruction) {
+            return node_alloc.sole_owner();
+        } else {
+            return false;
+        }
+    }
+
+    // Old buckets moved per insert/erase during a migration. Growth doubles
+    // the capacity and triggers at 70% load, so this finishes a migration
+    // well before the next grow() is due.
+    static constexpr size_t migrate_batch = 4;
+
+    // get/erase/contains overloads for keys other than K
+    template <typename Q>
+    static constexpr bool lookup_with =
+        hash_policy::is_transparent_v<Hash, KeyEqual> && !std::is_same_v<Q, K>;
+
+    // Storage for one base entry, constructed only while its bit is set.
+    union BaseSlot {
+        Entry entry;
+        BaseSlot() {}
+        ~BaseSlot() {}
+    };
+
+    // With node_base only base_heads is used, otherwise only the others.
+    std::array<BaseSlot, inline_base ? base_size : 0> base_array;
+    std::array<uint64_t, inline_base ? (base_size + 63) / 64 : 0> base_used{};
+    Node** base_chains = nullptr;  // base_size chain heads, or null
+    std::array<Node*, inline_base ? 0 : base_size> base_heads{};
+    [[no_unique_address]] Hash hasher;
+    [[no_unique_address]] KeyEqual key_eq;
+    [[no_unique_address]] NodeAlloc node_alloc;
+    // Kept for the table's lifetime: a rebound allocator may own memory of
+    // its own (SlabAllocator starts a new arena), so a temporary one could
+    // hand out a bucket array that dies with it.
+    [[no_unique_address]] BucketAlloc bucket_alloc{node_alloc};
+    [[no_unique_address]] mutable Stats table_stats;
+    Node** heap_array = nullptr;
     size_t heap_size = 0;
     size_t num_entries = 0;
 
-public:
-    // Constructor
-    HashTable() {}
+    // Layout being migrated away from; old_heap_size + base_size buckets
+    // of which the ones below migrate_pos are already done.
+    Node** old_heap_array = nullptr;
+    size_t old_heap_size = 0;
+    size_t migrate_pos = 0;
+    bool migrating = false;
 
+    // Overflow nodes allocated as one block by from_range.
+    Node* bulk_nodes = nullptr;
+    size_t bulk_size = 0;
 
-    // Grow function to resize heap array
-    void grow() {
-        size_t new_heap_size = heap_size * 2 + 10;
+    template <typename Q>
+    size_t hash_of(const Q& key) const {
+        if constexpr (direct) return direct_index(key);
+        return static_cast<size_t>(StoredHash::table_hash(
+            hash_policy::finalize<Hash>(static_cast<uint64_t>(hasher(key)))));
+    }
 
-        // Allocate new larger array
-        auto new_heap_array = std::make_unique<std::unique_ptr<HashNode<K, V>>[]>(new_heap_size);
+    // Hash of an entry's key, from the entry itself if it keeps one.
+    size_t entry_hash(const Entry& entry) const {
+        if constexpr (StoredHash::enabled) {
+            return static_cast<size_t>(StoredHash::load(entry.stored_hash));
+        } else {
+            return hash_of(entry.key);
+        }
+    }
 
+    static void remember_hash(Entry& entry, size_t hash) {
+        if constexpr (StoredHash::enabled) entry.stored_hash = StoredHash::store(hash);
+    }
 
-        // Move entries from old heap array to new array
-        for (size_t i = 0; i < heap_size; ++i) {
-            if (heap_array[i]) {
-                new_heap_array[i] = std::move(heap_array[i]);
-            }
+    // Whether entry holds key, whose hash is `hash`. A stored hash that
+    // differs rules the entry out without comparing keys.
+    template <typename Q>
+    bool matches(const Entry& entry, const Q& key, size_t hash) const {
+        if constexpr (StoredHash::enabled) {
+            if (entry.stored_hash != StoredHash::store(hash)) return false;
         }
+        return key_eq(entry.key, key);
+    }
 
-        for (size_t i = 0; i < base_size; ++i) {
-            if (base_array[i]) {
-                new_heap_array[i] = std::make_unique<HashNode<K, V>>(std::move(base_array[i]).value());
+    static size_t index_for(size_t hash, size_t capacity) {
+        if constexpr (direct) return hash;
+        if (capacity == base_size) return Capacity::template reduce_fixed<base_size>(hash);
+        return Capacity::reduce(hash, capacity);
+    }
 
-            }
+    template <typename... Args>
+    Node* new_node(Args&&... args) {
+        Node* node = NodeTraits::allocate(node_alloc, 1);
+        try {
+            NodeTraits::construct(node_alloc, node, std::forward<Args>(args)...);
+        } catch (...) {
+            NodeTraits::deallocate(node_alloc, node, 1);
+            throw;
+        }
+        table_stats.on_allocate(sizeof(Node));
+        return node;
+    }
+
+    bool in_bulk_block(const Node* node) const {
+        std::less<const Node*> less;
+        return !less(node, bulk_nodes) && less(node, bulk_nodes + bulk_size);
+    }
+
+    void delete_node(Node* node) {
+        NodeTraits::destroy(node_alloc, node);
+        if (!in_bulk_block(node)) {
+            NodeTraits::deallocate(node_alloc, node, 1);
+            table_stats.on_free(sizeof(Node));
+        }
+    }
+
+    void delete_chain(Node* node) {
+        while (node) {
+            delete_node(std::exchange(node, node->next));
         }
+    }
+
+    Node** allocate_buckets(size_t n) {
+        Node** buckets = BucketTraits::allocate(bucket_alloc, n);
+        std::uninitialized_fill_n(buckets, n, nullptr);
+        table_stats.on_allocate_buckets(n * sizeof(Node*));
+        return buckets;
+    }
 
-        // Clean up old array and update pointers
-        heap_array = std::move(new_heap_array);
-        heap_size = new_heap_size;
+    void free_buckets(Node** buckets, size_t n) {
+        if (!buckets) return;
+        BucketTraits::deallocate(bucket_alloc, buckets, n);
+        table_stats.on_free_buckets(n * sizeof(Node*));
     }
 
-// Insert a new key-value pair (in-place for the base array)
-void insert(const K& key, const V& value) {
-    // Grow if load factor exceeds 0.7
-    if (++num_entries > 0.7 * (base_size + heap_size)) {
-        grow();
+    // Whether bucket `index` starts with an inline entry slot.
+    static constexpr bool inline_slot(size_t index) { return inline_base && index < base_size; }
+
+    bool base_occupied(size_t index) const {
+        return (base_used[index / 64] >> (index % 64)) & 1;
     }
 
-    // Compute the index for insertion over both arrays.
-    size_t index = std::hash<K>{}(key) % (base_size + heap_size);
+    Entry* base_entry(size_t index) const {
+        return const_cast<Entry*>(&base_array[index].entry);
+    }
+
+    template <typename... Args>
+    Entry* construct_base(size_t index, Args&&... args) {
+        Entry* entry = std::construct_at(&base_array[index].entry, std::forward<Args>(args)...);
+        base_used[index / 64] |= uint64_t{1} << (index % 64);
+        return entry;
+    }
 
-    if (index < base_size) {
-        // For the base array, construct in place.
-        if (!base_array[index]) {
-            base_array[index].emplace(key, value);
+    void destroy_base(size_t index) {
+        std::destroy_at(&base_array[index].entry);
+        base_used[index / 64] &= ~(uint64_t{1} << (index % 64));
+    }
+
+    // Rest of base bucket `index` after its inline entry (with node_base,
+    // the whole bucket).
+    Node* base_chain(size_t index) const {
+        if constexpr (!inline_base) return base_heads[index];
+        return base_chains ? base_chains[index] : nullptr;
+    }
+
+    void ensure_base_chains() {
+        if (inline_base && !base_chains) base_chains = allocate_buckets(base_size);
+    }
+
+    // Link to the first node of bucket `index` in the layout whose heap tier
+    // is `heap`; base_chains must exist for an inline base bucket.
+    Node*& chain_head(Node** heap, size_t index) {
+        if (index >= base_size) return heap[index - base_size];
+        if constexpr (inline_base) {
+            return base_chains[index];
         } else {
-            // Collision in base array: allocate a new node on the heap and chain it.
-            auto new_node = std::make_unique<HashNode<K, V>>(key, value, nullptr);
-            new_node->next = std::move(base_array[index]->next);
-            base_array[index]->next = std::move(new_node);
-        }
-    } else {
-        // For the heap array, compute the proper heap index.
-        size_t heap_index = index - base_size;
-        if (!heap_array[heap_index]) {
-            heap_array[heap_index] = std::make_unique<HashNode<K, V>>(key, value, nullptr);
+            return base_heads[index];
+        }
+    }
+
+    // Take over the base entries of `other`, leaving its base tier empty.
+    void take_base(HashTable& other) noexcept {
+        if constexpr (inline_base) {
+            for (size_t i = 0; i < base_size; ++i) {
+                if (!other.base_occupied(i)) continue;
+                construct_base(i, std::move(*other.base_entry(i)));
+                other.destroy_base(i);
+            }
+            base_chains = std::exchange(other.base_chains, nullptr);
         } else {
-            // Collision in heap array: chain using heap allocation.
-            auto new_node = std::make_unique<HashNode<K, V>>(key, value, nullptr);
-            new_node->next = std::move(heap_array[heap_index]);
-            heap_array[heap_index] = std::move(new_node);
+            base_heads = std::exchange(other.base_heads, {});
         }
     }
-}
 
-// Retrieve the value associated with a key (const version)
-std::optional<std::reference_wrapper<const V>> get(const K& key) const {
-    size_t index = std::hash<K>{}(key) % (base_size + heap_size);
+    // Destroy every entry and release the heap tiers.
+    void destroy() {
+        const bool free_nodes = !leave_nodes_to_arena();
+        if constexpr (inline_base) {
+            for (size_t i = 0; i < base_size; ++i) {
+                if (!base_occupied(i)) continue;
+                if (free_nodes) delete_chain(base_chain(i));
+                destroy_base(i);
+            }
+        } else {
+            if (free_nodes) {
+                for (Node* head : base_heads) delete_chain(head);
+            }
+            base_heads.fill(nullptr);
+        }
+        free_buckets(base_chains, base_size);
+        base_chains = nullptr;
+        if (free_nodes) {
+            for (size_t i = 0; i < heap_size; ++i) delete_chain(heap_array[i]);
+            if (migrating) {
+                for (size_t i = 0; i < old_heap_size; ++i) delete_chain(old_heap_array[i]);
+            }
+        }
+        free_buckets(heap_array, heap_size);
+        free_buckets(old_heap_array, old_heap_size);
+        if (bulk_nodes) {
+            NodeTraits::deallocate(node_alloc, bulk_nodes, bulk_size);
+            table_stats.on_free(bulk_size * sizeof(Node));
+        }
+        bulk_nodes = nullptr;
+        bulk_size = 0;
+        heap_array = old_heap_array = nullptr;
+        heap_size = old_heap_size = num_entries = migrate_pos = 0;
+        migrating = false;
+        table_stats.on_clear();  // also covers nodes left to an arena
+    }
 
-    if (index < base_size) {
-        auto* node = base_array[index] ? &base_array[index].value() : nullptr;
+    // Lookups count the keys they compare in `probes` for the Stats policy.
+    template <typename Q>
+    Entry* find_in(Node* node, const Q& key, size_t hash, size_t& probes) const {
         while (node) {
-            if (node->key == key) {
-                return std::cref(node->value);  // Return const reference
+            ++probes;
+            if (matches(*node, key, hash)) return node;
+            node = node->next;
+        }
+        return nullptr;
+    }
+
+    // Find key in bucket `index` of the layout whose heap tier is `heap`.
+    template <typename Q>
+    Entry* find_in_bucket(Node** heap, size_t index, const Q& key, size_t hash, size_t& probes) const {
+        if (inline_slot(index)) {
+            if (!base_occupied(index)) return nullptr;
+            Entry* entry = base_entry(index);
+            ++probes;
+            if (matches(*entry, key, hash)) return entry;
+            return find_in(base_chain(index), key, hash, probes);
+        }
+        if (index < base_size) return find_in(base_chain(index), key, hash, probes);
+        return find_in(heap[index - base_size], key, hash, probes);
+    }
+
+    // Old bucket a key would still be found in, or npos once that bucket
+    // was migrated (or when it is the same physical base slot as index).
+    static constexpr size_t npos = static_cast<size_t>(-1);
+    size_t old_index(size_t hash, size_t index) const {
+        if (!migrating) return npos;
+        size_t old = index_for(hash, base_size + old_heap_size);
+        if (old < migrate_pos || (old < base_size && old == index)) return npos;
+        return old;
+    }
+
+    template <typename Q>
+    Entry* find_node(const Q& key, size_t hash, size_t index, size_t& probes) const {
+        if (Entry* entry = find_in_bucket(heap_array, index, key, hash, probes)) return entry;
+
+        size_t old = old_index(hash, index);
+        if (old == npos) return nullptr;
+        return find_in_bucket(old_heap_array, old, key, hash, probes);
+    }
+
+    template <typename Q>
+    Entry* lookup(const Q& key, size_t hash) const {
+        size_t probes = 0;
+        Entry* entry = find_node(key, hash, index_for(hash, base_size + heap_size), probes);
+        table_stats.on_lookup(probes, entry != nullptr);
+        return entry;
+    }
+
+    // Link a detached node into bucket `index` of the current layout. An
+    // empty base slot takes over the node's contents instead. Returns where
+    // the entry ended up.
+    Entry* link(Node* node, size_t index) {
+        if constexpr (inline_base) {
+            if (index < base_size) {
+                if (!base_occupied(index)) {
+                    Entry* entry = construct_base(index, std::move(static_cast<Entry&>(*node)));
+                    delete_node(node);
+                    return entry;
+                }
+                try {
+                    ensure_base_chains();
+                } catch (...) {
+                    delete_node(node);
+                    throw;
+                }
             }
-            node = node->next.get();
         }
-    } else {
-        size_t heap_index = index - base_size;
-        auto* node = heap_array[heap_index].get();
-        while (node) {
-            if (node->key == key) {
-                return std::cref(node->value);  // Return const reference
+        Node*& head = chain_head(heap_array, index);
+        node->next = head;
+        head = node;
+        return node;
+    }
+
+    // Build an entry for a key of hash `hash` in bucket `index` of the
+    // current layout: directly in an empty base slot, otherwise in a fresh
+    // node.
+    template <typename... Args>
+    Entry* place(size_t index, size_t hash, Args&&... args) {
+        if (inline_slot(index) && !base_occupied(index)) {
+            Entry* entry = construct_base(index, std::forward<Args>(args)...);
+            remember_hash(*entry, hash);
+            return entry;
+        }
+        Node* node = new_node(std::forward<Args>(args)...);
+        remember_hash(*node, hash);
+        return link(node, index);
+    }
+
+    // Make room for one more entry, growing if it would take the load
+    // factor above 0.7. Returns the (possibly new) bucket index for `hash`.
+    // The caller counts the entry once it is in place, so a throwing
+    // allocation or constructor leaves size() as it was.
+    size_t reserve_one(size_t hash, size_t index) {
+        if (num_entries + 1 > 0.7 * (base_size + heap_size) && !direct) {
+            grow();
+            index = index_for(hash, base_size + heap_size);
+        }
+        return index;
+    }
+
+    // ShardedHashTable, NumaHashTable and OverlayHashTable hash each key
+    // once and pass the hash in.
+    template <typename, typename, size_t, size_t, typename, typename, typename, typename>
+    friend class ShardedHashTable;
+    template <typename, typename, size_t, size_t, typename, typename, typename>
+    friend class NumaHashTable;
+    template <typename, typename, size_t, typename, size_t, size_t>
+    friend class OverlayHashTable;
+
+    template <typename R, typename Q>
+    std::optional<std::reference_wrapper<R>> get_impl(const Q& key, size_t hash) const {
+        if (Entry* entry = lookup(key, hash)) {
+            return std::ref<R>(entry->value);
+        }
+        return std::nullopt;  // Key not found
+    }
+
+    template <typename Q>
+    bool erase_impl(const Q& key, size_t hash) {
+        migrate_step(migrate_batch);
+
+        size_t index = index_for(hash, base_size + heap_size);
+        bool erased = erase_in(heap_array, index, key, hash);
+        if (!erased) {
+            size_t old = old_index(hash, index);
+            erased = old != npos && erase_in(old_heap_array, old, key, hash);
+        }
+
+        if (erased) {
+            --num_entries;
+            shrink_if_sparse();
+        }
+        return erased; // false if key not found
+    }
+
+    // Single-pass find-or-insert: one hash, one bucket walk, and on a miss
+    // the entry is built in place from the argument tuples.
+    template <typename KArg, typename... Args>
+    std::pair<V&, bool> try_emplace_impl(KArg&& key, Args&&... args) {
+        size_t hash = hash_of(key);
+        return try_emplace_hashed(hash, std::forward<KArg>(key), std::forward<Args>(args)...);
+    }
+
+    template <typename KArg, typename... Args>
+    std::pair<V&, bool> try_emplace_hashed(size_t hash, KArg&& key, Args&&... args) {
+        migrate_step(migrate_batch);
+
+        size_t index = index_for(hash, base_size + heap_size);
+        size_t probes = 0;
+        Entry* existing = find_node(key, hash, index, probes);
+        table_stats.on_insert(probes);
+        if (existing) return {existing->value, false};
+
+        index = reserve_one(hash, index);
+        Entry* entry = place(index, hash, std::piecewise_construct,
+                             std::forward_as_tuple(std::forward<KArg>(key)),
+                             std::forward_as_tuple(std::forward<Args>(args)...));
+        ++num_entries;
+        return {entry->value, true};
+    }
+
+    // Keys of a batched operation kept in flight: enough independent misses
+    // to cover memory latency, few enough for the per-key state to stay in
+    // L1.
+    static constexpr size_t batch_distance = 8;
+    static constexpr size_t batch_ring = 4 * batch_distance;  // power of two > 2 * distance
+
+    const void* bucket_address(size_t index) const {
+        if (index >= base_size) return &heap_array[index - base_size];
+        if constexpr (inline_base) {
+            return &base_array[index];
+        } else {
+            return &base_heads[index];
+        }
+    }
+
+    // Software-pipelined lookup. While key i is compared, the chain head of
+    // key i + distance is loaded and its node prefetched, and key
+    // i + 2 * distance is hashed and its bucket prefetched, so the bucket
+    // and node misses of many keys overlap instead of being paid one after
+    // another. Longer chains are walked with the next node prefetched. For
+    // a base bucket the prefetched slot holds the first entry itself and
+    // the chain head comes from base_chains.
+    template <typename R>
+    void get_batch_impl(std::span<const K> keys, std::span<R*> out) const {
+        if (keys.size() != out.size()) {
+            throw std::invalid_argument("get_batch needs one output slot per key.");
+        }
+        const size_t n = keys.size();
+        const size_t capacity = base_size + heap_size;
+        size_t hashes[batch_ring];
+        size_t indices[batch_ring];
+        Node* heads[batch_ring];
+
+        auto hash_stage = [&](size_t i) {
+            const size_t slot = i & (batch_ring - 1);
+            hashes[slot] = hash_of(keys[i]);
+            indices[slot] = index_for(hashes[slot], capacity);
+            prefetch(bucket_address(indices[slot]));
+            if (inline_slot(indices[slot]) && base_chains) prefetch(&base_chains[indices[slot]]);
+        };
+        auto head_stage = [&](size_t i) {
+            const size_t slot = i & (batch_ring - 1);
+            const size_t index = indices[slot];
+            heads[slot] = index < base_size ? base_chain(index) : heap_array[index - base_size];
+            if (heads[slot]) prefetch(heads[slot]);
+        };
+
+        for (size_t i = 0; i < std::min(n, 2 * batch_distance); ++i) hash_stage(i);
+        for (size_t i = 0; i < std::min(n, batch_distance); ++i) head_stage(i);
+
+        for (size_t i = 0; i < n; ++i) {
+            if (i + 2 * batch_distance < n) hash_stage(i + 2 * batch_distance);
+            if (i + batch_distance < n) head_stage(i + batch_distance);
+
+            const size_t slot = i & (batch_ring - 1);
+            const size_t index = indices[slot];
+            Entry* found = nullptr;
+            if (!inline_slot(index) || base_occupied(index)) {
+                if (inline_slot(index) && matches(*base_entry(index), keys[i], hashes[slot])) {
+                    found = base_entry(index);
+                } else {
+                    Node* node = heads[slot];
+                    while (node && !matches(*node, keys[i], hashes[slot])) {
+                        node = node->next;
+                        if (node) prefetch(node->next);
+                    }
+                    found = node;
+                }
+            }
+            // Keys whose old bucket was not migrated yet may still live there.
+            if (!found && migrating) {
+                size_t old = old_index(hashes[slot], index);
+                size_t probes = 0;
+                if (old != npos) found = find_in_bucket(old_heap_array, old, keys[i], hashes[slot], probes);
             }
-            node = node->next.get();
+            out[i] = found ? &found->value : nullptr;
         }
     }
 
-    return std::nullopt;  // Key not found
-}
+    // Coroutine lookup with two suspension points: after prefetching the
+    // bucket (plus its chain head for a base bucket), and after prefetching
+    // the first chain node. An inline base entry is settled at the first
+    // resume without touching the chain; nodes past the first and the old
+    // bucket of a migrating table are read without suspending.
+    template <typename R>
+    LookupTask<R*> async_get_impl(const K& key) const {
+        const size_t hash = hash_of(key);
+        const size_t index = index_for(hash, base_size + heap_size);
+        if (inline_slot(index) && base_chains) prefetch(&base_chains[index]);
+        co_await PrefetchAwaiter{bucket_address(index)};
 
-// Retrieve the value associated with a key (mutable version)
-std::optional<std::reference_wrapper<V>> get(const K& key) {
-    size_t index = std::hash<K>{}(key) % (base_size + heap_size);
+        size_t probes = 0;
+        Entry* found = nullptr;
+        Node* head = nullptr;
+        if (!inline_slot(index)) {
+            head = index < base_size ? base_chain(index) : heap_array[index - base_size];
+        } else if (base_occupied(index)) {
+            ++probes;
+            if (matches(*base_entry(index), key, hash)) {
+                found = base_entry(index);
+            } else {
+                head = base_chain(index);
+            }
+        }
+        if (head) {
+            co_await PrefetchAwaiter{head};
+            found = find_in(head, key, hash, probes);
+        }
+        if (!found) {
+            size_t old = old_index(hash, index);
+            if (old != npos) found = find_in_bucket(old_heap_array, old, key, hash, probes);
+        }
+        table_stats.on_lookup(probes, found != nullptr);
+        co_return found ? &found->value : nullptr;
+    }
 
-    if (index < base_size) {
-        auto* node = base_array[index] ? &base_array[index].value() : nullptr;
-        while (node) {
-            if (node->key == key) {
-                return std::ref(node->value);  // Return mutable reference
+    // Remove key from bucket `index` of the layout whose heap tier is `heap`.
+    template <typename Q>
+    bool erase_in(Node** heap, size_t index, const Q& key, size_t hash) {
+        if constexpr (inline_base) {
+            if (index < base_size) {
+                if (!base_occupied(index)) return false;
+                Entry& entry = *base_entry(index);
+
+                // Special case: the inline entry matches
+                if (matches(entry, key, hash)) {
+                    if (Node* next = base_chain(index)) {
+                        entry = std::move(static_cast<Entry&>(*next));
+                        base_chains[index] = next->next;
+                        delete_node(next);
+                    } else {
+                        destroy_base(index); // Empty the slot if no chaining
+                    }
+                    return true;
+                }
+                if (!base_chains) return false;
             }
-            node = node->next.get();
         }
-    } else {
-        size_t heap_index = index - base_size;
-        auto* node = heap_array[heap_index].get();
-        while (node) {
-            if (node->key == key) {
-                return std::ref(node->value);  // Return mutable reference
+        Node** link_to_curr = &chain_head(heap, index);
+
+        // Search through the linked list
+        while (Node* curr = *link_to_curr) {
+            if (matches(*curr, key, hash)) {
+                *link_to_curr = curr->next; // Remove the node
+                delete_node(curr);
+                return true;
+            }
+            link_to_curr = &curr->next;
+        }
+        return false;
+    }
+
+    // Move every entry of old bucket `index` to its bucket in the current
+    // layout. Entries of a shared base slot that already belong there stay.
+    void migrate_bucket(size_t index) {
+        const size_t capacity = base_size + heap_size;
+        Node* chain = nullptr;
+
+        if constexpr (inline_base) {
+            if (index < base_size) {
+                if (!base_occupied(index)) return;
+                chain = base_chains ? std::exchange(base_chains[index], nullptr) : nullptr;
+                Entry& entry = *base_entry(index);
+                size_t target = index_for(entry_hash(entry), capacity);
+                if (target != index) {
+                    Node* head = new_node(std::move(entry));
+                    destroy_base(index);
+                    link(head, target);
+                }
             }
-            node = node->next.get();
+        }
+        if (!inline_slot(index)) chain = std::exchange(chain_head(old_heap_array, index), nullptr);
+
+        while (chain) {
+            Node* rest = chain->next;
+            link(chain, index_for(entry_hash(*chain), capacity));
+            chain = rest;
         }
     }
 
-    return std::nullopt;  // Key not found
-}
+    // Fewest entries worth a worker thread in the parallel operations.
+    static constexpr size_t min_entries_per_worker = size_t{1} << 14;
 
+    // Counting-sort build of an empty table from n pairs. The capacity is
+    // reserved up front, so nothing grows or migrates. A first pass hashes
+    // every key and counts the entries per bucket, which sizes one block
+    // holding all overflow nodes, each bucket's nodes in a contiguous run.
+    // A second pass places every entry straight into its bucket, skipping
+    // keys already placed.
+    //
+    // With several workers the buckets are split into one contiguous range
+    // (partition) per worker. Workers hash disjoint slices of the input and
+    // scatter each entry's position to its partition, in input order; then
+    // each worker counts and places the entries of its own partition. Node
+    // offsets are prefix sums in bucket order and every bucket sees its
+    // entries in input order, so the result is the same as with one worker.
+    // That needs random access to the input; nothing is allocated while
+    // workers run.
+    //
+    // Besides the bucket array and the node block the build uses scratch
+    // vectors, all allocated before the first pass and freed on return:
+    // each entry's bucket (and hash, with a StoredHash), a counter per
+    // bucket and, with several workers, the entries in partition order.
+    template <typename Iter>
+    void bulk_build(Iter first, size_t n, size_t workers) {
+        reserve_buckets(n);  // the nodes come as one block below
+        finish_migration();
+        const size_t capacity = base_size + heap_size;
+        if constexpr (!std::random_access_iterator<Iter>) workers = 1;
+        workers = std::clamp<size_t>(n / min_entries_per_worker, 1, workers);
+        // Whole 64-bucket words of base_used per partition, so that no two
+        // workers set bits in the same word.
+        const size_t partition_size = ((capacity + workers - 1) / workers + 63) / 64 * 64;
+        auto input_slice = [&](size_t w) { return std::pair(n * w / workers, n * (w + 1) / workers); };
+        auto bucket_range = [&](size_t p) {
+            return std::pair(std::min(capacity, p * partition_size), std::min(capacity, (p + 1) * partition_size));
+        };
 
-// Remove the key-value pair associated with a key
-bool erase(const K& key) {
-    size_t index = std::hash<K>{}(key) % (base_size + heap_size);
+        std::vector<size_t> bucket_of(n);
+        std::vector<size_t> hash_at(StoredHash::enabled ? n : 0);  // kept for the entries
+        std::vector<size_t> cursor(capacity, 0);  // entry counts, then node offsets
+        std::vector<size_t> order(workers > 1 ? n : 0);
+        // slot[w * workers + p]: entries of input slice w in partition p,
+        // then where the next of them goes in `order`.
+        std::vector<size_t> slot(workers * workers, 0);
+        std::vector<size_t> partition_begin(workers + 1, 0);
+        std::vector<size_t> partition_nodes(workers + 1, 0);
+        std::vector<size_t> placed(workers, 0);
 
-    if (index < base_size) {
-        // Search in the base array
-        if (!base_array[index]) return false;
+        // Hash (and with one worker, count) the entries of each slice.
+        run_parallel(workers, [&](size_t w) {
+            auto [lo, hi] = input_slice(w);
+            Iter it = std::next(first, static_cast<std::ptrdiff_t>(lo));
+            for (size_t i = lo; i < hi; ++i, ++it) {
+                const auto& [key, value] = *it;
+                const size_t hash = hash_of(key);
+                bucket_of[i] = index_for(hash, capacity);
+                if constexpr (StoredHash::enabled) hash_at[i] = hash;
+                if (workers == 1) {
+                    ++cursor[bucket_of[i]];
+                } else {
+                    ++slot[w * workers + bucket_of[i] / partition_size];
+                }
+            }
+        });
 
-        // Special case: the head node matches
-        if (base_array[index]->key == key) {
-            if (base_array[index]->next) {
-                base_array[index] = std::move(base_array[index]->next);
+        // Visit the input positions of partition p's entries in input order.
+        auto for_partition = [&](size_t p, auto&& f) {
+            if (workers == 1) {
+                for (size_t i = 0; i < n; ++i) f(i);
             } else {
-                base_array[index].reset(); // Remove the node if no chaining
+                for (size_t k = partition_begin[p]; k < partition_begin[p + 1]; ++k) f(order[k]);
             }
-            --num_entries;
-            return true;
+        };
+
+        if (workers > 1) {
+            size_t pos = 0;
+            for (size_t p = 0; p < workers; ++p) {
+                partition_begin[p] = pos;
+                for (size_t w = 0; w < workers; ++w) {
+                    pos += std::exchange(slot[w * workers + p], pos);
+                }
+            }
+            partition_begin[workers] = pos;
+            run_parallel(workers, [&](size_t w) {
+                auto [lo, hi] = input_slice(w);
+                for (size_t i = lo; i < hi; ++i) {
+                    order[slot[w * workers + bucket_of[i] / partition_size]++] = i;
+                }
+            });
+            run_parallel(workers, [&](size_t p) {
+                for_partition(p, [&](size_t i) { ++cursor[bucket_of[i]]; });
+            });
         }
 
-        // Search through the linked list
-        auto* prev = &base_array[index].value();
-        auto* curr = prev->next.get();
-        while (curr) {
-            if (curr->key == key) {
-                prev->next = std::move(curr->next); // Remove the node
-                --num_entries;
-                return true;
+        // Local node offsets per partition; the first entry of a base
+        // bucket is stored inline.
+        run_parallel(workers, [&](size_t p) {
+            auto [lo, hi] = bucket_range(p);
+            size_t nodes = 0;
+            for (size_t b = lo; b < hi; ++b) {
+                const size_t count = cursor[b];
+                cursor[b] = nodes;
+                nodes += inline_slot(b) && count > 0 ? count - 1 : count;
             }
-            prev = curr;
-            curr = curr->next.get();
+            partition_nodes[p + 1] = nodes;
+        });
+        for (size_t p = 0; p < workers; ++p) partition_nodes[p + 1] += partition_nodes[p];
+
+        const size_t nodes = partition_nodes[workers];
+        if (nodes > 0) {
+            ensure_base_chains();
+            bulk_nodes = NodeTraits::allocate(node_alloc, nodes);
+            bulk_size = nodes;
+            table_stats.on_allocate(nodes * sizeof(Node));
         }
-    } else {
-        // Search in the heap array
-        size_t heap_index = index - base_size;
-        if (!heap_array[heap_index]) return false;
 
-        // Special case: the head node matches
-        if (heap_array[heap_index]->key == key) {
-            heap_array[heap_index] = std::move(heap_array[heap_index]->next);
-            --num_entries;
-            return true;
+        auto place_entry = [&](size_t i, const auto& key, const auto& value, size_t p) {
+            const size_t b = bucket_of[i];
+            const size_t hash = StoredHash::enabled ? hash_at[i] : 0;
+            size_t probes = 0;
+            if (find_in_bucket(heap_array, b, key, hash, probes)) return;  // the first pair wins
+            if (inline_slot(b) && !base_occupied(b)) {
+                remember_hash(*construct_base(b, key, value), hash);
+            } else {
+                Node* node = bulk_nodes + cursor[b]++;
+                NodeTraits::construct(node_alloc, node, key, value);
+                remember_hash(*node, hash);
+                link(node, b);
+            }
+            ++placed[p];
+        };
+
+        try {
+            run_parallel(workers, [&](size_t p) {
+                auto [lo, hi] = bucket_range(p);
+                for (size_t b = lo; b < hi; ++b) cursor[b] += partition_nodes[p];
+                if constexpr (std::random_access_iterator<Iter>) {
+                    for_partition(p, [&](size_t i) {
+                        const auto& [key, value] = first[static_cast<std::ptrdiff_t>(i)];
+                        place_entry(i, key, value, p);
+                    });
+                } else {
+                    Iter it = first;
+                    for (size_t i = 0; i < n; ++i, ++it) {
+                        const auto& [key, value] = *it;
+                        place_entry(i, key, value, p);
+                    }
+                }
+            });
+        } catch (...) {
+            for (size_t count : placed) num_entries += count;
+            throw;
         }
+        for (size_t count : placed) num_entries += count;
+    }
 
-        // Search through the linked list
-        auto* prev = heap_array[heap_index].get();
-        auto* curr = prev->next.get();
-        while (curr) {
-            if (curr->key == key) {
-                prev->next = std::move(curr->next); // Remove the node
-                --num_entries;
-                return true;
+    // Move every entry into a new layout of new_capacity buckets at once.
+    // Base entries leaving their slot are first moved into nodes, which is
+    // the only allocation. Workers then detach disjoint ranges of old
+    // buckets, sorting their nodes into one list per destination partition
+    // (a contiguous range of new heap buckets, plus one for the base tier)
+    // through the nodes' own next pointers, and finally each worker links
+    // the lists of its partition. Nodes bound for the base tier are linked
+    // on the calling thread, since filling an empty base slot frees a node.
+    void rehash_parallel(size_t new_capacity, size_t workers) {
+        if constexpr (direct) return;  // already one bucket per key
+        finish_migration();
+        ensure_base_chains();
+        const size_t old_capacity = base_size + heap_size;
+        const size_t new_heap_size = new_capacity - base_size;
+        Node** new_heap_array = allocate_buckets(new_heap_size);
+        workers = std::clamp<size_t>(num_entries / min_entries_per_worker, 1, workers);
+
+        Node* evicted = nullptr;
+        try {
+            if constexpr (inline_base) {
+                for (size_t b = 0; b < base_size; ++b) {
+                    while (base_occupied(b) && index_for(entry_hash(*base_entry(b)), new_capacity) != b) {
+                        Node* node = new_node(std::move(*base_entry(b)));
+                        destroy_base(b);
+                        node->next = std::exchange(evicted, node);
+                        // Refill the slot from its chain, which must not hang
+                        // off an empty slot.
+                        if (Node* next = base_chain(b)) {
+                            construct_base(b, std::move(static_cast<Entry&>(*next)));
+                            base_chains[b] = next->next;
+                            delete_node(next);
+                        }
+                    }
+                }
             }
-            prev = curr;
-            curr = curr->next.get();
+        } catch (...) {
+            while (evicted) {
+                Node* node = std::exchange(evicted, evicted->next);
+                link(node, index_for(entry_hash(*node), old_capacity));
+            }
+            free_buckets(new_heap_array, new_heap_size);
+            throw;
         }
+
+        Node** old_heap = std::exchange(heap_array, new_heap_array);
+        const size_t old_size = std::exchange(heap_size, new_heap_size);
+        const size_t partition_size = (new_heap_size + workers - 1) / workers;
+        auto partition_of = [&](size_t index) {
+            return index < base_size ? workers : (index - base_size) / partition_size;
+        };
+
+        // lists[w * (workers + 1) + p]: nodes detached by worker w for partition p
+        std::vector<Node*> lists(workers * (workers + 1), nullptr);
+        run_parallel(workers, [&](size_t w) {
+            Node** mine = &lists[w * (workers + 1)];
+            for (size_t b = old_capacity * w / workers; b < old_capacity * (w + 1) / workers; ++b) {
+                Node* chain = std::exchange(chain_head(old_heap, b), nullptr);
+                while (chain) {
+                    Node* node = std::exchange(chain, chain->next);
+                    Node*& list = mine[partition_of(index_for(entry_hash(*node), new_capacity))];
+                    node->next = std::exchange(list, node);
+                }
+            }
+        });
+        free_buckets(old_heap, old_size);
+
+        run_parallel(workers, [&](size_t p) {
+            for (size_t w = 0; w < workers; ++w) {
+                Node* list = lists[w * (workers + 1) + p];
+                while (list) {
+                    Node* node = std::exchange(list, list->next);
+                    Node*& head = heap_array[index_for(entry_hash(*node), new_capacity) - base_size];
+                    node->next = std::exchange(head, node);
+                }
+            }
+        });
+
+        auto link_all = [&](Node* list) {
+            while (list) {
+                Node* node = std::exchange(list, list->next);
+                link(node, index_for(entry_hash(*node), new_capacity));
+            }
+        };
+        for (size_t w = 0; w < workers; ++w) link_all(lists[w * (workers + 1) + workers]);
+        link_all(evicted);
     }
 
-    return false; // Key not found
-}
+    // The bucket half of reserve(n).
+    void reserve_buckets(size_t n) {
+        size_t capacity = base_size + heap_size;
+        if (n <= 0.7 * capacity) return;
+        while (n > 0.7 * capacity) capacity = Capacity::grow(capacity);
+        timed_grow([&] { grow_to(capacity); });
+    }
 
-// Special constructor function for creating a constexpr table from pairs
-static constexpr HashTable from_nice_pairs(std::initializer_list<std::pair<K, V>> pairs) {
-    HashTable table;
+    size_t free_base_slots() const {
+        if constexpr (inline_base) {
+            size_t used = 0;
+            for (uint64_t word : base_used) used += static_cast<size_t>(std::popcount(word));
+            return base_size - used;
+        } else {
+            return 0;
+        }
+    }
 
-    for (const auto& [key, value] : pairs) {
-        size_t index = std::hash<K>{}(key) % base_size;
+    template <typename F>
+    void timed_grow(F&& grow_step) {
+        if constexpr (Stats::enabled) {
+            const auto start = std::chrono::steady_clock::now();
+            grow_step();
+            table_stats.on_grow(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start));
+        } else {
+            grow_step();
+        }
+    }
 
-        if (!table.base_array[index]) {
-            table.base_array[index].emplace(key, value);
-            ++table.num_entries;
+    // Smallest capacity of the Capacity schedule, starting from base_size,
+    // that holds n entries below the 0.7 load factor.
+    static size_t capacity_for(size_t n) {
+        size_t capacity = base_size;
+        if constexpr (direct) return capacity;
+        while (n > 0.7 * capacity) capacity = Capacity::grow(capacity);
+        return capacity;
+    }
+
+    // Start migrating to a layout of new_capacity buckets, larger or
+    // smaller than the current one (but at least base_size).
+    void grow_to(size_t new_capacity) {
+        if constexpr (direct) return;
+        finish_migration();
+        // Migration relinks into base buckets and must not fail halfway.
+        ensure_base_chains();
+
+        size_t new_heap_size = new_capacity - base_size;
+        Node** new_heap_array = new_heap_size ? allocate_buckets(new_heap_size) : nullptr;
+
+        old_heap_array = std::exchange(heap_array, new_heap_array);
+        old_heap_size = std::exchange(heap_size, new_heap_size);
+        migrate_pos = 0;
+        migrating = true;
+    }
+
+    // Shrink once the load factor falls below an eighth of the grow
+    // threshold, to the capacity that fits twice the remaining entries. The
+    // table then has to lose half (or double) its entries again before the
+    // next resize, so bursts of inserts followed by mass erases do not
+    // resize back and forth, and draining a table moves each entry about
+    // once in total. Like growth, the shrink migrates incrementally
+    // (finishing an earlier migration first).
+    void shrink_if_sparse() {
+        const size_t capacity = base_size + heap_size;
+        if (heap_size == 0 || num_entries >= 0.0875 * capacity) return;
+        const size_t target = capacity_for(2 * num_entries);
+        if (target < capacity) timed_grow([&] { grow_to(target); });
+    }
+
+    void migrate_step(size_t buckets) {
+        if (!migrating) return;
+        const size_t old_capacity = base_size + old_heap_size;
+        const size_t end = migrate_pos + std::min(buckets, old_capacity - migrate_pos);
+        while (migrate_pos < end) {
+            migrate_bucket(migrate_pos++);
+        }
+        if (migrate_pos == old_capacity) {
+            free_buckets(old_heap_array, old_heap_size);
+            old_heap_array = nullptr;
+            old_heap_size = 0;
+            migrating = false;
+        }
+    }
+
+    // Iteration walks one index space of buckets: the base tier, the heap
+    // tier, and during a migration the old heap buckets not moved yet (old
+    // base buckets are the same physical slots as the new ones).
+    size_t iteration_buckets() const { return base_size + heap_size + old_heap_size; }
+
+    // First entry of iteration bucket b, or null; `rest` gets the chain
+    // after it.
+    Entry* bucket_first(size_t b, Node*& rest) const {
+        if (inline_slot(b)) {
+            if (!base_occupied(b)) return nullptr;
+            rest = base_chain(b);
+            return base_entry(b);
+        }
+        Node* head;
+        if (b < base_size) {
+            head = base_chain(b);
+        } else if (b < base_size + heap_size) {
+            head = heap_array[b - base_size];
         } else {
-            // If collision occurs, throw an exception
-            throw std::runtime_error("Collision detected during constexpr construction.");
+            const size_t old = b - heap_size;  // index in the old layout
+            if (!migrating || old < migrate_pos) return nullptr;
+            head = old_heap_array[old - base_size];
+        }
+        if (head) rest = head->next;
+        return head;
+    }
+
+    // Call f(entry) for every entry of iteration buckets [lo, hi), in
+    // memory order: each base slot and its chain, then each heap chain.
+    template <typename F>
+    void visit_buckets(size_t lo, size_t hi, F& f) const {
+        for (size_t b = lo; b < hi; ++b) {
+            Node* rest = nullptr;
+            Entry* entry = bucket_first(b, rest);
+            if (!entry) continue;
+            if (rest) prefetch(rest);
+            f(*entry);
+            for (; rest; rest = rest->next) {
+                if (rest->next) prefetch(rest->next);
+                f(*static_cast<Entry*>(rest));
+            }
+        }
+    }
+
+    template <typename F>
+    void visit_parallel(size_t threads, F& f) const {
+        const size_t buckets = iteration_buckets();
+        const size_t workers = std::clamp<size_t>(num_entries / min_entries_per_worker, 1,
+                                                  resolve_workers(threads));
+        run_parallel(workers, [&](size_t w) {
+            visit_buckets(buckets * w / workers, buckets * (w + 1) / workers, f);
+        });
+    }
+
+public:
+    // Forward iterator over the entries, in the same memory order as
+    // for_each. It dereferences to the table's HashEntry, so
+    // `for (const auto& [key, value] : table)` works; entries are read-only
+    // through it (change values with get() or for_each). Any insertion or
+    // erase invalidates every iterator.
+    class const_iterator {
+        friend class HashTable;
+
+        const HashTable* table = nullptr;
+        size_t bucket = 0;
+        const Entry* entry = nullptr;   // null at the end
+        Node* rest = nullptr;           // rest of entry's chain
+
+        const_iterator(const HashTable* t, size_t b) : table(t), bucket(b) { settle(); }
+
+        // Move to the first entry of `bucket` or a later bucket.
+        void settle() {
+            for (const size_t buckets = table->iteration_buckets(); bucket < buckets; ++bucket) {
+                rest = nullptr;
+                if ((entry = table->bucket_first(bucket, rest))) return;
+            }
+            entry = nullptr;
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Entry;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Entry*;
+        using reference = const Entry&;
+
+        const_iterator() = default;
+
+        reference operator*() const { return *entry; }
+        pointer operator->() const { return entry; }
+
+        const_iterator& operator++() {
+            if (rest) {
+                entry = std::exchange(rest, rest->next);
+            } else {
+                ++bucket;
+                settle();
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const const_iterator& other) const { return entry == other.entry; }
+    };
+
+    using iterator = const_iterator;
+
+    // Constructor
+    HashTable() {}
+
+    explicit HashTable(const Allocator& alloc) : node_alloc(alloc) {}
+
+    explicit HashTable(const Hash& hash, const KeyEqual& equal = KeyEqual(),
+                       const Allocator& alloc = Allocator())
+        : hasher(hash), key_eq(equal), node_alloc(alloc) {}
+
+    ~HashTable() { destroy(); }
+
+    // Move constructor
+    HashTable(HashTable&& other) noexcept
+        : hasher(std::move(other.hasher)),
+          key_eq(std::move(other.key_eq)),
+          node_alloc(std::move(other.node_alloc)),
+          bucket_alloc(std::move(other.bucket_alloc)),
+          table_stats(other.table_stats),
+          heap_array(std::exchange(other.heap_array, nullptr)),
+          heap_size(std::exchange(other.heap_size, 0)),
+          num_entries(std::exchange(other.num_entries, 0)),
+          old_heap_array(std::exchange(other.old_heap_array, nullptr)),
+          old_heap_size(std::exchange(other.old_heap_size, 0)),
+          migrate_pos(std::exchange(other.migrate_pos, 0)),
+          migrating(std::exchange(other.migrating, false)),
+          bulk_nodes(std::exchange(other.bulk_nodes, nullptr)),
+          bulk_size(std::exchange(other.bulk_size, 0)) {
+        take_base(other);
+        other.table_stats.on_clear();
+    }
+
+    // Move assignment operator
+    HashTable& operator=(HashTable&& other) noexcept {
+        if (this != &other) {
+            destroy();
+            take_base(other);
+            hasher = std::move(other.hasher);
+            key_eq = std::move(other.key_eq);
+            if constexpr (NodeTraits::propagate_on_container_move_assignment::value) {
+                node_alloc = std::move(other.node_alloc);
+                bucket_alloc = std::move(other.bucket_alloc);
+            }
+            heap_array = std::exchange(other.heap_array, nullptr);
+            heap_size = std::exchange(other.heap_size, 0);
+            num_entries = std::exchange(other.num_entries, 0);
+            old_heap_array = std::exchange(other.old_heap_array, nullptr);
+            old_heap_size = std::exchange(other.old_heap_size, 0);
+            migrate_pos = std::exchange(other.migrate_pos, 0);
+            migrating = std::exchange(other.migrating, false);
+            bulk_nodes = std::exchange(other.bulk_nodes, nullptr);
+            bulk_size = std::exchange(other.bulk_size, 0);
+            table_stats = other.table_stats;
+            other.table_stats.on_clear();
+        }
+        return *this;
+    }
+
+    HashTable(const HashTable&) = delete;
+    HashTable& operator=(const HashTable&) = delete;
+
+    size_t size() const { return num_entries; }
+
+    // Snapshot of the Stats policy's counters plus size and load factor;
+    // only the latter are filled in with NoTableStats. Histograms and hit
+    // counts cover get/contains and insert/try_emplace/emplace (get_batch
+    // is not instrumented).
+    TableStatsSnapshot stats() const {
+        TableStatsSnapshot snapshot;
+        table_stats.fill(snapshot);
+        snapshot.size = num_entries;
+        snapshot.bucket_count = base_size + heap_size;
+        snapshot.load_factor = static_cast<double>(num_entries) / static_cast<double>(snapshot.bucket_count);
+        return snapshot;
+    }
+    size_t bucket_count() const { return base_size + heap_size; }
+    static constexpr TableLayout table_layout() { return layout; }
+    bool is_migrating() const { return migrating; }
+
+    // Grow the heap tier to the next Capacity step and start migrating
+    // entries into the new layout.
+    // A migration still in progress is completed first.
+    void grow() {
+        timed_grow([&] { grow_to(Capacity::grow(base_size + heap_size)); });
+    }
+
+    // Make room for n entries without further growth: jumps straight to the
+    // first Capacity step that holds n entries below the 0.7 load factor,
+    // with a single allocation and (incremental) migration. An Allocator
+    // with reserve(count) (SlabAllocator) also sets aside nodes for the
+    // entries still to come, already faulted in, so inserting them neither
+    // allocates nor page-faults. Those are n - size() less the free base
+    // slots, which hold entries without a node.
+    void reserve(size_t n) {
+        if constexpr (requires { node_alloc.reserve(n); }) {
+            const size_t without_node = num_entries + free_base_slots();
+            if (n > without_node) node_alloc.reserve(n - without_node);
+        }
+        reserve_buckets(n);
+    }
+
+    // Grow to the next Capacity step and rehash every entry right away,
+    // split over `threads` workers (0: one per hardware thread); nothing is
+    // left to migrate afterwards. See rehash_parallel.
+    void grow_parallel(size_t threads = 0) {
+        timed_grow([&] {
+            rehash_parallel(Capacity::grow(base_size + heap_size), resolve_workers(threads));
+        });
+    }
+
+    // Resize to the first Capacity step with at least n buckets that also
+    // holds size() entries below the 0.7 load factor, never below
+    // base_size, and start migrating; rehash(0) shrinks to fit. Erase
+    // already shrinks a sparse table on its own (see shrink_if_sparse).
+    void rehash(size_t n) {
+        size_t capacity = capacity_for(num_entries);
+        while (capacity < n) capacity = Capacity::grow(capacity);
+        if (capacity != base_size + heap_size) timed_grow([&] { grow_to(capacity); });
+    }
+
+    void shrink_to_fit() { rehash(0); }
+
+    // Complete any in-flight migration synchronously.
+    void finish_migration() {
+        migrate_step(static_cast<size_t>(-1));
+    }
+
+    // Insert a key-value pair if the key is absent. Like the other inserting
+    // members it returns the entry's value and whether it was inserted; an
+    // existing key keeps its value. The reference stays valid until the
+    // next insertion or erase.
+    std::pair<V&, bool> insert(const K& key, const V& value) {
+        return try_emplace_impl(key, value);
+    }
+
+    std::pair<V&, bool> insert(K&& key, V&& value) {
+        return try_emplace_impl(std::move(key), std::move(value));
+    }
+
+    // Construct the value in place from args if key is absent. Nothing is
+    // constructed (or moved from) when the key already exists.
+    template <typename... Args>
+    std::pair<V&, bool> try_emplace(const K& key, Args&&... args) {
+        return try_emplace_impl(key, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    std::pair<V&, bool> try_emplace(K&& key, Args&&... args) {
+        return try_emplace_impl(std::move(key), std::forward<Args>(args)...);
+    }
+
+    // Insert, or assign to the existing value.
+    template <typename M>
+    std::pair<V&, bool> insert_or_assign(const K& key, M&& obj) {
+        auto result = try_emplace_impl(key, std::forward<M>(obj));
+        if (!result.second) result.first = std::forward<M>(obj);
+        return result;
+    }
+
+    template <typename M>
+    std::pair<V&, bool> insert_or_assign(K&& key, M&& obj) {
+        auto result = try_emplace_impl(std::move(key), std::forward<M>(obj));
+        if (!result.second) result.first = std::forward<M>(obj);
+        return result;
+    }
+
+    // Construct an entry from args as for HashNode(args...), i.e. (key,
+    // value) or (std::piecewise_construct, key_args, value_args). The node is
+    // built before the lookup, so prefer try_emplace when the key is at hand.
+    template <typename... Args>
+    std::pair<V&, bool> emplace(Args&&... args) {
+        migrate_step(migrate_batch);
+
+        Node* node = new_node(std::forward<Args>(args)...);
+        size_t hash = hash_of(node->key);
+        remember_hash(*node, hash);
+        size_t index = index_for(hash, base_size + heap_size);
+        size_t probes = 0;
+        Entry* existing = find_node(node->key, hash, index, probes);
+        table_stats.on_insert(probes);
+        if (existing) {
+            delete_node(node);
+            return {existing->value, false};
+        }
+
+        index = reserve_one(hash, index);
+        ++num_entries;
+        return {link(node, index)->value, true};
+    }
+
+    // Retrieve the value associated with a key (const version)
+    std::optional<std::reference_wrapper<const V>> get(const K& key) const {
+        return get_impl<const V>(key, hash_of(key));
+    }
+
+    // Retrieve the value associated with a key (mutable version)
+    std::optional<std::reference_wrapper<V>> get(const K& key) {
+        return get_impl<V>(key, hash_of(key));
+    }
+
+    // Heterogeneous lookup with transparent Hash and KeyEqual
+    template <typename Q> requires lookup_with<Q>
+    std::optional<std::reference_wrapper<const V>> get(const Q& key) const {
+        return get_impl<const V>(key, hash_of(key));
+    }
+
+    template <typename Q> requires lookup_with<Q>
+    std::optional<std::reference_wrapper<V>> get(const Q& key) {
+        return get_impl<V>(key, hash_of(key));
+    }
+
+    bool contains(const K& key) const { return lookup(key, hash_of(key)) != nullptr; }
+
+    template <typename Q> requires lookup_with<Q>
+    bool contains(const Q& key) const { return lookup(key, hash_of(key)) != nullptr; }
+
+    // Remove the key-value pair associated with a key
+    bool erase(const K& key) { return erase_impl(key, hash_of(key)); }
+
+    template <typename Q> requires lookup_with<Q>
+    bool erase(const Q& key) { return erase_impl(key, hash_of(key)); }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    // Call f(key, value) for every entry, streaming through the base tier
+    // and then the heap tier; values are mutable through the non-const
+    // overload. f must not insert or erase.
+    template <typename F>
+    void for_each(F&& f) {
+        auto visit = [&](Entry& entry) { f(std::as_const(entry.key), entry.value); };
+        visit_buckets(0, iteration_buckets(), visit);
+    }
+
+    template <typename F>
+    void for_each(F&& f) const {
+        auto visit = [&](const Entry& entry) { f(entry.key, entry.value); };
+        visit_buckets(0, iteration_buckets(), visit);
+    }
+
+    // for_each with the buckets split into contiguous ranges over `threads`
+    // workers (0: one per hardware thread; small tables use fewer). f is
+    // called concurrently, each entry exactly once, so it must be safe to
+    // call from several threads; per-worker results can be kept in
+    // thread-local or atomic accumulators. Nothing is copied or allocated.
+    template <typename F>
+    void for_each_parallel(F&& f, size_t threads = 0) {
+        auto visit = [&](Entry& entry) { f(std::as_const(entry.key), entry.value); };
+        visit_parallel(threads, visit);
+    }
+
+    template <typename F>
+    void for_each_parallel(F&& f, size_t threads = 0) const {
+        auto visit = [&](const Entry& entry) { f(entry.key, entry.value); };
+        visit_parallel(threads, visit);
+    }
+
+    // Look up many keys at once: out[i] points to the value of keys[i], or
+    // is nullptr if it is absent. Memory latency of independent keys is
+    // overlapped (see get_batch_impl), which pays off once the table no
+    // longer fits in cache. Pointers stay valid until the next insertion
+    // or erase.
+    void get_batch(std::span<const K> keys, std::span<const V*> out) const {
+        get_batch_impl<const V>(keys, out);
+    }
+
+    void get_batch(std::span<const K> keys, std::span<V*> out) {
+        get_batch_impl<V>(keys, out);
+    }
+
+    // Coroutine form of get() for interleaving many lookups on one thread:
+    // the task prefetches what it reads next and suspends rather than
+    // waiting for it, and the result is the value's address or nullptr.
+    // Drive tasks with run_round_robin (lookup_task.hpp) or any scheduler
+    // that resumes them until done(). `key` is referenced, not copied (hence
+    // no temporaries), and the table must not change while tasks are in
+    // flight.
+    LookupTask<const V*> async_get(const K& key) const { return async_get_impl<const V>(key); }
+
+    LookupTask<V*> async_get(const K& key) { return async_get_impl<V>(key); }
+
+    LookupTask<const V*> async_get(K&& key) const = delete;
+    LookupTask<V*> async_get(K&& key) = delete;
+
+    // Insert keys[i] -> values[i] for every key that is absent, in order;
+    // returns how many were inserted. Keys are hashed and their buckets
+    // prefetched a few positions ahead of the insert.
+    size_t insert_batch(std::span<const K> keys, std::span<const V> values) {
+        if (keys.size() != values.size()) {
+            throw std::invalid_argument("insert_batch needs one value per key.");
+        }
+        const size_t n = keys.size();
+        size_t hashes[batch_ring];
+        size_t inserted = 0;
+
+        // Hash and prefetch `distance` keys ahead. An insert that grows the
+        // table only makes the prefetches in flight useless, since
+        // try_emplace_hashed recomputes the index.
+        auto hash_stage = [&](size_t i) {
+            const size_t slot = i & (batch_ring - 1);
+            hashes[slot] = hash_of(keys[i]);
+            prefetch(bucket_address(index_for(hashes[slot], base_size + heap_size)));
+        };
+        for (size_t i = 0; i < std::min(n, batch_distance); ++i) hash_stage(i);
+
+        for (size_t i = 0; i < n; ++i) {
+            if (i + batch_distance < n) hash_stage(i + batch_distance);
+            inserted += try_emplace_hashed(hashes[i & (batch_ring - 1)], keys[i], values[i]).second;
         }
+        return inserted;
     }
 
-    return table;
-}
+    // Special constructor function for creating a table from collision-free pairs.
+    // HashTable owns heap memory and hashes with std::hash, so this runs at
+    // runtime; use StaticHashTable (static_hash_table.hpp) for a constinit table.
+    static HashTable from_nice_pairs(std::initializer_list<std::pair<K, V>> pairs,
+                                     const Allocator& alloc = Allocator()) {
+        HashTable table(alloc);
 
-// Construct a hash table with collision handling
-    static HashTable from_pairs(std::initializer_list<std::pair<K, V>> pairs) {
-        HashTable table;
         for (const auto& [key, value] : pairs) {
-            table.insert(key, value);
+            size_t hash = table.hash_of(key);
+            size_t index = index_for(hash, base_size);
+
+            if (inline_base ? !table.base_occupied(index) : !table.base_chain(index)) {
+                table.place(index, hash, key, value);
+                ++table.num_entries;
+            } else {
+                // If collision occurs, throw an exception
+                throw std::runtime_error("Collision detected during constexpr construction.");
+            }
         }
+
         return table;
     }
 
+    // Build a table from a range of pairs (anything whose elements bind to
+    // `const auto& [key, value]`); for a repeated key the first pair wins,
+    // as with from_pairs. Forward ranges are built by bulk_build: the final
+    // capacity and one block of every overflow node are allocated up front
+    // (plus the build's scratch vectors), without any growth. Single-pass
+    // ranges are inserted one by one.
+    template <typename Iter>
+    static HashTable from_range(Iter first, Iter last, const Allocator& alloc = Allocator()) {
+        HashTable table(alloc);
+        if constexpr (std::forward_iterator<Iter>) {
+            table.bulk_build(first, static_cast<size_t>(std::distance(first, last)), 1);
+        } else {
+            for (; first != last; ++first) {
+                const auto& [key, value] = *first;
+                table.insert(key, value);
+            }
+        }
+        return table;
+    }
+
+    // from_range split over `threads` workers (0: one per hardware thread),
+    // with the same result as from_range. Hash, KeyEqual and the copy
+    // constructors of K and V are called concurrently; the allocator is
+    // not. Small inputs use fewer workers.
+    template <std::random_access_iterator Iter>
+    static HashTable from_range_parallel(Iter first, Iter last, size_t threads = 0,
+                                         const Allocator& alloc = Allocator()) {
+        HashTable table(alloc);
+        table.bulk_build(first, static_cast<size_t>(last - first), resolve_workers(threads));
+        return table;
+    }
+
+    // Construct a hash table with collision handling
+    static HashTable from_pairs(std::initializer_list<std::pair<K, V>> pairs,
+                                const Allocator& alloc = Allocator()) {
+        return from_range(pairs.begin(), pairs.end(), alloc);
+    }
 };
 
 
@@ -0,0 +1,896 @@
+// Benchmarks HashTable and OpenHashTable against std::unordered_map and,
+// when available, absl::flat_hash_map and ankerl::unordered_dense::map.
+//
+// Every benchmark is named op/table/key/size[/load], e.g.
+// "lookup_hit/HashTable/short_string/65536/50". Results go to stdout as JSON
+// unless another --benchmark_format is given, and the `bench` build target
+// also writes them to hash_table_bench.json.
+
+#include "concurrent_hash_table.hpp"
+#include "hash_table.hpp"
+#include "lookup_task.hpp"
+#include "numa_hash_table.hpp"
+#include "open_hash_table.hpp"
+#include "overlay_hash_table.hpp"
+#include "sharded_hash_table.hpp"
+#include "static_lookup.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(HASH_TABLE_BENCH_ABSL)
+#include <absl/container/flat_hash_map.h>
+#endif
+#if defined(HASH_TABLE_BENCH_ANKERL)
+#include <ankerl/unordered_dense.h>
+#endif
+
+
+namespace {
+
+using Value = uint64_t;
+
+// 16-byte trivially copyable key, hashed the same way by every table.
+struct Key16 {
+    uint64_t lo, hi;
+    bool operator==(const Key16&) const = default;
+};
+
+struct Key16Hash {
+    size_t operator()(const Key16& key) const {
+        return static_cast<size_t>(hash_policy::wyhash(key.lo, key.hi));
+    }
+};
+
+// Bijections on 32/64-bit integers, so distinct indices give distinct keys
+// in an order unrelated to insertion.
+uint32_t scramble32(uint64_t i) {
+    uint32_t x = static_cast<uint32_t>(i);
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+uint64_t scramble(uint64_t i) {
+    i ^= i >> 31;
+    i *= 0x7fb5d329728ea185ull;
+    i ^= i >> 27;
+    return i;
+}
+
+// Key families. Index 2i is a key that gets inserted, 2i + 1 one that never
+// does, so miss lookups probe keys that share the hits' distribution.
+struct IntKeys {
+    using Key = int;
+    static constexpr const char* name = "int";
+    static Key make(uint64_t i) { return static_cast<int>(scramble32(i)); }
+};
+
+struct Key16Keys {
+    using Key = Key16;
+    static constexpr const char* name = "key16";
+    static Key make(uint64_t i) { return {scramble(i), ~i}; }
+};
+
+struct ShortStringKeys {
+    using Key = std::string;
+    static constexpr const char* name = "short_string";
+    static Key make(uint64_t i) { return std::to_string(scramble32(i)); }  // fits SSO
+};
+
+struct LongStringKeys {
+    using Key = std::string;
+    static constexpr const char* name = "long_string";
+    static Key make(uint64_t i) {
+        return "a/rather/long/key/prefix/well/past/small/string/size/" + std::to_string(scramble(i));
+    }
+};
+
+template <typename Keys>
+using KeyHash = std::conditional_t<std::is_same_v<typename Keys::Key, Key16>, Key16Hash,
+                                   hash_policy::DefaultHash<typename Keys::Key>>;
+
+template <typename Keys>
+using StdHash = std::conditional_t<std::is_same_v<typename Keys::Key, Key16>, Key16Hash,
+                                   std::hash<typename Keys::Key>>;
+
+
+// Table adapters: a name, a map type per key family, and the
+// insert/find/erase/reserve operations the benchmarks need.
+struct ChainedTable {
+    static constexpr const char* name = "HashTable";
+    template <typename Keys>
+    using Map = HashTable<typename Keys::Key, Value, 64, KeyHash<Keys>>;
+};
+
+// The built-in hashers, compared against the default one (std::hash) on raw
+// hashing throughput and on HashTable lookups.
+struct DefaultHasher {
+    static constexpr const char* name = "default";
+    template <typename Keys>
+    using type = KeyHash<Keys>;
+};
+
+struct WyHasher {
+    static constexpr const char* name = "wyhash";
+    template <typename Keys>
+    using type = hash_policy::WyHash;
+};
+
+struct Xxh3Hasher {
+    static constexpr const char* name = "xxh3";
+    template <typename Keys>
+    using type = hash_policy::Xxh3Hash;
+};
+
+struct Crc32cHasher {
+    static constexpr const char* name = "crc32c";
+    template <typename Keys>
+    using type = hash_policy::Crc32cHash;
+};
+
+template <typename Hasher>
+struct HasherTable {
+    template <typename Keys>
+    using Map = HashTable<typename Keys::Key, Value, 64, typename Hasher::template type<Keys>>;
+};
+
+// HashTable keeping each entry's hash (or a fingerprint of it), for the
+// string keys where compares and rehashing are expensive.
+template <typename StoredHash>
+struct StoredHashTable {
+    static constexpr const char* name = std::is_same_v<StoredHash, hash_policy::StoreHash>
+        ? "HashTable+stored_hash" : "HashTable+fingerprint";
+    template <typename Keys>
+    using Map = HashTable<typename Keys::Key, Value, 64, KeyHash<Keys>, hash_policy::DefaultKeyEqual<typename Keys::Key>,
+                          PowerOfTwoCapacity, std::allocator<std::pair<const typename Keys::Key, Value>>,
+                          NoTableStats, StoredHash>;
+};
+
+struct OpenTable {
+    static constexpr const char* name = "OpenHashTable";
+    template <typename Keys>
+    using Map = OpenHashTable<typename Keys::Key, Value, 64, KeyHash<Keys>>;
+};
+
+struct StdTable {
+    static constexpr const char* name = "std::unordered_map";
+    template <typename Keys>
+    using Map = std::unordered_map<typename Keys::Key, Value, StdHash<Keys>>;
+};
+
+#if defined(HASH_TABLE_BENCH_ABSL)
+struct AbslTable {
+    static constexpr const char* name = "absl::flat_hash_map";
+    template <typename Keys>
+    using Map = std::conditional_t<std::is_same_v<typename Keys::Key, Key16>,
+                                   absl::flat_hash_map<Key16, Value, Key16Hash>,
+                                   absl::flat_hash_map<typename Keys::Key, Value>>;
+};
+#endif
+
+#if defined(HASH_TABLE_BENCH_ANKERL)
+struct AnkerlTable {
+    static constexpr const char* name = "ankerl::unordered_dense";
+    template <typename Keys>
+    using Map = std::conditional_t<std::is_same_v<typename Keys::Key, Key16>,
+                                   ankerl::unordered_dense::map<Key16, Value, Key16Hash>,
+                                   ankerl::unordered_dense::map<typename Keys::Key, Value>>;
+};
+#endif
+
+template <typename Map, typename K>
+void insert(Map& map, const K& key, Value value) {
+    if constexpr (requires { map.get(key); }) {
+        map.insert(key, value);
+    } else {
+        map.emplace(key, value);
+    }
+}
+
+template <typename Map, typename K>
+const Value* find(const Map& map, const K& key) {
+    if constexpr (requires { map.get(key); }) {
+        auto found = map.get(key);
+        return found ? &found->get() : nullptr;
+    } else {
+        auto it = map.find(key);
+        return it != map.end() ? &it->second : nullptr;
+    }
+}
+
+template <typename Map, typename K>
+void erase(Map& map, const K& key) {
+    map.erase(key);
+}
+
+template <typename Map>
+size_t bucket_count(const Map& map) {
+    if constexpr (requires { map.capacity(); }) {
+        return map.capacity();
+    } else {
+        return map.bucket_count();
+    }
+}
+
+// Size the table for n entries at roughly the given load factor (percent);
+// 0 leaves it to the table's own growth policy. Tables without a way to
+// presize keep their default. The load actually reached is reported as the
+// load_factor counter.
+template <typename Map>
+void presize(Map& map, size_t n, int load) {
+    if (load == 0) return;
+    const size_t buckets = n * 100 / static_cast<size_t>(load);
+    if constexpr (requires { map.grow(); }) {
+        while (map.bucket_count() < buckets) {
+            map.grow();
+            map.finish_migration();
+        }
+    } else if constexpr (requires { map.rehash(buckets); }) {
+        map.rehash(buckets);
+    }
+}
+
+template <typename Keys>
+std::vector<typename Keys::Key> make_keys(size_t n, uint64_t parity) {
+    std::vector<typename Keys::Key> keys;
+    keys.reserve(n);
+    for (size_t i = 0; i < n; ++i) keys.push_back(Keys::make(2 * i + parity));
+    return keys;
+}
+
+template <typename Map>
+void report(benchmark::State& state, const Map& map, size_t ops_per_iteration) {
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * ops_per_iteration));
+    state.counters["load_factor"] =
+        static_cast<double>(map.size()) / static_cast<double>(bucket_count(map));
+}
+
+
+// Insert n keys into a presized table.
+template <typename Table, typename Keys>
+void BM_Insert(benchmark::State& state) {
+    using Map = typename Table::template Map<Keys>;
+    const size_t n = static_cast<size_t>(state.range(0));
+    const auto keys = make_keys<Keys>(n, 0);
+    std::unique_ptr<Map> map;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        map = std::make_unique<Map>();
+        presize(*map, n, static_cast<int>(state.range(1)));
+        state.ResumeTiming();
+
+        for (size_t i = 0; i < n; ++i) insert(*map, keys[i], i);
+        benchmark::ClobberMemory();
+
+        state.PauseTiming();
+        map.reset();
+        state.ResumeTiming();
+    }
+    map = std::make_unique<Map>();
+    presize(*map, n, static_cast<int>(state.range(1)));
+    for (size_t i = 0; i < n; ++i) insert(*map, keys[i], i);
+    report(state, *map, n);
+}
+
+// Build a table of n keys from empty, timing construction, every growth
+// step and destruction.
+template <typename Table, typename Keys>
+void BM_Growth(benchmark::State& state) {
+    using Map = typename Table::template Map<Keys>;
+    const size_t n = static_cast<size_t>(state.range(0));
+    const auto keys = make_keys<Keys>(n, 0);
+    size_t size = 0, buckets = 0;
+
+    for (auto _ : state) {
+        auto map = std::make_unique<Map>();
+        for (size_t i = 0; i < n; ++i) insert(*map, keys[i], i);
+        size = map->size();
+        buckets = bucket_count(*map);
+        benchmark::DoNotOptimize(map.get());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+    state.counters["load_factor"] = static_cast<double>(size) / static_cast<double>(buckets);
+}
+
+// Build a table from n pairs in one call: from_range where the table has
+// it, otherwise reserve (if available) and insert. Includes destruction,
+// like BM_Growth.
+template <typename Table, typename Keys>
+void BM_Build(benchmark::State& state) {
+    using Map = typename Table::template Map<Keys>;
+    const size_t n = static_cast<size_t>(state.range(0));
+    const auto keys = make_keys<Keys>(n, 0);
+    std::vector<std::pair<typename Keys::Key, Value>> pairs;
+    pairs.reserve(n);
+    for (size_t i = 0; i < n; ++i) pairs.emplace_back(keys[i], i);
+    size_t size = 0, buckets = 0;
+
+    for (auto _ : state) {
+        std::unique_ptr<Map> map;
+        if constexpr (requires { Map::from_range(pairs.begin(), pairs.end()); }) {
+            map = std::make_unique<Map>(Map::from_range(pairs.begin(), pairs.end()));
+        } else {
+            map = std::make_unique<Map>();
+            if constexpr (requires { map->reserve(n); }) map->reserve(n);
+            for (const auto& [key, value] : pairs) insert(*map, key, value);
+        }
+        size = map->size();
+        buckets = bucket_count(*map);
+        benchmark::DoNotOptimize(map.get());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+    state.counters["load_factor"] = static_cast<double>(size) / static_cast<double>(buckets);
+}
+
+// from_range_parallel over n pairs with a given number of workers, and
+// grow_parallel of the result; speedups are relative to the 1-worker runs.
+template <typename Table, typename Keys>
+void BM_BuildParallel(benchmark::State& state) {
+    using Map = typename Table::template Map<Keys>;
+    const size_t n = static_cast<size_t>(state.range(0));
+    const size_t workers = static_cast<size_t>(state.range(1));
+    const auto keys = make_keys<Keys>(n, 0);
+    std::vector<std::pair<typename Keys::Key, Value>> pairs;
+    pairs.reserve(n);
+    for (size_t i = 0; i < n; ++i) pairs.emplace_back(keys[i], i);
+
+    for (auto _ : state) {
+        auto map = Map::from_range_parallel(pairs.begin(), pairs.end(), workers);
+        map.grow_parallel(workers);
+        benchmark::DoNotOptimize(&map);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+
+// Look up n keys that are all present (parity 0) or all absent (parity 1).
+template <typename Table, typename Keys, uint64_t parity>
+void BM_Lookup(benchmark::State& state) {
+    using Map = typename Table::template Map<Keys>;
+    const size_t n = static_cast<size_t>(state.range(0));
+    const auto keys = make_keys<Keys>(n, 0);
+    const auto probes = make_keys<Keys>(n, parity);
+
+    auto map = std::make_unique<Map>();
+    presize(*map, n, static_cast<int>(state.range(1)));
+    for (size_t i = 0; i < n; ++i) insert(*map, keys[i], i);
+
+    for (auto _ : state) {
+        Value sum = 0;
+        for (const auto& key : probes) {
+            const Value* value = find(*map, key);
+            sum += value ? *value : 1;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    report(state, *map, n);
+}
+
+// Hash n keys, without touching a table.
+template <typename Hasher, typename Keys>
+void BM_Hash(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    const auto keys = make_keys<Keys>(n, 0);
+    const typename Hasher::template type<Keys> hash;
+
+    for (auto _ : state) {
+        uint64_t sum = 0;
+        for (const auto& key : keys) sum += static_cast<uint64_t>(hash(key));
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+
+// Same probes as BM_Lookup through get_batch, for tables that have it.
+template <typename Table, typename Keys, uint64_t parity>
+void BM_LookupBatch(benchmark::State& state) {
+    using Map = typename Table::template Map<Keys>;
+    const size_t n = static_cast<size_t>(state.range(0));
+    const auto keys = make_keys<Keys>(n, 0);
+    const auto probes = make_keys<Keys>(n, parity);
+
+    auto map = std::make_unique<Map>();
+    presize(*map, n, static_cast<int>(state.range(1)));
+    for (size_t i = 0; i < n; ++i) insert(*map, keys[i], i);
+
+    std::vector<const Value*> out(n);
+    for (auto _ : state) {
+        std::as_const(*map).get_batch(probes, out);
+        Value sum = 0;
+        for (const Value* value : out) sum += value ? *value : 1;
+        benchmark::DoNotOptimize(sum);
+    }
+    report(state, *map, n);
+}
+
+// Same probes again as async_get coroutines, `width` of them interleaved
+// by run_round_robin. Width 1 is the coroutine overhead alone.
+template <typename Table, typename Keys, uint64_t parity>
+void BM_LookupAsync(benchmark::State& state) {
+    using Map = typename Table::template Map<Keys>;
+    const size_t n = static_cast<size_t>(state.range(0));
+    const size_t width = static_cast<size_t>(state.range(1));
+    const auto keys = make_keys<Keys>(n, 0);
+    const auto probes = make_keys<Keys>(n, parity);
+
+    auto map = std::make_unique<Map>();
+    for (size_t i = 0; i < n; ++i) insert(*map, keys[i], i);
+    const Map& view = *map;
+
+    for (auto _ : state) {
+        Value sum = 0;
+        run_round_robin(n, width, [&](size_t i) { return view.async_get(probes[i]); },
+                        [&](size_t, const Value* value) { sum += value ? *value : 1; });
+        benchmark::DoNotOptimize(sum);
+    }
+    report(state, *map, n);
+}
+
+// Erase all n keys of a filled table.
+template <typename Table, typename Keys>
+void BM_Erase(benchmark::State& state) {
+    using Map = typename Table::template Map<Keys>;
+    const size_t n = static_cast<size_t>(state.range(0));
+    const auto keys = make_keys<Keys>(n, 0);
+    std::unique_ptr<Map> map;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        map = std::make_unique<Map>();
+        for (size_t i = 0; i < n; ++i) insert(*map, keys[i], i);
+        state.ResumeTiming();
+
+        for (const auto& key : keys) erase(*map, key);
+        benchmark::ClobberMemory();
+
+        state.PauseTiming();
+        map.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+
+// Visit every entry of a filled table once, summing the values: the range
+// for loop, or for_each_parallel over `workers` threads where the table has
+// it (workers 0 is the plain loop).
+template <typename Table, typename Keys>
+void BM_Iterate(benchmark::State& state) {
+    using Map = typename Table::template Map<Keys>;
+    const size_t n = static_cast<size_t>(state.range(0));
+    const size_t workers = static_cast<size_t>(state.range(1));
+    const auto keys = make_keys<Keys>(n, 0);
+    Map map;
+    for (size_t i = 0; i < n; ++i) insert(map, keys[i], i);
+    if constexpr (requires { map.finish_migration(); }) map.finish_migration();
+
+    for (auto _ : state) {
+        Value sum = 0;
+        if (workers == 0) {
+            for (const auto& [key, value] : map) sum += value;
+        } else if constexpr (requires { map.for_each_parallel([](const auto&, const Value&) {}, 1); }) {
+            std::atomic<Value> total{0};
+            map.for_each_parallel([&](const auto&, const Value& value) {
+                total.fetch_add(value, std::memory_order_relaxed);
+            }, workers);
+            sum = total.load();
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    report(state, map, n);
+}
+
+// Read-mostly steady state over a filled table: 80% hit lookups, then an
+// insert of an absent key and its erase, so the size stays at n.
+template <typename Table, typename Keys>
+void BM_Mixed(benchmark::State& state) {
+    using Map = typename Table::template Map<Keys>;
+    const size_t n = static_cast<size_t>(state.range(0));
+    const auto keys = make_keys<Keys>(n, 0);
+    const auto extra = make_keys<Keys>(n, 1);
+
+    auto map = std::make_unique<Map>();
+    for (size_t i = 0; i < n; ++i) insert(*map, keys[i], i);
+
+    constexpr size_t ops = 10;
+    size_t next = 0;
+    for (auto _ : state) {
+        Value sum = 0;
+        for (size_t op = 0; op < ops - 2; ++op) {
+            const Value* value = find(*map, keys[(next * 7 + op * 131) % n]);
+            sum += value ? *value : 1;
+        }
+        const auto& key = extra[next];
+        insert(*map, key, next);
+        erase(*map, key);
+        next = next + 1 == n ? 0 : next + 1;
+        benchmark::DoNotOptimize(sum);
+    }
+    report(state, *map, ops);
+}
+
+
+// Shared read-mostly table: HashTable behind a std::shared_mutex against
+// ConcurrentHashTable's lock-free readers. Thread 0 also writes once every
+// 1024 lookups.
+struct SharedMutexTable {
+    static constexpr const char* name = "HashTable+shared_mutex";
+    HashTable<int, Value, 64> table;
+    mutable std::shared_mutex mutex;
+
+    bool get(int key) const {
+        std::shared_lock lock(mutex);
+        return table.get(key).has_value();
+    }
+    void insert_or_assign(int key, Value value) {
+        std::unique_lock lock(mutex);
+        table.insert_or_assign(key, value);
+    }
+    void erase(int key) {
+        std::unique_lock lock(mutex);
+        table.erase(key);
+    }
+};
+
+struct ConcurrentTable {
+    static constexpr const char* name = "ConcurrentHashTable";
+    ConcurrentHashTable<int, Value, 64> table;
+
+    bool get(int key) const { return table.get(key).has_value(); }
+    void insert_or_assign(int key, Value value) { table.insert_or_assign(key, value); }
+};
+
+struct ShardedTable {
+    static constexpr const char* name = "ShardedHashTable";
+    ShardedHashTable<int, Value, 64> table;
+
+    bool get(int key) const { return table.get(key).has_value(); }
+    void insert_or_assign(int key, Value value) { table.insert_or_assign(key, value); }
+    void erase(int key) { table.erase(key); }
+};
+
+// NumaHashTable over the host's nodes; on a single-node host this measures
+// what placement and (for replicated) routing add on top of sharding.
+template <NumaPlacement placement>
+struct NumaTable {
+    static constexpr const char* name =
+        placement == NumaPlacement::replicated ? "NumaHashTable/replicated" : "NumaHashTable/partitioned";
+    NumaHashTable<int, Value, 64> table{placement};
+
+    bool get(int key) const { return table.get(key).has_value(); }
+    void insert_or_assign(int key, Value value) { table.insert_or_assign(key, value); }
+    void erase(int key) { table.erase(key); }
+};
+
+template <typename Shared>
+void BM_SharedReads(benchmark::State& state) {
+    constexpr size_t n = 1 << 16;
+    static Shared* shared = nullptr;
+    static std::vector<int> keys;
+    if (state.thread_index() == 0) {
+        keys = make_keys<IntKeys>(n, 0);
+        shared = new Shared;
+        for (size_t i = 0; i < n; ++i) shared->insert_or_assign(keys[i], i);
+    }
+    // google benchmark starts timing only after every thread got here.
+    size_t next = static_cast<size_t>(state.thread_index()) * 4099;
+    for (auto _ : state) {
+        size_t found = 0;
+        for (size_t op = 0; op < 1024; ++op) {
+            found += shared->get(keys[next]);
+            next = next + 1 == n ? 0 : next + 1;
+        }
+        if (state.thread_index() == 0) shared->insert_or_assign(keys[next], next);
+        benchmark::DoNotOptimize(found);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * 1024));
+    if (state.thread_index() == 0) {
+        delete shared;
+        shared = nullptr;
+    }
+}
+
+// Write-heavy ingestion: every thread inserts and then erases its own run
+// of keys, so the table keeps growing and shrinking under contention.
+template <typename Shared>
+void BM_SharedWrites(benchmark::State& state) {
+    constexpr size_t per_thread = 1 << 12;
+    static Shared* shared = nullptr;
+    if (state.thread_index() == 0) shared = new Shared;
+    const auto keys = make_keys<IntKeys>(per_thread * static_cast<size_t>(state.threads()), 0);
+    const size_t first = static_cast<size_t>(state.thread_index()) * per_thread;
+
+    for (auto _ : state) {
+        for (size_t i = first; i < first + per_thread; ++i) shared->insert_or_assign(keys[i], i);
+        for (size_t i = first; i < first + per_thread; ++i) shared->erase(keys[i]);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * 2 * per_thread));
+    if (state.thread_index() == 0) {
+        delete shared;
+        shared = nullptr;
+    }
+}
+
+// Small fixed key sets (configuration maps): every StaticLookup strategy
+// against the dynamic tables, on a stream of probes that hit half the time.
+template <size_t N>
+constexpr std::array<std::pair<int, Value>, N> config_pairs() {
+    std::array<std::pair<int, Value>, N> pairs{};
+    for (size_t i = 0; i < N; ++i) pairs[i] = {static_cast<int>(i * 37 + 11), i};
+    return pairs;
+}
+
+template <size_t N>
+std::vector<int> config_probes() {
+    std::vector<int> probes(4096);
+    for (size_t i = 0; i < probes.size(); ++i) {
+        size_t k = scramble(i) % (2 * N);
+        probes[i] = static_cast<int>(k < N ? k * 37 + 11 : k * 37 + 12);
+    }
+    return probes;
+}
+
+template <size_t N, LookupStrategy strategy>
+void BM_StaticLookup(benchmark::State& state) {
+    static constexpr auto lookup = StaticLookup<int, Value, N, strategy>::from_nice_pairs(config_pairs<N>());
+    const auto probes = config_probes<N>();
+    for (auto _ : state) {
+        Value sum = 0;
+        for (int key : probes) {
+            auto value = lookup.get(key);
+            sum += value ? value->get() : 1;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * probes.size()));
+}
+
+// PerfectHashTable snapshot under an OverlayHashTable holding
+// state.range(0) runtime keys that the probes never ask for.
+template <size_t N>
+void BM_OverlayLookup(benchmark::State& state) {
+    static constexpr auto snapshot = PerfectHashTable<int, Value, N>::from_nice_pairs(config_pairs<N>());
+    OverlayHashTable<int, Value, N> table(snapshot);
+    for (int64_t i = 0; i < state.range(0); ++i) table.insert(-1 - static_cast<int>(i), 0);
+    const auto probes = config_probes<N>();
+    for (auto _ : state) {
+        Value sum = 0;
+        for (int key : probes) {
+            auto value = table.get(key);
+            sum += value ? value->get() : 1;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * probes.size()));
+}
+
+template <size_t N, typename Table>
+void BM_SmallTable(benchmark::State& state) {
+    typename Table::template Map<IntKeys> map;
+    for (const auto& [key, value] : config_pairs<N>()) insert(map, key, value);
+    const auto probes = config_probes<N>();
+    for (auto _ : state) {
+        Value sum = 0;
+        for (int key : probes) {
+            const Value* value = find(map, key);
+            sum += value ? *value : 1;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * probes.size()));
+}
+
+// Object sizes of a few HashTable instantiations, reported in the run's
+// context. Most of the footprint is the inline base tier.
+template <typename Table>
+void report_sizeof(const char* name) {
+    benchmark::AddCustomContext(std::string("sizeof(") + name + ")", std::to_string(sizeof(Table)));
+}
+
+void report_table_sizes() {
+    report_sizeof<HashTable<int, int, 64>>("HashTable<int, int, 64>");
+    report_sizeof<HashTable<int, int, 1024>>("HashTable<int, int, 1024>");
+    report_sizeof<HashTable<uint64_t, uint64_t, 1024>>("HashTable<uint64_t, uint64_t, 1024>");
+    report_sizeof<HashTable<std::string, int, 64>>("HashTable<std::string, int, 64>");
+}
+
+template <size_t N>
+void register_small_sets() {
+    const std::string suffix = "/int/" + std::to_string(N);
+    benchmark::RegisterBenchmark(("static_lookup/compare_chain" + suffix).c_str(),
+                                 BM_StaticLookup<N, LookupStrategy::compare_chain>);
+    if constexpr (N <= 64) {
+        benchmark::RegisterBenchmark(("static_lookup/simd_scan" + suffix).c_str(),
+                                     BM_StaticLookup<N, LookupStrategy::simd_scan>);
+    }
+    benchmark::RegisterBenchmark(("static_lookup/perfect_hash" + suffix).c_str(),
+                                 BM_StaticLookup<N, LookupStrategy::perfect_hash>);
+    benchmark::RegisterBenchmark(("static_lookup/OverlayHashTable" + suffix).c_str(), BM_OverlayLookup<N>)
+        ->Arg(0)
+        ->Arg(16)
+        ->Arg(1024)
+        ->ArgName("overlay");
+    benchmark::RegisterBenchmark(("static_lookup/HashTable" + suffix).c_str(), BM_SmallTable<N, ChainedTable>);
+    benchmark::RegisterBenchmark(("static_lookup/std::unordered_map" + suffix).c_str(),
+                                 BM_SmallTable<N, StdTable>);
+}
+
+
+constexpr int64_t sizes[] = {1 << 10, 1 << 16, 1 << 20};
+constexpr int64_t loads[] = {0, 25, 50};
+
+template <typename Table, typename Keys>
+void register_table_keys() {
+    auto name = [](const char* op) {
+        return std::string(op) + "/" + Table::name + "/" + Keys::name;
+    };
+
+    auto with_loads = [](benchmark::internal::Benchmark* b) {
+        for (int64_t n : sizes)
+            for (int64_t load : loads) b->Args({n, load});
+        b->ArgNames({"", "load"});
+    };
+    auto sized = [](benchmark::internal::Benchmark* b) {
+        for (int64_t n : sizes) b->Arg(n);
+    };
+
+    benchmark::RegisterBenchmark(name("insert").c_str(), BM_Insert<Table, Keys>)->Apply(with_loads);
+    benchmark::RegisterBenchmark(name("growth").c_str(), BM_Growth<Table, Keys>)->Apply(sized);
+    benchmark::RegisterBenchmark(name("build").c_str(), BM_Build<Table, Keys>)->Apply(sized);
+    if constexpr (requires(std::vector<std::pair<typename Keys::Key, Value>>& pairs) {
+                      Table::template Map<Keys>::from_range_parallel(pairs.begin(), pairs.end(), 1);
+                  }) {
+        benchmark::RegisterBenchmark(name("build_parallel").c_str(), BM_BuildParallel<Table, Keys>)
+            ->ArgsProduct({{1 << 20}, {1, 2, 4, 8, 16}})
+            ->ArgNames({"", "workers"})
+            ->UseRealTime();
+    }
+    benchmark::RegisterBenchmark(name("lookup_hit").c_str(), BM_Lookup<Table, Keys, 0>)->Apply(with_loads);
+    benchmark::RegisterBenchmark(name("lookup_miss").c_str(), BM_Lookup<Table, Keys, 1>)->Apply(with_loads);
+    if constexpr (requires(const typename Table::template Map<Keys>& map,
+                           std::vector<typename Keys::Key>& keys, std::vector<const Value*>& out) {
+                      map.get_batch(keys, out);
+                  }) {
+        benchmark::RegisterBenchmark(name("lookup_hit_batch").c_str(), BM_LookupBatch<Table, Keys, 0>)
+            ->Apply(with_loads);
+        benchmark::RegisterBenchmark(name("lookup_miss_batch").c_str(), BM_LookupBatch<Table, Keys, 1>)
+            ->Apply(with_loads);
+    }
+    if constexpr (requires(const typename Table::template Map<Keys>& map, const typename Keys::Key& key) {
+                      map.async_get(key);
+                  }) {
+        // Interleaving pays once the table is well past the LLC: int keys
+        // also run at that size, through the plain and batched paths too.
+        constexpr int64_t beyond_llc = 1 << 23;
+        std::vector<int64_t> async_sizes = {1 << 16};
+        if constexpr (std::is_same_v<Table, ChainedTable> && std::is_same_v<Keys, IntKeys>) {
+            async_sizes.push_back(beyond_llc);
+            benchmark::RegisterBenchmark(name("lookup_hit").c_str(), BM_Lookup<Table, Keys, 0>)
+                ->Args({beyond_llc, 0})
+                ->ArgNames({"", "load"});
+            benchmark::RegisterBenchmark(name("lookup_hit_batch").c_str(), BM_LookupBatch<Table, Keys, 0>)
+                ->Args({beyond_llc, 0})
+                ->ArgNames({"", "load"});
+        }
+        benchmark::RegisterBenchmark(name("lookup_hit_async").c_str(), BM_LookupAsync<Table, Keys, 0>)
+            ->ArgsProduct({async_sizes, {1, 8, 16, 32}})
+            ->ArgNames({"", "width"});
+        benchmark::RegisterBenchmark(name("lookup_miss_async").c_str(), BM_LookupAsync<Table, Keys, 1>)
+            ->ArgsProduct({async_sizes, {1, 8, 16, 32}})
+            ->ArgNames({"", "width"});
+    }
+    benchmark::RegisterBenchmark(name("erase").c_str(), BM_Erase<Table, Keys>)->Apply(sized);
+    benchmark::RegisterBenchmark(name("mixed").c_str(), BM_Mixed<Table, Keys>)->Apply(sized);
+    if constexpr (requires(const typename Table::template Map<Keys>& map) { map.begin(); }) {
+        auto iterated = benchmark::RegisterBenchmark(name("iterate").c_str(), BM_Iterate<Table, Keys>);
+        for (int64_t n : sizes) iterated->Args({n, 0});
+        if constexpr (requires(typename Table::template Map<Keys>& map) {
+                          map.for_each_parallel([](const auto&, const Value&) {}, 1);
+                      }) {
+            iterated->ArgsProduct({{1 << 20}, {1, 2, 4, 8}})->UseRealTime();
+        }
+        iterated->ArgNames({"", "workers"});
+    }
+}
+
+template <typename Hasher, typename Keys>
+void register_hasher_keys() {
+    const std::string suffix = std::string(Hasher::name) + "/" + Keys::name;
+    benchmark::RegisterBenchmark(("hash/" + suffix).c_str(), BM_Hash<Hasher, Keys>)->Arg(1 << 10);
+    benchmark::RegisterBenchmark(("lookup_hit/HashTable+" + suffix).c_str(),
+                                 BM_Lookup<HasherTable<Hasher>, Keys, 0>)
+        ->Args({1 << 16, 0})
+        ->ArgNames({"", "load"});
+}
+
+template <typename Hasher>
+void register_hasher() {
+    register_hasher_keys<Hasher, IntKeys>();
+    if constexpr (std::is_invocable_v<typename Hasher::template type<ShortStringKeys>, const std::string&>) {
+        register_hasher_keys<Hasher, ShortStringKeys>();
+        register_hasher_keys<Hasher, LongStringKeys>();
+    }
+}
+
+template <typename Table>
+void register_table() {
+    register_table_keys<Table, IntKeys>();
+    register_table_keys<Table, Key16Keys>();
+    register_table_keys<Table, ShortStringKeys>();
+    register_table_keys<Table, LongStringKeys>();
+}
+
+} // namespace
+
+
+int main(int argc, char** argv) {
+    register_table<ChainedTable>();
+    register_table_keys<StoredHashTable<hash_policy::StoreHash>, ShortStringKeys>();
+    register_table_keys<StoredHashTable<hash_policy::StoreHash>, LongStringKeys>();
+    register_table_keys<StoredHashTable<hash_policy::StoreFingerprint>, ShortStringKeys>();
+    register_table_keys<StoredHashTable<hash_policy::StoreFingerprint>, LongStringKeys>();
+    register_table<OpenTable>();
+    register_table<StdTable>();
+#if defined(HASH_TABLE_BENCH_ABSL)
+    register_table<AbslTable>();
+#endif
+#if defined(HASH_TABLE_BENCH_ANKERL)
+    register_table<AnkerlTable>();
+#endif
+    register_hasher<DefaultHasher>();
+    register_hasher<WyHasher>();
+    register_hasher<Xxh3Hasher>();
+    register_hasher<Crc32cHasher>();
+    register_small_sets<4>();
+    register_small_sets<16>();
+    register_small_sets<32>();
+    register_small_sets<128>();
+    benchmark::RegisterBenchmark("shared_reads/HashTable+shared_mutex/int",
+                                 BM_SharedReads<SharedMutexTable>)->ThreadRange(1, 64)->UseRealTime();
+    benchmark::RegisterBenchmark("shared_reads/ConcurrentHashTable/int",
+                                 BM_SharedReads<ConcurrentTable>)->ThreadRange(1, 64)->UseRealTime();
+    benchmark::RegisterBenchmark("shared_reads/NumaHashTable/partitioned/int",
+                                 BM_SharedReads<NumaTable<NumaPlacement::partitioned>>)
+        ->ThreadRange(1, 64)->UseRealTime();
+    benchmark::RegisterBenchmark("shared_reads/NumaHashTable/replicated/int",
+                                 BM_SharedReads<NumaTable<NumaPlacement::replicated>>)
+        ->ThreadRange(1, 64)->UseRealTime();
+    benchmark::RegisterBenchmark("shared_writes/HashTable+shared_mutex/int",
+                                 BM_SharedWrites<SharedMutexTable>)->ThreadRange(1, 64)->UseRealTime();
+    benchmark::RegisterBenchmark("shared_writes/ShardedHashTable/int",
+                                 BM_SharedWrites<ShardedTable>)->ThreadRange(1, 64)->UseRealTime();
+    benchmark::RegisterBenchmark("shared_writes/NumaHashTable/partitioned/int",
+                                 BM_SharedWrites<NumaTable<NumaPlacement::partitioned>>)
+        ->ThreadRange(1, 64)->UseRealTime();
+
+    // Default to JSON on stdout so runs can be collected and compared.
+    std::vector<char*> args(argv, argv + argc);
+    bool has_format = false;
+    for (int i = 1; i < argc; ++i) {
+        has_format |= std::strncmp(argv[i], "--benchmark_format", 18) == 0;
+    }
+    char json_format[] = "--benchmark_format=json";
+    if (!has_format) args.insert(args.begin() + 1, json_format);
+    int args_count = static_cast<int>(args.size());
+
+    report_table_sizes();
+    benchmark::Initialize(&args_count, args.data());
+    if (benchmark::ReportUnrecognizedArguments(args_count, args.data())) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,743 @@
+// Per-operation latency of HashTable, OpenHashTable and std::unordered_map.
+//
+// hash_table_bench measures throughput. This harness times every single
+// operation and reports the distribution (p50/p99/p999/max), since a table
+// with a good mean can still stall callers for milliseconds while it grows.
+// For each table, key type, huge-page mode and size it times:
+//
+//   insert       inserts into a table growing from empty
+//   insert+grow  the subset of those inserts that grew the table
+//   get_hit      lookups of present keys, in random order
+//   get_miss     lookups of absent keys
+//   erase        erasing present keys in random order
+//
+// It also reports per-operation hardware counters (cache misses, branch
+// misses, dTLB load misses), read through perf_event_open around each phase,
+// plus page faults. Where the counters are not available (e.g.
+// perf_event_paranoid, or a VM without a PMU) the columns show "-".
+//
+// Sizes are picked relative to the data cache sizes: half of L1, half of
+// L2, half of the LLC, and 4x the LLC (capped by --max-bytes). Entry counts
+// come from HashTable's measured footprint and are shared by every table, so
+// rows of one size class compare the tables on the same workload.
+//
+// Huge pages: the tables' bucket and slot arrays come from PageMemory
+// (page_memory.hpp). "on" asks for transparent huge pages on them, and
+// "hugetlb" for pages from the hugetlbfs pool (falling back to THP when the
+// pool is empty). "off" disables THP for the whole process
+// (PR_SET_THP_DISABLE). The thp_MiB column shows how much of the process
+// actually ended up on transparent huge pages.
+//
+//     hash_table_latency [--table=hash_table,open_hash_table,unordered_map]
+//                        [--keys=int,short_string] [--huge-pages=off,on,hugetlb]
+//                        [--sizes=l1,l2,llc,dram] [--entries=N,...]
+//                        [--samples=N] [--max-bytes=N] [--out=FILE.csv]
+//
+// Every option takes a comma-separated list; the defaults run everything.
+// Latencies are in nanoseconds with the timer's own overhead subtracted.
+// --out also writes the rows as CSV, for tracking tail regressions across
+// builds.
+
+#include "hash_table.hpp"
+#include "open_hash_table.hpp"
+#include "page_memory.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace {
+
+using Value = uint64_t;
+
+template <typename T>
+inline void keep(const T& value) {
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+
+// Timestamps. On x86 the TSC, fenced so the timed operation cannot move
+// across either read; elsewhere steady_clock.
+struct Timer {
+    double ns_per_tick = 1.0;
+    uint64_t overhead = 0;  // ticks of two back-to-back reads
+    const char* source = "steady_clock";
+
+    static uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_lfence();
+        const uint64_t t = __rdtsc();
+        _mm_lfence();
+        return t;
+#else
+        return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    Timer() {
+        using Clock = std::chrono::steady_clock;
+#if defined(__x86_64__) || defined(__i386__)
+        source = "rdtsc";
+        const auto wall0 = Clock::now();
+        const uint64_t t0 = now();
+        while (Clock::now() - wall0 < std::chrono::milliseconds(50)) {
+        }
+        const uint64_t t1 = now();
+        const auto wall = std::chrono::duration<double, std::nano>(Clock::now() - wall0).count();
+        ns_per_tick = wall / static_cast<double>(t1 - t0);
+#else
+        ns_per_tick = static_cast<double>(Clock::period::num) * 1e9 / static_cast<double>(Clock::period::den);
+#endif
+        overhead = UINT64_MAX;
+        for (int i = 0; i < 10000; ++i) {
+            const uint64_t a = now();
+            const uint64_t b = now();
+            overhead = std::min(overhead, b - a);
+        }
+    }
+
+    double ns(uint64_t ticks) const { return static_cast<double>(ticks) * ns_per_tick; }
+};
+
+
+// Counters around a phase, one file descriptor per event so that each is
+// used whenever the kernel offers it.
+class PerfCounters {
+public:
+    static constexpr size_t count = 4;
+    static constexpr std::array<const char*, count> names = {"cache_miss", "branch_miss", "dtlb_miss", "faults"};
+    using Counts = std::array<std::optional<uint64_t>, count>;
+
+    PerfCounters() {
+        fds.fill(-1);
+#if defined(__linux__)
+        const uint64_t dtlb_read_miss = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                        (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        const std::array<std::pair<uint32_t, uint64_t>, count> events = {{
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+            {PERF_TYPE_HW_CACHE, dtlb_read_miss},
+            {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+        }};
+        for (size_t i = 0; i < count; ++i) {
+            perf_event_attr attr{};
+            attr.size = sizeof(attr);
+            attr.type = events[i].first;
+            attr.config = events[i].second;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fds[i] = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+            if (fds[i] < 0 && errors.empty()) errors = std::strerror(errno);
+        }
+#else
+        errors = "perf_event_open is Linux only";
+#endif
+    }
+
+    ~PerfCounters() {
+#if defined(__linux__)
+        for (int fd : fds) {
+            if (fd >= 0) ::close(fd);
+        }
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available(size_t i) const { return fds[i] >= 0; }
+
+    // Why the first unavailable counter could not be opened, or "".
+    const std::string& error() const { return errors; }
+
+    void start() {
+#if defined(__linux__)
+        for (int fd : fds) {
+            if (fd < 0) continue;
+            ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    void stop() {
+#if defined(__linux__)
+        for (int fd : fds) {
+            if (fd >= 0) ::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+#endif
+    }
+
+    // Counts since start(), accumulated over start/stop pairs by the caller.
+    Counts read() const {
+        Counts counts;
+#if defined(__linux__)
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t value = 0;
+            if (fds[i] >= 0 && ::read(fds[i], &value, sizeof(value)) == sizeof(value)) counts[i] = value;
+        }
+#endif
+        return counts;
+    }
+
+private:
+    std::array<int, count> fds;
+    std::string errors;
+};
+
+void accumulate(PerfCounters::Counts& total, const PerfCounters::Counts& phase) {
+    for (size_t i = 0; i < PerfCounters::count; ++i) {
+        if (phase[i]) total[i] = total[i].value_or(0) + *phase[i];
+    }
+}
+
+
+// Memory for the tables' arrays: PageMemory (page_memory.hpp) in the
+// current huge-page mode, counting every byte handed out, which is how the
+// footprint column is measured. Single nodes come from operator new as
+// with std::allocator, so that only the array placement changes.
+inline size_t live_bytes = 0;
+inline PageMemory page_memory;
+
+// Huge pages for the whole process: "off" also disables THP (even in the
+// system's "always" mode), so nothing but ordinary pages is used.
+void set_huge_pages(HugePages huge_pages) {
+    page_memory.huge_pages = huge_pages;
+#if defined(__linux__)
+    ::prctl(PR_SET_THP_DISABLE, huge_pages == HugePages::off ? 1 : 0, 0, 0, 0);
+#endif
+}
+
+// AnonHugePages of the whole process, in bytes; 0 where unknown.
+size_t huge_page_bytes() {
+    std::ifstream in("/proc/self/smaps_rollup");
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.rfind("AnonHugePages:", 0) == 0) return std::strtoull(line.c_str() + 14, nullptr, 10) << 10;
+    }
+    return 0;
+}
+
+struct CountingMemory {
+    static void* allocate(size_t bytes, size_t alignment) {
+        void* p = page_memory.allocate(bytes, alignment);
+        live_bytes += bytes;
+        return p;
+    }
+
+    static void deallocate(void* p, size_t bytes, size_t alignment) noexcept {
+        live_bytes -= bytes;
+        page_memory.deallocate(p, bytes, alignment);
+    }
+};
+
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    CountingAllocator() = default;
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        if (n != 1) return static_cast<T*>(CountingMemory::allocate(n * sizeof(T), alignof(T)));
+        live_bytes += sizeof(T);
+        return static_cast<T*>(::operator new(sizeof(T), std::align_val_t{alignof(T)}));
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        if (n != 1) return CountingMemory::deallocate(p, n * sizeof(T), alignof(T));
+        live_bytes -= sizeof(T);
+        ::operator delete(p, std::align_val_t{alignof(T)});
+    }
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U>&) const { return true; }
+};
+
+
+// Keys: index 2i is inserted, 2i + 1 never is (as in hash_table_bench).
+uint64_t scramble(uint64_t i) {
+    i ^= i >> 31;
+    i *= 0x7fb5d329728ea185ull;
+    i ^= i >> 27;
+    return i;
+}
+
+struct IntKeys {
+    using Key = uint64_t;
+    static constexpr const char* name = "int";
+    static Key make(uint64_t i) { return scramble(i); }
+};
+
+struct ShortStringKeys {
+    using Key = std::string;
+    static constexpr const char* name = "short_string";
+    static Key make(uint64_t i) { return std::to_string(static_cast<uint32_t>(scramble(i))); }  // fits SSO
+};
+
+template <typename Keys>
+std::vector<typename Keys::Key> make_keys(size_t n, uint64_t parity) {
+    std::vector<typename Keys::Key> keys;
+    keys.reserve(n);
+    for (size_t i = 0; i < n; ++i) keys.push_back(Keys::make(2 * i + parity));
+    return keys;
+}
+
+
+// Table adapters: a name, a map type per key family, and the footprint of
+// a built map in bytes.
+template <typename K>
+using Alloc = CountingAllocator<std::pair<const K, Value>>;
+
+struct ChainedTable {
+    static constexpr const char* name = "hash_table";
+    template <typename Keys>
+    using Map = HashTable<typename Keys::Key, Value, 64, hash_policy::DefaultHash<typename Keys::Key>,
+                          hash_policy::DefaultKeyEqual<typename Keys::Key>, PowerOfTwoCapacity,
+                          Alloc<typename Keys::Key>>;
+
+    template <typename Keys, typename Map>
+    static size_t footprint(const Map& map) { return sizeof(map) + live_bytes; }
+};
+
+struct OpenTable {
+    static constexpr const char* name = "open_hash_table";
+    template <typename Keys>
+    using Map = OpenHashTable<typename Keys::Key, Value, 64, hash_policy::DefaultHash<typename Keys::Key>,
+                              hash_policy::DefaultKeyEqual<typename Keys::Key>, CountingMemory>;
+
+    template <typename Keys, typename Map>
+    static size_t footprint(const Map& map) { return sizeof(map) + live_bytes; }
+};
+
+struct StdTable {
+    static constexpr const char* name = "unordered_map";
+    template <typename Keys>
+    using Map = std::unordered_map<typename Keys::Key, Value, std::hash<typename Keys::Key>,
+                                   std::equal_to<typename Keys::Key>, Alloc<typename Keys::Key>>;
+
+    template <typename Keys, typename Map>
+    static size_t footprint(const Map& map) { return sizeof(map) + live_bytes; }
+};
+
+template <typename Map, typename K>
+void insert(Map& map, const K& key, Value value) {
+    if constexpr (requires { map.get(key); }) {
+        map.insert(key, value);
+    } else {
+        map.emplace(key, value);
+    }
+}
+
+template <typename Map, typename K>
+const Value* find(const Map& map, const K& key) {
+    if constexpr (requires { map.get(key); }) {
+        auto found = map.get(key);
+        return found ? &found->get() : nullptr;
+    } else {
+        auto it = map.find(key);
+        return it != map.end() ? &it->second : nullptr;
+    }
+}
+
+template <typename Map>
+size_t bucket_count(const Map& map) {
+    if constexpr (requires { map.capacity(); }) {
+        return map.capacity();
+    } else {
+        return map.bucket_count();
+    }
+}
+
+
+// One row of output: the latencies of one operation and its counters.
+struct Row {
+    std::string table, keys, huge_pages, size_class;
+    size_t entries = 0, footprint = 0, thp_bytes = 0;
+    std::string op;
+    std::vector<uint64_t> samples;  // ticks
+    PerfCounters::Counts counters;
+};
+
+// Nearest-rank percentile; sorts `samples`.
+double percentile(std::vector<uint64_t>& samples, double p, const Timer& timer) {
+    if (samples.empty()) return 0;
+    const size_t rank = std::min(samples.size() - 1, static_cast<size_t>(std::ceil(p * samples.size())) - (p > 0));
+    std::nth_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(rank), samples.end());
+    return timer.ns(samples[rank]);
+}
+
+std::string format_ns(double ns) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), ns < 10000 ? "%.0f" : "%.3g", ns);
+    return buffer;
+}
+
+std::string per_op(const std::optional<uint64_t>& count, size_t ops) {
+    if (!count || ops == 0) return "-";
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.3f", static_cast<double>(*count) / static_cast<double>(ops));
+    return buffer;
+}
+
+struct Output {
+    const Timer& timer;
+    std::ofstream csv;
+    bool header_printed = false;
+
+    void print(Row& row) {
+        const size_t n = row.samples.size();
+        const std::string p50 = format_ns(percentile(row.samples, 0.50, timer));
+        const std::string p99 = format_ns(percentile(row.samples, 0.99, timer));
+        const std::string p999 = format_ns(percentile(row.samples, 0.999, timer));
+        const std::string max = format_ns(n ? timer.ns(*std::max_element(row.samples.begin(), row.samples.end())) : 0);
+        std::array<std::string, PerfCounters::count> counters;
+        for (size_t i = 0; i < counters.size(); ++i) counters[i] = per_op(row.counters[i], n);
+
+        if (!header_printed) {
+            std::printf("%-15s %-12s %-7s %-5s %10s %8s %7s %-11s %9s %8s %8s %8s %10s", "table", "keys", "thp",
+                        "size", "entries", "MiB", "thp_MiB", "op", "samples", "p50", "p99", "p999", "max");
+            for (const char* name : PerfCounters::names) std::printf(" %11s", name);
+            std::printf("\n");
+            if (csv) {
+                csv << "table,keys,huge_pages,size,entries,bytes,thp_bytes,op,samples,p50_ns,p99_ns,p999_ns,max_ns";
+                for (const char* name : PerfCounters::names) csv << ',' << name << "_per_op";
+                csv << '\n';
+            }
+            header_printed = true;
+        }
+        std::printf("%-15s %-12s %-7s %-5s %10zu %8.1f %7.1f %-11s %9zu %8s %8s %8s %10s", row.table.c_str(),
+                    row.keys.c_str(), row.huge_pages.c_str(), row.size_class.c_str(), row.entries,
+                    static_cast<double>(row.footprint) / (1 << 20), static_cast<double>(row.thp_bytes) / (1 << 20),
+                    row.op.c_str(), n, p50.c_str(), p99.c_str(), p999.c_str(), max.c_str());
+        for (const std::string& counter : counters) std::printf(" %11s", counter.c_str());
+        std::printf("\n");
+        std::fflush(stdout);
+        if (csv) {
+            csv << row.table << ',' << row.keys << ',' << row.huge_pages << ',' << row.size_class << ','
+                << row.entries << ',' << row.footprint << ',' << row.thp_bytes << ',' << row.op << ',' << n << ','
+                << p50 << ',' << p99 << ',' << p999 << ',' << max;
+            for (const std::string& counter : counters) csv << ',' << (counter == "-" ? "" : counter);
+            csv << '\n';
+        }
+    }
+};
+
+
+struct Config {
+    std::vector<std::string> tables = {"hash_table", "open_hash_table", "unordered_map"};
+    std::vector<std::string> keys = {"int", "short_string"};
+    std::vector<std::string> huge_pages = {"off", "on"};
+    std::vector<std::string> sizes = {"l1", "l2", "llc", "dram"};
+    std::vector<size_t> entries;  // overrides sizes
+    size_t samples = size_t{1} << 18;
+    size_t max_bytes = 0;
+};
+
+// Sizes of one (table, keys, huge pages) run: a label and an entry count.
+using Sizes = std::vector<std::pair<std::string, size_t>>;
+
+// Time every operation on a Map of n entries; rounds repeat a phase on a
+// fresh table until it has at least config.samples samples.
+template <typename Table, typename Keys>
+void run(const Config& config, const Sizes& sizes, const std::string& huge_pages, PerfCounters& perf, Output& out) {
+    using Map = typename Table::template Map<Keys>;
+    using Key = typename Keys::Key;
+
+    for (const auto& [size_class, n] : sizes) {
+        const std::vector<Key> hits = make_keys<Keys>(n, 0);
+        const std::vector<Key> misses = make_keys<Keys>(n, 1);
+        const size_t samples = std::max(config.samples, n);
+        const size_t rounds = (samples + n - 1) / n;
+        uint64_t rng = 0x9e3779b97f4a7c15ull ^ n;
+        auto random_index = [&] {
+            rng ^= rng << 13;
+            rng ^= rng >> 7;
+            rng ^= rng << 17;
+            return static_cast<size_t>(rng % n);
+        };
+
+        Row base;
+        base.table = Table::name;
+        base.keys = Keys::name;
+        base.huge_pages = huge_pages;
+        base.size_class = size_class;
+        base.entries = n;
+        Row inserts = base, grows = base, get_hit = base, get_miss = base, erases = base;
+        inserts.op = "insert";
+        grows.op = "insert+grow";
+        get_hit.op = "get_hit";
+        get_miss.op = "get_miss";
+        erases.op = "erase";
+        // Sample buffers are filled up front, so writing them does not
+        // page-fault inside the measured phases.
+        inserts.samples.assign(rounds * n, 0);
+        grows.samples.reserve(64 * rounds);
+
+        std::unique_ptr<Map> map;
+        for (size_t round = 0; round < rounds; ++round) {
+            map = std::make_unique<Map>();
+            perf.start();
+            for (size_t i = 0; i < n; ++i) {
+                const size_t before = bucket_count(*map);
+                const uint64_t t0 = Timer::now();
+                insert(*map, hits[i], i);
+                const uint64_t t1 = Timer::now();
+                inserts.samples[round * n + i] = t1 - t0;
+                if (bucket_count(*map) != before) grows.samples.push_back(t1 - t0);
+            }
+            perf.stop();
+            accumulate(inserts.counters, perf.read());
+        }
+        const size_t footprint = Table::template footprint<Keys>(*map);
+        const size_t thp_bytes = huge_page_bytes();
+        for (Row* row : {&inserts, &grows, &get_hit, &get_miss, &erases}) {
+            row->footprint = footprint;
+            row->thp_bytes = thp_bytes;
+        }
+
+        std::vector<size_t> order(config.samples);
+        for (size_t& i : order) i = random_index();
+        for (auto [row, keys] : {std::pair{&get_hit, &hits}, std::pair{&get_miss, &misses}}) {
+            row->samples.assign(order.size(), 0);
+            perf.start();
+            for (size_t j = 0; j < order.size(); ++j) {
+                const uint64_t t0 = Timer::now();
+                keep(find(*map, (*keys)[order[j]]));
+                const uint64_t t1 = Timer::now();
+                row->samples[j] = t1 - t0;
+            }
+            perf.stop();
+            row->counters = perf.read();
+        }
+
+        // Erase in a random order, refilling the table (untimed) whenever
+        // it runs empty.
+        std::vector<size_t> erase_order(n);
+        for (size_t i = 0; i < n; ++i) erase_order[i] = i;
+        erases.samples.assign(config.samples, 0);
+        for (size_t round = 0, done = 0; done < config.samples; ++round) {
+            if (round > 0) {
+                map = std::make_unique<Map>();
+                for (size_t i = 0; i < n; ++i) insert(*map, hits[i], i);
+            }
+            for (size_t i = n; i > 1; --i) std::swap(erase_order[i - 1], erase_order[random_index() % i]);
+            const size_t count = std::min(n, config.samples - done);
+            perf.start();
+            for (size_t i = 0; i < count; ++i) {
+                const uint64_t t0 = Timer::now();
+                map->erase(hits[erase_order[i]]);
+                const uint64_t t1 = Timer::now();
+                erases.samples[done + i] = t1 - t0;
+            }
+            perf.stop();
+            done += count;
+            accumulate(erases.counters, perf.read());
+        }
+        map.reset();
+
+        for (Row* row : {&inserts, &grows, &get_hit, &get_miss, &erases}) {
+            if (row->samples.empty()) continue;  // e.g. no insert grew the table
+            for (uint64_t& sample : row->samples) sample -= std::min(sample, out.timer.overhead);
+            out.print(*row);
+        }
+    }
+}
+
+// Data cache sizes in bytes, with defaults for when the system does not say.
+struct Caches {
+    size_t l1 = size_t{32} << 10, l2 = size_t{1} << 20, llc = size_t{32} << 20;
+
+    Caches() {
+#if defined(__linux__) && defined(_SC_LEVEL1_DCACHE_SIZE)
+        auto query = [](int name, size_t fallback) {
+            const long bytes = ::sysconf(name);
+            return bytes > 0 ? static_cast<size_t>(bytes) : fallback;
+        };
+        l1 = query(_SC_LEVEL1_DCACHE_SIZE, l1);
+        l2 = query(_SC_LEVEL2_CACHE_SIZE, l2);
+        llc = query(_SC_LEVEL3_CACHE_SIZE, l2 > llc ? l2 : llc);
+#endif
+    }
+};
+
+size_t physical_memory() {
+#if defined(__linux__)
+    const long pages = ::sysconf(_SC_PHYS_PAGES), page = ::sysconf(_SC_PAGESIZE);
+    if (pages > 0 && page > 0) return static_cast<size_t>(pages) * static_cast<size_t>(page);
+#endif
+    return size_t{4} << 30;
+}
+
+// HashTable's bytes per int entry, measured, which turns the cache-relative
+// size classes into entry counts.
+double bytes_per_entry() {
+    using Map = ChainedTable::Map<IntKeys>;
+    constexpr size_t n = size_t{1} << 16;
+    const size_t before = live_bytes;
+    auto map = std::make_unique<Map>();
+    for (size_t i = 0; i < n; ++i) insert(*map, IntKeys::make(2 * i), i);
+    return static_cast<double>(sizeof(Map) + live_bytes - before) / n;
+}
+
+Sizes pick_sizes(const Config& config, const Caches& caches) {
+    Sizes sizes;
+    if (!config.entries.empty()) {
+        for (size_t n : config.entries) sizes.emplace_back("n", std::max<size_t>(n, 1));
+        return sizes;
+    }
+    const double per_entry = bytes_per_entry();
+    for (const std::string& size : config.sizes) {
+        size_t bytes = 0;
+        if (size == "l1") bytes = caches.l1 / 2;
+        else if (size == "l2") bytes = caches.l2 / 2;
+        else if (size == "llc") bytes = caches.llc / 2;
+        else if (size == "dram") bytes = caches.llc * 4;
+        else throw std::invalid_argument("unknown size " + size);
+        bytes = std::min(bytes, config.max_bytes);
+        sizes.emplace_back(size, std::max<size_t>(static_cast<size_t>(static_cast<double>(bytes) / per_entry), 1));
+    }
+    return sizes;
+}
+
+template <typename Table>
+void run_keys(const Config& config, const Sizes& sizes, const std::string& huge_pages, PerfCounters& perf,
+              Output& out) {
+    for (const std::string& keys : config.keys) {
+        if (keys == "int") run<Table, IntKeys>(config, sizes, huge_pages, perf, out);
+        else if (keys == "short_string") run<Table, ShortStringKeys>(config, sizes, huge_pages, perf, out);
+        else throw std::invalid_argument("unknown keys " + keys);
+    }
+}
+
+std::vector<std::string> split(std::string_view list) {
+    std::vector<std::string> items;
+    while (!list.empty()) {
+        const size_t comma = std::min(list.find(','), list.size());
+        if (comma > 0) items.emplace_back(list.substr(0, comma));
+        list.remove_prefix(std::min(comma + 1, list.size()));
+    }
+    return items;
+}
+
+size_t parse_size(const std::string& text) {
+    size_t used = 0;
+    const unsigned long long value = std::stoull(text, &used);
+    if (used != text.size()) throw std::invalid_argument("not a number: " + text);
+    return static_cast<size_t>(value);
+}
+
+int usage() {
+    std::cerr << "usage: hash_table_latency [--table=hash_table,open_hash_table,unordered_map]\n"
+                 "                          [--keys=int,short_string] [--huge-pages=off,on,hugetlb]\n"
+                 "                          [--sizes=l1,l2,llc,dram] [--entries=N,...]\n"
+                 "                          [--samples=N] [--max-bytes=N] [--out=FILE.csv]\n";
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Config config;
+    config.max_bytes = physical_memory() / 4;
+    std::string out_path;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view arg = argv[i];
+            const size_t eq = arg.find('=');
+            if (arg.substr(0, 2) != "--" || eq == std::string_view::npos) return usage();
+            const std::string_view name = arg.substr(2, eq - 2);
+            const std::string value(arg.substr(eq + 1));
+            if (name == "table") config.tables = split(value);
+            else if (name == "keys") config.keys = split(value);
+            else if (name == "huge-pages") config.huge_pages = split(value);
+            else if (name == "sizes") config.sizes = split(value);
+            else if (name == "entries") {
+                config.entries.clear();
+                for (const std::string& n : split(value)) config.entries.push_back(parse_size(n));
+            } else if (name == "samples") config.samples = std::max<size_t>(parse_size(value), 1);
+            else if (name == "max-bytes") config.max_bytes = parse_size(value);
+            else if (name == "out") out_path = value;
+            else return usage();
+        }
+    } catch (const std::exception&) {
+        return usage();
+    }
+
+    const Timer timer;
+    const Caches caches;
+    PerfCounters perf;
+    Output out{timer, {}};
+    if (!out_path.empty()) {
+        out.csv.open(out_path);
+        if (!out.csv) {
+            std::cerr << "hash_table_latency: cannot write " << out_path << "\n";
+            return 1;
+        }
+    }
+
+    std::printf("timer: %s, %.3f ns/tick, overhead %.1f ns (subtracted)\n", timer.source, timer.ns_per_tick,
+                timer.ns(timer.overhead));
+    std::printf("caches: L1d %zu KiB, L2 %zu KiB, LLC %zu KiB\n", caches.l1 >> 10, caches.l2 >> 10, caches.llc >> 10);
+    for (size_t i = 0; i < PerfCounters::count; ++i) {
+        if (!perf.available(i)) {
+            std::printf("counters: %s not available (%s)\n", PerfCounters::names[i], perf.error().c_str());
+        }
+    }
+
+    try {
+        const Sizes sizes = pick_sizes(config, caches);
+        for (const std::string& huge_pages : config.huge_pages) {
+            if (huge_pages == "off") set_huge_pages(HugePages::off);
+            else if (huge_pages == "on") set_huge_pages(HugePages::transparent);
+            else if (huge_pages == "hugetlb") set_huge_pages(HugePages::hugetlb);
+            else throw std::invalid_argument("huge pages must be off, on or hugetlb");
+            for (const std::string& table : config.tables) {
+                if (table == "hash_table") run_keys<ChainedTable>(config, sizes, huge_pages, perf, out);
+                else if (table == "open_hash_table") run_keys<OpenTable>(config, sizes, huge_pages, perf, out);
+                else if (table == "unordered_map") run_keys<StdTable>(config, sizes, huge_pages, perf, out);
+                else throw std::invalid_argument("unknown table " + table);
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "hash_table_latency: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
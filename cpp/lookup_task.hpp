@@ -0,0 +1,192 @@
+#ifndef LOOKUP_TASK_HPP
+#define LOOKUP_TASK_HPP
+
+#include <algorithm>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "prefetch.hpp"
+
+
+// Coroutine lookups (HashTable::async_get) and the round-robin scheduler
+// that interleaves them.
+//
+// A lookup prefetches the memory it needs next and suspends instead of
+// stalling on it; the scheduler meanwhile resumes the other lookups it
+// keeps in flight, each of which issues its own prefetch before yielding in
+// turn. With `width` lookups in the ring, up to `width` cache misses
+// overlap, on any stream of keys and with the per-key logic written as
+// straight-line code:
+//
+//     std::vector<const int*> out(keys.size());
+//     run_round_robin(keys.size(), 16,
+//                     [&](size_t i) { return table.async_get(keys[i]); },
+//                     [&](size_t i, const int* value) { out[i] = value; });
+
+namespace detail {
+
+// Lookup frames are small and die quickly: recycle them through a
+// per-thread free list rather than paying a malloc and free per lookup.
+// Larger frames go to operator new.
+class FramePool {
+    static constexpr size_t block_size = 256;
+
+    struct Block {
+        Block* next;
+    };
+
+    Block* free_list = nullptr;
+
+public:
+    FramePool() = default;
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    ~FramePool() {
+        while (free_list) ::operator delete(std::exchange(free_list, free_list->next));
+    }
+
+    void* allocate(size_t size) {
+        if (size > block_size) return ::operator new(size);
+        if (free_list) return std::exchange(free_list, free_list->next);
+        return ::operator new(block_size);
+    }
+
+    void deallocate(void* p, size_t size) noexcept {
+        if (size > block_size) {
+            ::operator delete(p);
+            return;
+        }
+        free_list = ::new (p) Block{free_list};
+    }
+
+    static FramePool& local() {
+        thread_local FramePool pool;
+        return pool;
+    }
+};
+
+} // namespace detail
+
+
+// Awaitable that prefetches the cache line at `address` and suspends, so
+// whoever resumes the coroutine next gets to run first.
+struct PrefetchAwaiter {
+    const void* address;
+
+    bool await_ready() const noexcept {
+        prefetch(address);
+        return false;
+    }
+    void await_suspend(std::coroutine_handle<>) const noexcept {}
+    void await_resume() const noexcept {}
+};
+
+
+// Coroutine producing one T. It starts eagerly, running up to its first
+// suspension (usually right after the first prefetch), and is then driven
+// by resume() until done(); result() returns the co_returned value or
+// rethrows what the coroutine threw. Move-only; destroying it destroys the
+// coroutine, finished or not.
+template <typename T>
+class LookupTask {
+public:
+    struct promise_type {
+        T value{};
+        std::exception_ptr error;
+
+        static void* operator new(size_t size) { return detail::FramePool::local().allocate(size); }
+        static void operator delete(void* p, size_t size) noexcept {
+            detail::FramePool::local().deallocate(p, size);
+        }
+
+        LookupTask get_return_object() {
+            return LookupTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_value(T result) { value = std::move(result); }
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    LookupTask() = default;
+    LookupTask(LookupTask&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    LookupTask& operator=(LookupTask&& other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = std::exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+    ~LookupTask() {
+        if (handle) handle.destroy();
+    }
+
+    // Whether this holds a coroutine at all (default-constructed and
+    // moved-from tasks do not).
+    explicit operator bool() const { return static_cast<bool>(handle); }
+
+    bool done() const { return handle.done(); }
+
+    // Run the coroutine to its next suspension. Only while !done().
+    void resume() { handle.resume(); }
+
+    // Only once done().
+    T result() {
+        if (handle.promise().error) std::rethrow_exception(handle.promise().error);
+        return std::move(handle.promise().value);
+    }
+
+private:
+    std::coroutine_handle<promise_type> handle;
+
+    explicit LookupTask(std::coroutine_handle<promise_type> h) : handle(h) {}
+};
+
+
+// Run the tasks make(0) ... make(n - 1), at most `width` at a time,
+// resuming the live ones round-robin, and pass each result to
+// done(i, result) as it completes (not necessarily in order). make(i)
+// returns a LookupTask. Width is the number of misses kept in flight:
+// around 8-32 covers memory latency, and much more spills the tasks' own
+// state out of L1.
+template <typename Make, typename Done>
+void run_round_robin(size_t n, size_t width, Make&& make, Done&& done) {
+    using Task = std::invoke_result_t<Make&, size_t>;
+    width = std::clamp<size_t>(width, 1, std::max<size_t>(n, 1));
+    std::vector<Task> tasks;
+    std::vector<size_t> ids;
+    tasks.reserve(width);
+    ids.reserve(width);
+    size_t next = 0;
+    for (; next < width && next < n; ++next) {
+        tasks.push_back(make(next));
+        ids.push_back(next);
+    }
+
+    size_t live = tasks.size();
+    while (live) {
+        for (size_t slot = 0; slot < tasks.size(); ++slot) {
+            Task& task = tasks[slot];
+            if (!task) continue;
+            if (!task.done()) task.resume();
+            if (!task.done()) continue;
+            done(ids[slot], task.result());
+            if (next < n) {
+                task = make(next);
+                ids[slot] = next++;
+            } else {
+                task = Task();
+                --live;
+            }
+        }
+    }
+}
+
+
+#endif // LOOKUP_TASK_HPP
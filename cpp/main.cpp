@@ -1,7 +1,27 @@
 #include "hash_table.hpp"
+#include "static_hash_table.hpp"
+#include "perfect_hash_table.hpp"
+#include "open_hash_table.hpp"
+#include "slab_allocator.hpp"
+#include "concurrent_hash_table.hpp"
+#include "sharded_hash_table.hpp"
+#include "mapped_hash_table.hpp"
+#include "static_lookup.hpp"
+#include "overlay_hash_table.hpp"
+#include "numa_hash_table.hpp"
+#include "page_memory.hpp"
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <iterator>
+#include <atomic>
+#include <bit>
 #include <iostream>
+#include <stdexcept>
 #include <string>
 #include <cassert>
+#include <thread>
+#include <vector>
 
 void grow_test() {
     HashTable<int, std::string, 2> table;
@@ -14,23 +34,154 @@ void grow_test() {
     // Trigger a grow operation
     table.insert(6, "six");
     table.insert(7, "seven");
+
+    for (int i = 1; i <= 7; ++i) {
+        assert(table.get(i).has_value());
+    }
+    assert(table.get(3)->get() == "three");
+    assert(table.size() == 7);
+}
+
+template <typename Capacity>
+void check_incremental_grow() {
+    HashTable<int, int, 3, std::hash<int>, std::equal_to<int>, Capacity> table;
+    bool saw_migration = false;
+    size_t grows = 0;
+
+    for (int i = 0; i < 5000; ++i) {
+        size_t buckets = table.bucket_count();
+        table.insert(i, i * 2);
+        grows += table.bucket_count() != buckets;
+        saw_migration |= table.is_migrating();
+
+        // Everything stays reachable while old buckets are being moved
+        assert(table.get(i)->get() == i * 2);
+        int older = i / 2;
+        assert(table.get(older).has_value() == (older % 3 != 0 || older == i));
+        if (older % 3 != 0) assert(table.get(older)->get() == older * 2);
+        if (i % 3 == 0) {
+            assert(table.erase(i));
+            assert(!table.get(i));
+        }
+    }
+    assert(saw_migration);
+    assert(grows > 5);
+
+    for (int i = 0; i < 5000; ++i) {
+        auto result = table.get(i);
+        assert(result.has_value() == (i % 3 != 0));
+        if (result) assert(result->get() == i * 2);
+    }
+    assert(table.size() == 5000 - 1667);
+
+    table.finish_migration();
+    assert(!table.is_migrating());
+    assert(table.get(4999)->get() == 9998);
 }
 
+void testIncrementalGrow() {
+    check_incremental_grow<PowerOfTwoCapacity>();
+    check_incremental_grow<FastRangeCapacity>();
 
+    // Masked capacities stay powers of two once the heap tier exists
+    HashTable<int, int, 5> table;
+    for (int i = 0; i < 100; ++i) table.insert(i, i);
+    assert(std::has_single_bit(table.bucket_count()));
+    std::cout << "Incremental grow test passed.\n";
+}
 
-// Global constexpr table
-auto global_table = HashTable<int, std::string, 5>::from_nice_pairs({
+void testGrowDuringMigration() {
+    // Each grow() lands partway through the previous migration, after an
+    // insert has moved one batch, so it finishes that migration from a
+    // nonzero position.
+    HashTable<int, int, 3> table;
+    int next = 0;
+    for (int round = 0; round < 2; ++round) {
+        do {
+            table.insert(next, next);
+            ++next;
+        } while (!table.is_migrating());
+        table.grow();
+    }
+    table.finish_migration();
+    assert(!table.is_migrating());
+    assert(table.size() == static_cast<size_t>(next));
+    for (int i = 0; i < next; ++i) assert(table.get(i)->get() == i);
+    std::cout << "Grow during migration test passed.\n";
+}
+
+
+
+// Global compile-time table: constant-initialized, no dynamic initializer,
+// and const so it is emitted into read-only data
+constinit const auto global_table = StaticHashTable<int, std::string_view, 5>::from_nice_pairs({
     {1, "one"},
     {2, "two"},
     {3, "three"}
 });
 
+// The same kind of table used entirely inside constant expressions
+constexpr auto constexpr_table = StaticHashTable<std::string_view, int, 16>::from_nice_pairs({
+    {"one", 1},
+    {"two", 2},
+    {"three", 3}
+});
+static_assert(constexpr_table.get("two")->get() == 2);
+static_assert(!constexpr_table.contains("four"));
+static_assert(constexpr_table.size() == 3);
+
+// Minimal perfect hash: as many slots as keys, and no collision to avoid by hand
+constexpr auto perfect_table = PerfectHashTable<std::string_view, int, 6>::from_nice_pairs({
+    {"one", 1},
+    {"two", 2},
+    {"three", 3},
+    {"four", 4},
+    {"five", 5},
+    {"six", 6}
+});
+static_assert(perfect_table.get("four")->get() == 4);
+static_assert(perfect_table.get("six")->get() == 6);
+static_assert(!perfect_table.contains("seven"));
+static_assert(perfect_table.size() == perfect_table.capacity());
+
+constexpr std::array<std::pair<int, int>, 256> squares() {
+    std::array<std::pair<int, int>, 256> pairs{};
+    for (int i = 0; i < 256; ++i) pairs[i] = {i * 7 + 3, i * i};
+    return pairs;
+}
+
+constexpr auto perfect_squares = PerfectHashTable<int, int, 256>::from_nice_pairs(squares());
+
+void testPerfectHashTable() {
+    for (int i = 0; i < 256; ++i) {
+        auto result = perfect_squares.get(i * 7 + 3);
+        assert(result && result->get() == i * i);
+    }
+    int misses = 0;
+    for (int k = -1000; k < 0; ++k) misses += !perfect_squares.contains(k);
+    assert(misses == 1000);
+    std::cout << "Perfect hash table test passed.\n";
+}
+
 void testGlobalTable() {
     auto result = global_table.get(2);
     assert(result && result->get() == "two");
+    assert(!global_table.get(4));
     std::cout << "Global table test passed.\n";
 }
 
+void testNicePairs() {
+    auto table = HashTable<int, std::string, 7>::from_nice_pairs({
+        {1, "one"},
+        {2, "two"},
+        {3, "three"}
+    });
+
+    auto result = table.get(3);
+    assert(result && result->get() == "three");
+    std::cout << "Nice pairs test passed.\n";
+}
+
 void testHashTable() {
     auto table = HashTable<int, std::string, 5>::from_pairs({
         {1, "one"},
@@ -44,10 +195,1497 @@ void testHashTable() {
     std::cout << "Dynamic table test passed.\n";
 }
 
+// Sends every key to the same bucket, so all of them chain behind one
+// inline base entry.
+struct ConstantHash {
+    size_t operator()(int) const { return 0; }
+};
+
+void testCompactBaseTier() {
+    // Base slots are bare {key, value} pairs plus one occupancy bit.
+    static_assert(sizeof(HashTable<int, int, 1024>) < 1024 * (sizeof(int) * 2 + 1));
+
+    HashTable<int, std::string, 8, ConstantHash> chained;
+    for (int i = 0; i < 20; ++i) chained.insert(i, std::to_string(i));
+    chained.finish_migration();
+    assert(chained.erase(0));  // inline entry, replaced by its successor
+    assert(chained.erase(19) && !chained.erase(19));
+    for (int i = 1; i < 19; ++i) assert(chained.get(i)->get() == std::to_string(i));
+    assert(!chained.contains(0) && chained.size() == 18);
+
+    HashTable<int, std::string, 8> table;
+    for (int i = 0; i < 100; ++i) table.insert(i, std::to_string(i));
+    for (int i = 0; i < 100; i += 2) assert(table.erase(i));
+
+    HashTable<int, std::string, 8> moved(std::move(table));
+    assert(table.size() == 0 && !table.contains(1));
+    table.insert(1, "again");  // a moved-from table is empty and usable
+    assert(table.get(1)->get() == "again");
+
+    HashTable<int, std::string, 8> assigned;
+    assigned.insert(7, "seven");
+    assigned = std::move(moved);
+    assert(assigned.size() == 50 && !moved.contains(1));
+    for (int i = 1; i < 100; i += 2) assert(assigned.get(i)->get() == std::to_string(i));
+    std::cout << "Compact base tier test passed.\n";
+}
+
+void testFromRange() {
+    std::vector<std::pair<int, std::string>> pairs;
+    for (int i = 0; i < 5000; ++i) pairs.emplace_back(i, std::to_string(i));
+    pairs.emplace_back(42, "duplicate");  // the first pair wins
+
+    auto table = HashTable<int, std::string, 16>::from_range(pairs.begin(), pairs.end());
+    assert(table.size() == 5000 && !table.is_migrating());
+    assert(table.size() <= 0.7 * table.bucket_count());
+    assert(table.get(42)->get() == "42");
+    for (int i = 0; i < 5000; ++i) assert(table.get(i)->get() == std::to_string(i));
+
+    // Block nodes can be erased, and survive later growth and moves.
+    for (int i = 0; i < 5000; i += 3) assert(table.erase(i));
+    for (int i = 5000; i < 20000; ++i) table.insert(i, std::to_string(i));
+    auto moved = std::move(table);
+    moved.finish_migration();
+    for (int i = 0; i < 20000; ++i) assert(moved.contains(i) == (i >= 5000 || i % 3 != 0));
+
+    // Every key in one bucket: the whole chain comes from the block.
+    auto chained = HashTable<int, std::string, 8, ConstantHash>::from_range(pairs.begin(), pairs.begin() + 100);
+    assert(chained.size() == 100 && chained.get(99)->get() == "99");
+
+    // reserve() jumps straight to the final capacity.
+    HashTable<int, int, 16> reserved;
+    reserved.reserve(1000);
+    const size_t buckets = reserved.bucket_count();
+    for (int i = 0; i < 1000; ++i) reserved.insert(i, i);
+    assert(reserved.bucket_count() == buckets);
+    std::cout << "From range test passed.\n";
+}
+
+template <typename Table>
+void check_grow_parallel(size_t n) {
+    Table table;
+    for (size_t i = 0; i < n; ++i) table.insert(static_cast<int>(i), static_cast<int>(i) * 3);
+    table.finish_migration();
+    const size_t buckets = table.bucket_count();
+    table.grow_parallel(4);
+    assert(!table.is_migrating() && table.bucket_count() > buckets && table.size() == n);
+    for (size_t i = 0; i < n; ++i) assert(table.get(static_cast<int>(i))->get() == static_cast<int>(i) * 3);
+    assert(!table.contains(static_cast<int>(n)));
+    assert(table.erase(0) && table.size() == n - 1);
+}
+
+void testParallelBuild() {
+    // Enough entries for every worker; keys repeat so the first pair must win.
+    std::vector<std::pair<int, int>> pairs;
+    for (int i = 0; i < 200000; ++i) pairs.emplace_back(i % 150000, i);
+
+    auto serial = HashTable<int, int, 64>::from_range(pairs.begin(), pairs.end());
+    auto parallel = HashTable<int, int, 64>::from_range_parallel(pairs.begin(), pairs.end(), 4);
+    assert(parallel.size() == 150000 && parallel.bucket_count() == serial.bucket_count());
+    for (int i = 0; i < 150000; ++i) assert(parallel.get(i)->get() == i && serial.get(i)->get() == i);
+    assert(!parallel.contains(150000));
+
+    // Three workers split the buckets unevenly; each partition must still
+    // own whole words of the base-slot bitmap.
+    std::vector<std::pair<uint64_t, uint64_t>> wide;
+    for (uint64_t i = 0; i < 60000; ++i) wide.emplace_back(i, i * 7);
+    auto three = HashTable<uint64_t, uint64_t, 1 << 16>::from_range_parallel(wide.begin(), wide.end(), 3);
+    assert(three.size() == wide.size());
+    for (const auto& [k, v] : wide) assert(three.get(k)->get() == v);
+
+    // More workers than entries falls back to fewer workers.
+    auto small = HashTable<int, int, 8>::from_range_parallel(pairs.begin(), pairs.begin() + 10, 16);
+    assert(small.size() == 10 && small.get(9)->get() == 9);
+
+    check_grow_parallel<HashTable<int, int, 64>>(100000);
+    check_grow_parallel<HashTable<int, int, 64>>(40);
+    // With fastrange, base entries move to other base slots as well.
+    check_grow_parallel<HashTable<int, int, 1024, std::hash<int>, std::equal_to<int>, FastRangeCapacity>>(100000);
+    std::cout << "Parallel build test passed.\n";
+}
+
+void testTableStats() {
+    using Counted = HashTable<int, int, 16, std::hash<int>, std::equal_to<int>, PowerOfTwoCapacity,
+                              std::allocator<std::pair<const int, int>>, TableStats>;
+    Counted table;
+    for (int i = 0; i < 100; ++i) table.insert(i, i);
+    for (int i = 0; i < 150; ++i) table.get(i);
+    assert(table.contains(5) && !table.contains(-5));
+
+    auto stats = table.stats();
+    uint64_t inserts = 0, lookups = 0;
+    for (uint64_t n : stats.insert_probes) inserts += n;
+    for (uint64_t n : stats.lookup_probes) lookups += n;
+    assert(inserts == 100 && lookups == 152);
+    assert(stats.hits == 101 && stats.misses == 51);
+    assert(stats.grows > 0 && stats.size == 100 && stats.bucket_count == table.bucket_count());
+    assert(stats.load_factor == 100.0 / static_cast<double>(table.bucket_count()));
+    assert(stats.node_bytes > 0 && stats.bucket_bytes > 0);
+
+    bool exported = false;
+    stats.for_each_metric([&](const std::string& name, double value) {
+        if (name == "hits") exported = value == 101;
+    });
+    assert(exported);
+
+    // Node bytes follow the live nodes and move with the table; emptying
+    // the table shrinks it, which counts as a resize.
+    for (int i = 0; i < 100; ++i) table.erase(i);
+    table.finish_migration();
+    assert(table.stats().node_bytes == 0);
+    assert(table.stats().grows > stats.grows);
+    table.insert(1, 1);
+    const uint64_t resizes = table.stats().grows;
+    Counted moved(std::move(table));
+    assert(moved.stats().grows == resizes && table.stats().bucket_bytes == 0);
+
+    // Without stats, stats() still reports size and load.
+    HashTable<int, int, 16> plain;
+    plain.insert(1, 1);
+    assert(plain.stats().size == 1 && plain.stats().hits == 0);
+    std::cout << "Table stats test passed.\n";
+}
+
+// Value type that counts how often it is copied
+struct Tracked {
+    static inline int copies = 0;
+    std::string text;
+
+    explicit Tracked(std::string t) : text(std::move(t)) {}
+    Tracked(const char* a, const char* b) : text(std::string(a) + b) {}
+    Tracked(const Tracked& other) : text(other.text) { ++copies; }
+    Tracked(Tracked&&) noexcept = default;
+    Tracked& operator=(const Tracked& other) { text = other.text; ++copies; return *this; }
+    Tracked& operator=(Tracked&&) noexcept = default;
+};
+
+template <typename Table>
+void check_insert_apis() {
+    Table table;
+    Tracked::copies = 0;
+
+    assert(table.insert(1, Tracked("one")).second);
+    assert(!table.insert(1, Tracked("uno")).second);  // existing key wins
+    assert(table.get(1)->get().text == "one");
+
+    auto [value, inserted] = table.try_emplace(2, "tw", "o");
+    assert(inserted && value.text == "two");
+
+    std::string kept = "kept";
+    assert(!table.try_emplace(2, std::move(kept)).second);
+    assert(kept == "kept");  // no construction, nothing moved from
+
+    assert(!table.insert_or_assign(2, Tracked("deux")).second);
+    assert(table.get(2)->get().text == "deux");
+    assert(table.insert_or_assign(3, Tracked("three")).second);
+
+    assert(table.emplace(std::piecewise_construct, std::forward_as_tuple(4),
+                         std::forward_as_tuple("fo", "ur")).second);
+    assert(!table.emplace(4, Tracked("vier")).second);
+    assert(table.get(4)->get().text == "four");
+
+    for (int i = 5; i < 2000; ++i) table.try_emplace(i, std::to_string(i));
+    assert(table.size() == 1999);
+    assert(table.get(1999)->get().text == "1999");
+    assert(Tracked::copies == 0);
+
+}
+
+void testInsertApis() {
+    check_insert_apis<HashTable<int, Tracked, 4>>();
+    check_insert_apis<OpenHashTable<int, Tracked, 4>>();
+
+    // Move-only values work through the rvalue overloads
+    HashTable<int, std::unique_ptr<int>, 4> owned;
+    owned.insert(1, std::make_unique<int>(10));
+    owned.try_emplace(2, new int(20));
+    assert(*owned.get(2)->get() == 20);
+    OpenHashTable<int, std::unique_ptr<int>, 4> open_owned;
+    open_owned.insert(1, std::make_unique<int>(10));
+    assert(*open_owned.get(1)->get() == 10);
+
+    // A value constructor that throws leaves size() as it was, in a base
+    // slot and in a heap node.
+    struct Checked {
+        int v;
+        explicit Checked(int x) : v(x) {
+            if (x < 0) throw std::invalid_argument("negative");
+        }
+    };
+    HashTable<int, Checked, 4> checked;
+    for (int i = 0; i < 100; ++i) {
+        try {
+            checked.try_emplace(i, i % 2 ? -1 : i);
+        } catch (const std::invalid_argument&) {
+        }
+        assert(checked.size() == static_cast<size_t>(i / 2 + 1));
+    }
+    assert(!checked.contains(1) && checked.get(98)->get().v == 98);
+    std::cout << "Insert API test passed.\n";
+}
+
+// Hasher that counts calls, to show lookups never go through std::string
+struct CountingStringHash : hash_policy::StringHash {
+    static inline int calls = 0;
+    size_t operator()(std::string_view key) const {
+        ++calls;
+        return hash_policy::StringHash::operator()(key);
+    }
+};
+
+template <typename Table>
+void check_transparent_lookup() {
+    Table table = Table::from_pairs({
+        {"alpha", 1},
+        {"beta", 2},
+        {"a much longer key that does not fit in SSO", 3}
+    });
+
+    std::string_view view = "beta";
+    const char* cstr = "alpha";
+    assert(table.get(view)->get() == 2);
+    assert(table.get(cstr)->get() == 1);
+    assert(table.get(std::string_view("a much longer key that does not fit in SSO"))->get() == 3);
+    assert(table.contains("alpha"));
+    assert(!table.contains(std::string_view("gamma")));
+    assert(table.get(std::string("beta"))->get() == 2);
+
+    table.get(view)->get() = 20;
+    assert(table.get("beta")->get() == 20);
+    assert(table.erase(view));
+    assert(!table.erase("beta"));
+    assert(table.size() == 2);
+}
+
+void testTransparentLookup() {
+    check_transparent_lookup<HashTable<std::string, int, 4>>();
+    check_transparent_lookup<OpenHashTable<std::string, int, 4>>();
+    static_assert(hash_policy::is_transparent_v<hash_policy::StringHash, std::equal_to<>>);
+    static_assert(!hash_policy::is_transparent_v<std::hash<int>, std::equal_to<int>>);
+
+    HashTable<std::string, int, 4, CountingStringHash, std::equal_to<>> table;
+    table.insert("key", 1);
+    CountingStringHash::calls = 0;
+    assert(table.get(std::string_view("key"))->get() == 1);
+    assert(CountingStringHash::calls == 1);
+    std::cout << "Transparent lookup test passed.\n";
+}
+
+// Key comparisons, counted the same way
+struct CountingStringEqual : std::equal_to<> {
+    static inline int calls = 0;
+    template <typename A, typename B>
+    bool operator()(const A& a, const B& b) const {
+        ++calls;
+        return std::equal_to<>::operator()(a, b);
+    }
+};
+
+template <typename StoredHash, typename Capacity>
+void check_stored_hash() {
+    using Table = HashTable<std::string, int, 8, CountingStringHash, CountingStringEqual, Capacity,
+                            std::allocator<std::pair<const std::string, int>>, NoTableStats, StoredHash>;
+    auto key = [](int i) { return "a key too long for the small string buffer #" + std::to_string(i); };
+    std::vector<std::string> keys;
+    for (int i = 0; i < 5000; ++i) keys.push_back(key(i));
+
+    CountingStringHash::calls = CountingStringEqual::calls = 0;
+    Table table;
+    for (int i = 0; i < 5000; ++i) table.insert(keys[i], i);
+    table.grow_parallel(2);
+    table.rehash(100000);
+    table.finish_migration();
+    for (int i = 0; i < 5000; i += 2) assert(table.erase(keys[i]));  // shrinks
+    table.finish_migration();
+    const int inserts_and_erases = 5000 + 2500;
+    if constexpr (StoredHash::enabled) {
+        // Every key was hashed once per call, however often the table
+        // resized, and compared (almost) only with itself.
+        assert(CountingStringHash::calls == inserts_and_erases);
+        assert(CountingStringEqual::calls <= 2500 + 2);
+    } else {
+        assert(CountingStringHash::calls > inserts_and_erases);
+    }
+
+    CountingStringEqual::calls = 0;
+    for (int i = 0; i < 5000; ++i) assert(table.contains(keys[i]) == (i % 2 == 1));
+    if constexpr (StoredHash::enabled) assert(CountingStringEqual::calls <= 2500 + 2);
+
+    auto built = Table::from_range(table.begin(), table.end());
+    for (int i = 1; i < 5000; i += 2) assert(built.get(keys[i])->get() == i);
+    assert(built.size() == 2500 && !built.contains(keys[0]));
+}
+
+void testStoredHash() {
+    static_assert(sizeof(HashEntry<int, int>) == 2 * sizeof(int));
+    static_assert(sizeof(HashEntry<int, int, hash_policy::StoreFingerprint>) == 3 * sizeof(int));
+
+    check_stored_hash<hash_policy::NoStoredHash, PowerOfTwoCapacity>();
+    check_stored_hash<hash_policy::StoreHash, PowerOfTwoCapacity>();
+    check_stored_hash<hash_policy::StoreFingerprint, PowerOfTwoCapacity>();
+    check_stored_hash<hash_policy::StoreFingerprint, FastRangeCapacity>();
+
+    // The fingerprint survives a round trip, and the shard bits of its
+    // widened hash are mixed rather than a copy of the bucket bits.
+    using Fingerprint = hash_policy::StoreFingerprint;
+    int shard_copies = 0;
+    for (uint64_t i = 0; i < 4096; ++i) {
+        const uint64_t h = Fingerprint::table_hash(hash_policy::mix(i));
+        assert(Fingerprint::load(Fingerprint::store(h)) == h);
+        if (PowerOfTwoCapacity::partition(h, 64) == ((h & 0xffffffff) >> 26)) ++shard_copies;
+    }
+    assert(shard_copies < 4096 / 16);
+
+    // Base entries keep their hash when replaced by their successor or
+    // moved to and from nodes.
+    HashTable<int, int, 8, std::hash<int>, std::equal_to<int>, FastRangeCapacity,
+              std::allocator<std::pair<const int, int>>, NoTableStats, hash_policy::StoreFingerprint> ints;
+    for (int i = 0; i < 2000; ++i) ints.insert(i, -i);
+    for (int i = 0; i < 2000; i += 3) assert(ints.erase(i));
+    for (int i = 0; i < 2000; ++i) assert(ints.contains(i) == (i % 3 != 0));
+    int sum = 0;
+    for (const auto& [key, value] : ints) sum += key + value;
+    assert(sum == 0);
+    std::cout << "Stored hash test passed.\n";
+}
+
+// A hash that must never run, for direct tables
+struct UnusedHash {
+    size_t operator()(int) const {
+        assert(false && "direct tables do not hash");
+        return 0;
+    }
+};
+
+enum class Channel : uint8_t { red, green, blue, alpha };
+
+struct Blob {
+    std::array<char, 200> bytes{};
+    int id = 0;
+    Blob() = default;
+    explicit Blob(int i) : id(i) {}
+};
+
+void testTableLayout() {
+    static_assert(HashTable<int, int, 16>::table_layout() == TableLayout::inline_base);
+    static_assert(HashTable<std::string, std::string, 16>::table_layout() == TableLayout::inline_base);
+    static_assert(HashTable<int, Blob, 16>::table_layout() == TableLayout::node_base);
+    static_assert(HashTable<int, std::atomic<int>, 16>::table_layout() == TableLayout::node_base);
+    static_assert(HashTable<uint8_t, int, 256>::table_layout() == TableLayout::direct);
+    static_assert(HashTable<uint8_t, int, 128>::table_layout() == TableLayout::inline_base);
+    static_assert(HashTable<Channel, int, 256>::table_layout() == TableLayout::direct);
+    // Empty node_base slots are a pointer each, not a whole entry.
+    static_assert(sizeof(HashTable<int, Blob, 64>) < 64 * sizeof(Blob) / 4);
+    static_assert(direct_index(int8_t{-1}) == 255 && direct_index(Channel::blue) == 2);
+
+    // Direct: every key value has its slot, no hashing and no growth.
+    HashTable<int8_t, int, 256, UnusedHash> direct;
+    for (int k = -128; k < 128; ++k) assert(direct.insert(static_cast<int8_t>(k), k).second);
+    assert(direct.size() == 256 && direct.bucket_count() == 256 && !direct.is_migrating());
+    assert(!direct.insert(int8_t{5}, 0).second && direct.get(int8_t{-7})->get() == -7);
+    direct.reserve(1000);
+    direct.grow();
+    assert(direct.bucket_count() == 256);
+    for (int k = -128; k < 128; k += 2) assert(direct.erase(static_cast<int8_t>(k)));
+    for (int k = -128; k < 128; ++k) assert(direct.contains(static_cast<int8_t>(k)) == (k % 2 != 0));
+    int entries = 0;
+    for (const auto& [key, value] : direct) entries += key == value;
+    assert(entries == 128);
+
+    HashTable<Channel, std::string, 256> channels;
+    channels.insert(Channel::green, "g");
+    assert(channels.get(Channel::green)->get() == "g" && !channels.contains(Channel::red));
+
+    // Node base: non-movable values are built in place, and entries keep
+    // their address through growth and migration.
+    HashTable<int, std::atomic<int>, 8> counters;
+    counters.try_emplace(0, 100);
+    std::atomic<int>* first = &counters.get(0)->get();
+    for (int i = 1; i < 5000; ++i) counters.try_emplace(i, i);
+    assert(counters.is_migrating() || counters.bucket_count() > 8);
+    counters.finish_migration();
+    assert(&counters.get(0)->get() == first && first->load() == 100);
+    counters.for_each([](const int&, std::atomic<int>& value) { value.fetch_add(1); });
+    for (int i = 1; i < 5000; ++i) assert(counters.get(i)->get().load() == i + 1);
+    for (int i = 0; i < 5000; i += 2) assert(counters.erase(i));
+    counters.shrink_to_fit();
+    assert(counters.size() == 2500 && !counters.contains(0) && counters.get(4999)->get() == 5000);
+
+    std::vector<std::pair<int, Blob>> pairs;
+    for (int i = 0; i < 3000; ++i) pairs.emplace_back(i, Blob(i));
+    auto blobs = HashTable<int, Blob, 64>::from_range_parallel(pairs.begin(), pairs.end(), 2);
+    blobs.grow_parallel(2);
+    std::vector<int> keys(3000);
+    for (int i = 0; i < 3000; ++i) keys[i] = i;
+    std::vector<const Blob*> found(3000);
+    std::as_const(blobs).get_batch(keys, found);
+    for (int i = 0; i < 3000; ++i) assert(found[i] && found[i]->id == i);
+    auto moved = std::move(blobs);
+    assert(moved.size() == 3000 && blobs.size() == 0 && moved.get(1234)->get().id == 1234);
+    auto nice = HashTable<int, Blob, 16>::from_nice_pairs({{1, Blob(1)}, {2, Blob(2)}});
+    assert(nice.get(2)->get().id == 2);
+    std::cout << "Table layout test passed.\n";
+}
+
+template <typename Table, typename Make>
+void check_table_with_hasher(Make make) {
+    Table table;
+    for (int i = 0; i < 1000; ++i) table.insert(make(i), i);
+    for (int i = 0; i < 1000; ++i) assert(table.get(make(i))->get() == i);
+    assert(!table.contains(make(1000)));
+}
+
+void testBuiltInHashers() {
+    using namespace hash_policy;
+
+    // Reference values from the xxHash library (XXH3_64bits_withSeed).
+    static_assert(xxh3(std::string_view("")) == 0x2d06800538d394c2ull);
+    static_assert(xxh3(std::string_view("abc")) == 0x78af5f94892f3950ull);
+    static_assert(xxh3(std::string_view("hello")) == 0x9555e8555c62dcfdull);
+    static_assert(xxh3(std::string_view("hello"), 42) == 0xbafa072f07db7937ull);
+    static_assert(xxh3(std::string_view("the quick brown fox jumps over the lazy dog")) == 0xe4541a9cacf545aaull);
+    static_assert(xxh3(uint64_t{42}) == 0xd5a6f8c838df27c8ull);
+    static_assert(Xxh3Hash{}(42) == xxh3(uint64_t{42}));
+    const std::string medium(200, 'y'), long_key(1000, 'x');
+    assert(xxh3(medium) == 0x78c5ae5cf7b1237eull);
+    assert(xxh3(long_key) == 0xc0a4877b962cba82ull);
+    assert(xxh3(long_key, 7) == 0xa6b046c257309584ull);
+    const uint64_t forty_two = 42;
+    if constexpr (std::endian::native == std::endian::little) {
+        assert(xxh3(std::string_view(reinterpret_cast<const char*>(&forty_two), 8)) == xxh3(forty_two));
+    }
+
+    // The SSE4.2 instruction's results; the runtime call takes the
+    // instruction when compiled with it and must agree with the table.
+    static_assert(crc32c(0u, uint64_t{0x0123456789abcdefull}) == 0xe9986aa9u);
+    static_assert(crc32c(0u, uint32_t{42}) == 0x9e0654ecu);
+    volatile uint64_t runtime_key = 0x0123456789abcdefull;
+    assert(crc32c(0u, static_cast<uint64_t>(runtime_key)) == 0xe9986aa9u);
+    static_assert(Crc32cHash{}(1) != Crc32cHash{}(uint64_t{1} << 32));
+
+    // Compile-time and runtime hashing agree.
+    constexpr uint64_t compile_time = WyHash{}(std::string_view("key"));
+    const std::string key = "key";
+    assert(WyHash{}(key) == compile_time);
+    assert(Xxh3Hash{}(key) == xxh3(std::string_view("key")));
+
+    static_assert(is_avalanching_v<WyHash>);
+    static_assert(is_avalanching_v<Xxh3Hash>);
+    static_assert(!is_avalanching_v<Crc32cHash>);
+    static_assert(!is_avalanching_v<std::hash<int>>);
+    static_assert(finalize<WyHash>(5) == 5);
+    static_assert(finalize<std::hash<int>>(5) == mix(5));
+
+    auto int_key = [](int i) { return i * 7919; };
+    auto string_key = [](int i) { return "key" + std::to_string(i); };
+    check_table_with_hasher<HashTable<int, int, 8, Crc32cHash>>(int_key);
+    check_table_with_hasher<HashTable<int, int, 8, Xxh3Hash>>(int_key);
+    check_table_with_hasher<HashTable<std::string, int, 8, Xxh3Hash>>(string_key);
+    check_table_with_hasher<OpenHashTable<int, int, 8, WyHash>>(int_key);
+    check_table_with_hasher<OpenHashTable<std::string, int, 8, Xxh3Hash>>(string_key);
+    std::cout << "Built-in hashers test passed.\n";
+}
+
+constexpr auto overlay_defaults = PerfectHashTable<std::string_view, int, 4>::from_nice_pairs({
+    {"red", 1}, {"green", 2}, {"blue", 3}, {"alpha", 4}});
+
+// WyHash counting its calls at run time.
+struct CountedWyHash {
+    using is_avalanching = std::true_type;
+    static inline size_t calls = 0;
+
+    constexpr uint64_t operator()(int key) const {
+        if (!std::is_constant_evaluated()) ++calls;
+        return hash_policy::WyHash{}(key);
+    }
+};
+
+constexpr auto counted_squares = PerfectHashTable<int, int, 256, CountedWyHash>::from_nice_pairs(squares());
+
+void testOverlayHashTable() {
+    OverlayHashTable<std::string_view, int, 4> colors(overlay_defaults);
+    assert(colors.size() == 4 && colors.overlay_entries() == 0);
+    assert(colors.get("green")->get() == 2);
+    assert(!colors.contains("cyan"));
+
+    // Inserts never touch the snapshot.
+    std::string cyan = "cyan";
+    assert(colors.insert(cyan, 5));
+    cyan = "overwritten";
+    assert(colors.get("cyan")->get() == 5);
+    assert(!colors.insert("red", 10));
+    assert(colors.get("red")->get() == 1);
+    assert(!colors.insert_or_assign("red", 10));
+    assert(colors.get("red")->get() == 10);
+    assert(overlay_defaults.get("red")->get() == 1);
+    assert(colors.size() == 5 && colors.overlay_entries() == 2);
+
+    // Erased snapshot keys stay erased until inserted again.
+    assert(colors.erase("blue"));
+    assert(!colors.contains("blue"));
+    assert(!colors.erase("blue"));
+    assert(colors.size() == 4);
+    assert(colors.insert("blue", 30));
+    assert(colors.get("blue")->get() == 30);
+    assert(colors.erase("cyan") && !colors.contains("cyan"));
+    assert(!colors.erase("cyan"));
+    assert(colors.size() == 4);
+
+    colors.reset();
+    assert(colors.size() == 4 && colors.overlay_entries() == 0);
+    assert(colors.get("red")->get() == 1 && colors.get("blue")->get() == 3);
+
+    // Many overlay keys saturate the filter; lookups stay exact.
+    OverlayHashTable<int, int, 256> squares(perfect_squares);
+    for (int i = 0; i < 2000; ++i) assert(squares.insert(10000 + i, -i));
+    for (int i = 0; i < 256; i += 2) assert(squares.erase(i * 7 + 3));
+    for (int i = 0; i < 256; ++i) {
+        auto value = squares.get(i * 7 + 3);
+        assert(value.has_value() == (i % 2 == 1));
+        if (value) assert(value->get() == i * i);
+    }
+    for (int i = 0; i < 2000; ++i) assert(squares.get(10000 + i)->get() == -i);
+    assert(squares.size() == 128 + 2000);
+
+    // A lookup that reaches the overlay still hashes the key only once.
+    OverlayHashTable<int, int, 256, CountedWyHash> counted(counted_squares);
+    for (int i = 0; i < 100; ++i) counted.insert(10000 + i, i);
+    CountedWyHash::calls = 0;
+    assert(counted.get(10050)->get() == 50 && counted.get(3)->get() == 0);
+    assert(CountedWyHash::calls == 2);
+    std::cout << "Overlay hash table test passed.\n";
+}
+
+// HeapMemory that counts its calls.
+struct CountingMemory {
+    size_t* calls;
+
+    void* allocate(size_t bytes, size_t alignment) const {
+        ++*calls;
+        return HeapMemory::allocate(bytes, alignment);
+    }
+
+    void deallocate(void* p, size_t bytes, size_t alignment) const noexcept {
+        HeapMemory::deallocate(p, bytes, alignment);
+    }
+};
+
+// HeapMemory that fails once its budget of calls is spent.
+struct LimitedMemory {
+    size_t* budget;
+
+    void* allocate(size_t bytes, size_t alignment) const {
+        if (*budget == 0) throw std::bad_alloc();
+        --*budget;
+        return HeapMemory::allocate(bytes, alignment);
+    }
+
+    void deallocate(void* p, size_t bytes, size_t alignment) const noexcept {
+        HeapMemory::deallocate(p, bytes, alignment);
+    }
+};
+
+void testSlabAllocator() {
+    SlabAllocator<uint64_t, 4> alloc;
+    uint64_t* a = alloc.allocate(1);
+    uint64_t* b = alloc.allocate(1);
+    assert(a != b);
+    alloc.deallocate(a, 1);
+    assert(alloc.allocate(1) == a);  // recycled through the free list
+
+    SlabAllocator<uint64_t, 4> copy = alloc;
+    assert(copy == alloc);
+    assert((SlabAllocator<uint64_t, 4>() != alloc));
+    copy.deallocate(b, 1);
+    assert(alloc.allocate(1) == b);  // copies share one arena
+
+    uint64_t* many = alloc.allocate(10);
+    many[9] = 1;
+    alloc.deallocate(many, 10);
+
+    using Table = HashTable<int, std::string, 4, std::hash<int>, std::equal_to<int>, PowerOfTwoCapacity,
+                            SlabAllocator<std::pair<const int, std::string>>>;
+    Table table;
+    for (int i = 0; i < 3000; ++i) table.insert(i, std::to_string(i));
+    for (int i = 0; i < 3000; i += 2) assert(table.erase(i));
+    for (int i = 0; i < 3000; i += 2) table.insert(i, "again");
+    for (int i = 0; i < 3000; ++i) {
+        assert(table.get(i)->get() == (i % 2 ? std::to_string(i) : "again"));
+    }
+
+    Table moved = std::move(table);
+    assert(moved.size() == 3000);
+    assert(moved.get(2999)->get() == "2999");
+    table = std::move(moved);
+    assert(table.get(2)->get() == "again");
+
+    // Trivially destructible entries are reclaimed with the arena
+    HashTable<int, int, 4, std::hash<int>, std::equal_to<int>, PowerOfTwoCapacity,
+              SlabAllocator<std::pair<const int, int>>> ints;
+    for (int i = 0; i < 3000; ++i) ints.insert(i, i);
+    assert(ints.get(1234)->get() == 1234);
+
+    // With one base slot, the first bucket arrays are single objects too;
+    // they must not come from a short-lived rebound arena.
+    HashTable<int, int, 1, std::hash<int>, std::equal_to<int>, PowerOfTwoCapacity,
+              SlabAllocator<std::pair<const int, int>>> single;
+    for (int i = 0; i < 100; ++i) single.insert(i, i);
+    for (int i = 0; i < 100; ++i) assert(single.get(i)->get() == i);
+
+    // Tables handed one allocator of their node type share its arena:
+    // destroying one hands its nodes back for the other to reuse.
+    size_t calls = 0;
+    using Counted = SlabAllocator<HashNode<int, int, hash_policy::NoStoredHash>, 64, CountingMemory>;
+    using Shared = HashTable<int, int, 4, std::hash<int>, std::equal_to<int>, PowerOfTwoCapacity, Counted>;
+    const Counted counted(CountingMemory{&calls});
+    Shared survivor(std::hash<int>(), std::equal_to<int>(), counted);
+    survivor.rehash(8192);
+    {
+        Shared doomed(std::hash<int>(), std::equal_to<int>(), counted);
+        for (int i = 0; i < 3000; ++i) doomed.insert(i, i);
+    }
+    const size_t before = calls;
+    for (int i = 0; i < 3000; ++i) survivor.insert(i, -i);
+    assert(calls == before);
+    assert(survivor.get(2999)->get() == -2999);
+    std::cout << "Slab allocator test passed.\n";
+}
+
+void testPageMemory() {
+    for (HugePages huge_pages : {HugePages::off, HugePages::transparent, HugePages::hugetlb}) {
+        for (bool prefault : {false, true}) {
+            const PageMemory memory{huge_pages, prefault};
+            for (size_t bytes : {size_t{100}, PageMemory::mapping_threshold, size_t{3} << 20}) {
+                auto* p = static_cast<unsigned char*>(memory.allocate(bytes, alignof(int)));
+                assert(reinterpret_cast<uintptr_t>(p) % PageMemory::cache_line == 0);
+                p[0] = 1;
+                p[bytes - 1] = 2;
+                memory.deallocate(p, bytes, alignof(int));
+            }
+        }
+    }
+    // Over-aligned requests keep their alignment.
+    const PageMemory memory{HugePages::off, false};
+    void* page_aligned = memory.allocate(size_t{1} << 20, 8192);
+    assert(reinterpret_cast<uintptr_t>(page_aligned) % 8192 == 0);
+    memory.deallocate(page_aligned, size_t{1} << 20, 8192);
+
+    // After reserve, neither table goes back to its memory source.
+    size_t calls = 0;
+    using Nodes = SlabAllocator<std::pair<const int, int>, 64, CountingMemory>;
+    using Chained = HashTable<int, int, 16, std::hash<int>, std::equal_to<int>, PowerOfTwoCapacity, Nodes>;
+    Chained chained(std::hash<int>(), std::equal_to<int>(), Nodes(CountingMemory{&calls}));
+    chained.reserve(5000);
+    const size_t reserved = calls;
+    // Heap buckets, base chains and node chunks for all but the 16 base slots.
+    assert(reserved == 2 + (5000 - 16 + 63) / 64);
+    for (int i = 0; i < 5000; ++i) chained.insert(i, -i);
+    assert(calls == reserved);
+    for (int i = 0; i < 5000; i += 7) assert(chained.get(i)->get() == -i);
+
+    // from_range takes its nodes as one block and reserves no chunks.
+    calls = 0;
+    std::vector<std::pair<int, int>> pairs;
+    for (int i = 0; i < 5000; ++i) pairs.emplace_back(i, -i);
+    auto built = Chained::from_range(pairs.begin(), pairs.end(), Nodes(CountingMemory{&calls}));
+    assert(calls == 3);  // heap buckets, base chains, node block
+    assert(built.size() == 5000 && built.get(4999)->get() == -4999);
+
+    calls = 0;
+    OpenHashTable<int, int, 16, std::hash<int>, std::equal_to<int>, CountingMemory> open(CountingMemory{&calls});
+    open.reserve(5000);
+    const size_t capacity = open.capacity();
+    assert(calls == 6);  // initial arrays and the reserved ones
+    for (int i = 0; i < 5000; ++i) open.insert(i, -i);
+    assert(calls == 6 && open.capacity() == capacity);
+    open.reserve(10);
+    assert(open.capacity() == capacity);
+
+    // Huge, prefaulted slot arrays.
+    OpenHashTable<int, int, 16, std::hash<int>, std::equal_to<int>, PageMemory> huge(
+        PageMemory{HugePages::transparent, true});
+    huge.reserve(200000);
+    for (int i = 0; i < 200000; ++i) huge.insert(i, i * 3);
+    for (int i = 0; i < 200000; i += 999) assert(huge.get(i)->get() == i * 3);
+    auto moved = std::move(huge);
+    assert(moved.size() == 200000 && moved.get(199999)->get() == 599997);
+    std::cout << "Page memory test passed.\n";
+}
+
+// Check a control-byte group against a byte-by-byte scan
+template <typename Group>
+void check_ctrl_group() {
+    uint8_t ctrl[64];
+    uint64_t state = 42;
+    for (int round = 0; round < 1000; ++round) {
+        for (auto& c : ctrl) {
+            state = state * 6364136223846793005ull + 1442695040888963407ull;
+            int r = static_cast<int>(state >> 59);
+            c = r < 4 ? static_cast<uint8_t>(Ctrl::empty)
+              : r < 6 ? static_cast<uint8_t>(Ctrl::deleted)
+              : static_cast<uint8_t>(r & 3);
+        }
+        Group g(ctrl);
+        for (uint8_t tag = 0; tag < 4; ++tag) {
+            int first = -1;
+            for (int i = 0; i < Group::width && first < 0; ++i) {
+                if (ctrl[i] == tag) first = i;
+            }
+            auto match = g.match(tag);
+            assert(static_cast<bool>(match) == (first >= 0));
+            if (match) assert(match.lowest() == first);
+            for (int pos : match) assert(pos < Group::width);
+        }
+        int seen = 0;
+        for (int pos : g.match_empty()) {
+            assert(ctrl[pos] == static_cast<uint8_t>(Ctrl::empty));
+            ++seen;
+        }
+        for (int i = 0; i < Group::width; ++i) seen -= ctrl[i] == static_cast<uint8_t>(Ctrl::empty);
+        assert(seen == 0);
+        for (int pos : g.match_empty_or_deleted()) assert(!is_full(ctrl[pos]));
+    }
+}
+
+void testCtrlGroup() {
+    check_ctrl_group<GroupPortable>();
+    check_ctrl_group<CtrlGroup>();
+    std::cout << "Control group test passed.\n";
+}
+
+void testOpenHashTable() {
+    OpenHashTable<int, std::string, 4> table;
+    for (int i = 0; i < 1000; ++i) {
+        table.insert(i, std::to_string(i));
+    }
+    assert(table.size() == 1000);
+    for (int i = 0; i < 1000; ++i) {
+        auto result = table.get(i);
+        assert(result && result->get() == std::to_string(i));
+    }
+    assert(!table.get(1000));
+
+    // An existing key keeps its value
+    table.insert(7, "seven");
+    assert(table.get(7)->get() == "7");
+
+    for (int i = 0; i < 1000; i += 2) {
+        assert(table.erase(i));
+    }
+    assert(!table.erase(0));
+    assert(table.size() == 500);
+    for (int i = 0; i < 1000; ++i) {
+        assert(table.get(i).has_value() == (i % 2 == 1));
+    }
+
+    // Churn without growing without bound
+    size_t capacity = table.capacity();
+    for (int round = 0; round < 20; ++round) {
+        for (int i = 0; i < 1000; i += 2) table.insert(i + 1000 * (round + 1), "x");
+        for (int i = 0; i < 1000; i += 2) assert(table.erase(i + 1000 * (round + 1)));
+    }
+    assert(table.size() == 500);
+    assert(table.capacity() == capacity);
+
+    auto small = SelectHashTable<int, std::string, 5, TableEngine::open_addressing>::from_pairs({
+        {1, "one"},
+        {6, "six"}
+    });
+    static_assert(std::is_same_v<decltype(small), OpenHashTable<int, std::string, 5>>);
+    static_assert(std::is_same_v<SelectHashTable<int, int, 5>, HashTable<int, int, 5>>);
+    assert(small.get(6)->get() == "six");
+    small.get(6)->get() = "SIX";
+    assert(small.get(6)->get() == "SIX");
+
+    // A full table grows only for a key it does not hold yet, and a grow
+    // that runs out of memory leaves the table as it was.
+    size_t budget = 3;
+    OpenHashTable<int, int, 16, std::hash<int>, std::equal_to<int>, LimitedMemory> limited(LimitedMemory{&budget});
+    const size_t slots = limited.capacity();
+    int next = 0;
+    while (limited.size() < slots - slots / 8) limited.insert(next, next), ++next;
+    for (int i = 0; i < next; ++i) assert(!limited.insert(i, -1).second);
+    assert(limited.capacity() == slots);
+    budget = 2;  // the third array of the new capacity fails
+    try {
+        limited.insert(next, next);
+        assert(false);
+    } catch (const std::bad_alloc&) {
+    }
+    assert(limited.capacity() == slots && limited.size() == static_cast<size_t>(next));
+    for (int i = 0; i < next; ++i) assert(limited.get(i)->get() == i);
+    budget = 3;
+    assert(limited.insert(next, next).second && limited.capacity() == 2 * slots);
+    for (int i = 0; i <= next; ++i) assert(limited.get(i)->get() == i);
+    std::cout << "Open addressing table test passed.\n";
+}
+
+void testShrink() {
+    // Chained: a burst of inserts, then mass erases shrink the heap tier.
+    HashTable<int, int, 16> chained;
+    for (int i = 0; i < 20000; ++i) chained.insert(i, i);
+    const size_t peak = chained.bucket_count();
+    for (int i = 0; i < 20000; ++i) {
+        if (i % 100 != 0) assert(chained.erase(i));
+    }
+    chained.finish_migration();
+    for (int i = 0; i < 20000; ++i) assert(chained.contains(i) == (i % 100 == 0));
+    assert(chained.bucket_count() <= peak / 16);
+    chained.shrink_to_fit();
+    chained.finish_migration();
+    assert(chained.bucket_count() == 512);  // smallest power of two holding 200 at 0.7
+    chained.rehash(5000);
+    assert(chained.bucket_count() == 8192 && chained.get(100)->get() == 100);
+    for (int i = 0; i < 200; ++i) assert(chained.erase(i * 100));
+    chained.finish_migration();
+    assert(chained.size() == 0 && chained.bucket_count() == 16);
+
+    // Hysteresis: oscillating around a threshold resizes only once.
+    using Counted = HashTable<int, int, 16, std::hash<int>, std::equal_to<int>, PowerOfTwoCapacity,
+                              std::allocator<std::pair<const int, int>>, TableStats>;
+    Counted counted;
+    for (int i = 0; i < 1000; ++i) counted.insert(i, i);
+    for (int i = 100; i < 1000; ++i) counted.erase(i);
+    counted.finish_migration();
+    const uint64_t resizes = counted.stats().grows;
+    for (int round = 0; round < 50; ++round) {
+        for (int i = 100; i < 130; ++i) counted.insert(i, i);
+        for (int i = 100; i < 130; ++i) counted.erase(i);
+    }
+    assert(counted.stats().grows == resizes);
+
+    // Open addressing: backward-shift deletion keeps every key reachable
+    // through heavy churn, and the table shrinks after mass erases.
+    OpenHashTable<int, int, 16> open;
+    std::vector<bool> live(4096);
+    uint64_t state = 1;
+    for (int op = 0; op < 200000; ++op) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        const int key = static_cast<int>((state >> 33) % live.size());
+        if ((state >> 20) & 1) {
+            assert(open.insert(key, key).second == !live[key]);
+            live[key] = true;
+        } else {
+            assert(open.erase(key) == live[key]);
+            live[key] = false;
+        }
+    }
+    for (int key = 0; key < static_cast<int>(live.size()); ++key) {
+        assert(open.contains(key) == live[key]);
+    }
+    for (int key = 0; key < static_cast<int>(live.size()); ++key) {
+        if (key % 64 != 0 && live[key]) open.erase(key);
+    }
+    assert(open.capacity() <= 256);
+    for (int key = 0; key < static_cast<int>(live.size()); ++key) {
+        assert(open.contains(key) == (live[key] && key % 64 == 0));
+    }
+    open.rehash(10000);
+    assert(open.capacity() == 16384);
+    open.shrink_to_fit();
+    assert(open.capacity() <= 128 && open.contains(0) == live[0]);
+    std::cout << "Shrink test passed.\n";
+}
+
+void testConcurrentHashTable() {
+    ConcurrentHashTable<int, int, 4> table;
+    assert(table.insert(1, 10));
+    assert(!table.insert(1, 11));
+    assert(table.get(1) == 10);
+    assert(!table.insert_or_assign(1, 12));
+    assert(table.get(1) == 12);
+    assert(table.insert_or_assign(2, 20));
+    int seen = 0;
+    assert(table.visit(2, [&](const int& v) { seen = v; }));
+    assert(seen == 20);
+    assert(table.erase(1) && !table.erase(1));
+    assert(!table.contains(1) && !table.get(1));
+
+    ConcurrentHashTable<std::string, int, 8> strings;
+    strings.insert("alpha", 1);
+    assert(strings.get(std::string_view("alpha")) == 1);
+    assert(strings.contains("alpha"));
+
+    // Readers run while one writer inserts (forcing grows), reassigns and
+    // erases. Every value a reader sees must belong to its key.
+    ConcurrentHashTable<int, int, 4> shared;
+    constexpr int key_count = 2000;
+    std::atomic<bool> done{false};
+    std::atomic<long> hits{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; ++t) {
+        readers.emplace_back([&, t] {
+            long local_hits = 0;
+            while (!done.load(std::memory_order_relaxed)) {
+                for (int k = t; k < key_count; k += 7) {
+                    if (auto v = shared.get(k)) {
+                        assert(*v == k * 2 || *v == k * 3);
+                        ++local_hits;
+                    }
+                }
+            }
+            hits += local_hits;
+        });
+    }
+    for (int k = 0; k < key_count; ++k) shared.insert(k, k * 2);
+    for (int k = 0; k < key_count; k += 2) shared.insert_or_assign(k, k * 3);
+    for (int k = 0; k < key_count; k += 3) shared.erase(k);
+    shared.grow();
+    done = true;
+    for (auto& reader : readers) reader.join();
+
+    for (int k = 0; k < key_count; ++k) {
+        auto v = shared.get(k);
+        if (k % 3 == 0) {
+            assert(!v);
+        } else {
+            assert(v == (k % 2 == 0 ? k * 3 : k * 2));
+        }
+    }
+    assert(shared.size() == static_cast<size_t>(key_count - (key_count + 2) / 3));
+
+    // Retired nodes are freed once no reader can hold them.
+    for (int i = 0; i < 4; ++i) EpochDomain::global().reclaim();
+    assert(EpochDomain::global().pending() == 0);
+    std::cout << "Concurrent hash table test passed.\n";
+}
+
+template <typename Capacity>
+void check_sharded_hash_table() {
+    ShardedHashTable<int, int, 8, 16, std::hash<int>, std::equal_to<int>, Capacity> table;
+    assert(table.insert(1, 10));
+    assert(!table.insert(1, 11));
+    assert(table.get(1) == 10);
+    assert(!table.insert_or_assign(1, 12) && table.get(1) == 12);
+    assert(table.visit(1, [](int& v) { v += 1; }));
+    assert(table.get(1) == 13);
+    assert(table.erase(1) && !table.erase(1) && !table.contains(1));
+
+    // Writers on disjoint key ranges, each also erasing part of its range.
+    constexpr int threads = 4, per_thread = 5000;
+    std::vector<std::thread> writers;
+    for (int t = 0; t < threads; ++t) {
+        writers.emplace_back([&, t] {
+            for (int i = 0; i < per_thread; ++i) table.insert(t * per_thread + i, i);
+            for (int i = 0; i < per_thread; i += 4) table.erase(t * per_thread + i);
+        });
+    }
+    for (auto& writer : writers) writer.join();
+
+    assert(table.size() == threads * (per_thread - per_thread / 4));
+    for (int k = 0; k < threads * per_thread; ++k) {
+        assert(table.contains(k) == (k % per_thread % 4 != 0));
+    }
+}
+
+void testShardedHashTable() {
+    check_sharded_hash_table<PowerOfTwoCapacity>();
+    check_sharded_hash_table<FastRangeCapacity>();
+
+    // Shard choice and in-shard index come from different bits: the keys
+    // of one shard still use every bucket of that shard.
+    constexpr size_t shards = 16, buckets = 64;
+    bool used[buckets] = {};
+    size_t count = 0;
+    for (uint64_t k = 0; count < buckets * 8; ++k) {
+        uint64_t h = hash_policy::mix(k);
+        if (PowerOfTwoCapacity::partition(h, shards) != 3) continue;
+        used[PowerOfTwoCapacity::reduce(h, buckets)] = true;
+        ++count;
+    }
+    for (bool b : used) assert(b);
+
+    ShardedHashTable<std::string, int, 4> strings;
+    strings.insert("alpha", 1);
+    assert(strings.get(std::string_view("alpha")) == 1);
+    assert(strings.erase("alpha"));
+
+    // Direct-layout shards: every key value, found in its shard.
+    ShardedHashTable<uint8_t, int, 256, 16> bytes;
+    for (int k = 0; k < 256; ++k) assert(bytes.insert(static_cast<uint8_t>(k), k));
+    for (int k = 0; k < 256; ++k) assert(bytes.get(static_cast<uint8_t>(k)) == k);
+    assert(bytes.size() == 256);
+    std::cout << "Sharded hash table test passed.\n";
+}
+
+void testNumaHashTable() {
+    assert((numa::detail::parse_list("0-3,8,10-11\n") == std::vector<size_t>{0, 1, 2, 3, 8, 10, 11}));
+    assert(numa::detail::parse_list("").empty());
+    assert(numa::node_count() >= 1 && numa::current_node() < numa::node_count());
+
+    // Node memory is zeroed, page aligned and, where the kernel can tell,
+    // on the node asked for.
+    void* memory = numa::allocate_on_node(10000, 0);
+    assert(reinterpret_cast<uintptr_t>(memory) % numa::detail::page_size() == 0);
+    assert(static_cast<unsigned char*>(memory)[9999] == 0);
+    static_cast<unsigned char*>(memory)[9999] = 1;
+    if (auto node = numa::node_of(memory)) assert(*node == 0);
+    numa::deallocate(memory, 10000);
+
+    // A plain HashTable on node memory, through SlabAllocator's source.
+    using NodeAllocator = SlabAllocator<std::pair<const int, int>, 256, NumaMemory>;
+    HashTable<int, int, 8, std::hash<int>, std::equal_to<int>, PowerOfTwoCapacity, NodeAllocator> local(
+        std::hash<int>(), std::equal_to<int>(), NodeAllocator(NumaMemory{0}));
+    for (int i = 0; i < 10000; ++i) local.insert(i, i * 2);
+    for (int i = 0; i < 10000; ++i) assert(local.get(i)->get() == i * 2);
+
+    // Two nodes whatever the host has: nodes the kernel does not know just
+    // get ordinary memory.
+    NumaHashTable<int, int, 8, 16> partitioned(NumaPlacement::partitioned, 2);
+    assert(partitioned.replica_count() == 1 && partitioned.node_count() == 2);
+    size_t owned[2] = {};
+    for (int i = 0; i < 2000; ++i) {
+        assert(partitioned.insert(i, i));
+        ++owned[partitioned.node_for(i)];
+    }
+    assert(owned[0] > 0 && owned[1] > 0);
+    assert(!partitioned.insert(7, 0) && partitioned.get(7) == 7);
+    assert(!partitioned.insert_or_assign(7, 70) && partitioned.get_on(1, 7) == 70);
+    assert(partitioned.update(7, [](int& v) { ++v; }) && partitioned.get(7) == 71);
+    assert(partitioned.erase(7) && !partitioned.contains(7) && partitioned.size() == 1999);
+
+    // Direct keys are unhashed, small indices; they still spread over nodes.
+    NumaHashTable<uint8_t, int, 256, 16> direct(NumaPlacement::partitioned, 2);
+    size_t direct_owned[2] = {};
+    for (int k = 0; k < 256; ++k) ++direct_owned[direct.node_for(static_cast<uint8_t>(k))];
+    assert(direct_owned[0] > 0 && direct_owned[1] > 0);
+
+    // Every replica sees every write.
+    NumaHashTable<int, int, 8, 16> replicated(NumaPlacement::replicated, 3);
+    assert(replicated.replica_count() == 3 && replicated.shard_node(2, 5) == 2);
+    for (int i = 0; i < 2000; ++i) assert(replicated.insert(i, i));
+    assert(replicated.try_emplace(5000, 1) && !replicated.try_emplace(5000, 2));
+    assert(replicated.insert_or_assign(6000, 6) && !replicated.insert_or_assign(6000, 7));
+    assert(replicated.update(6000, [](int& v) { v *= 2; }) && !replicated.update(6001, [](int&) {}));
+    for (int i = 0; i < 2000; i += 3) assert(replicated.erase(i));
+    for (size_t node = 0; node < 3; ++node) {
+        for (int i = 0; i < 2000; ++i) {
+            assert(replicated.get_on(node, i) == (i % 3 ? std::optional<int>(i) : std::nullopt));
+        }
+        assert(replicated.get_on(node, 5000) == 1 && replicated.get_on(node, 6000) == 14);
+    }
+    assert(replicated.node_for(1) == replicated.local_node());
+    assert(replicated.size() == 2000 - 667 + 2);
+
+    // Concurrent writers keep the replicas identical; readers only ever see
+    // values some writer stored.
+    NumaHashTable<int, int, 8, 16> shared(NumaPlacement::replicated, 2);
+    constexpr int threads = 4, per_thread = 2000;
+    std::atomic<bool> done{false};
+    std::thread reader([&] {
+        while (!done.load()) {
+            for (int k = 0; k < 100; ++k) {
+                for (size_t node = 0; node < 2; ++node) {
+                    if (auto v = shared.get_on(node, k)) assert(*v % per_thread == k % per_thread);
+                }
+            }
+        }
+    });
+    std::vector<std::thread> writers;
+    for (int t = 0; t < threads; ++t) {
+        writers.emplace_back([&, t] {
+            for (int i = 0; i < per_thread; ++i) shared.insert_or_assign(i, t * per_thread + i);
+            for (int i = t; i < per_thread; i += 2 * threads) shared.erase(i);
+        });
+    }
+    for (auto& writer : writers) writer.join();
+    done = true;
+    reader.join();
+    for (int k = 0; k < per_thread; ++k) assert(shared.get_on(0, k) == shared.get_on(1, k));
+
+    NumaHashTable<std::string, int, 4> strings(NumaPlacement::replicated, 2);
+    strings.insert("alpha", 1);
+    assert(strings.get(std::string_view("alpha")) == 1 && strings.contains(std::string_view("alpha")));
+    assert(strings.erase("alpha") && !strings.contains("alpha"));
+    std::cout << "NUMA hash table test passed.\n";
+}
+
+void testBatchOps() {
+    HashTable<int, int, 8> table;
+    std::vector<int> keys, values;
+    for (int i = 0; i < 1000; ++i) {
+        keys.push_back(i * 3);
+        values.push_back(i);
+    }
+    // Duplicates within the batch keep the first value.
+    keys.push_back(0);
+    values.push_back(-1);
+    assert(table.insert_batch(keys, values) == 1000);
+    assert(table.size() == 1000);
+
+    // Probe hits and misses, once mid-migration and once after.
+    std::vector<int> probes;
+    for (int i = 0; i < 3000; ++i) probes.push_back(i);
+    std::vector<int*> out(probes.size());
+    table.grow();
+    for (int pass = 0; pass < 2; ++pass) {
+        assert(table.is_migrating() == (pass == 0));
+        table.get_batch(probes, out);
+        for (size_t i = 0; i < probes.size(); ++i) {
+            if (probes[i] % 3 == 0) {
+                assert(out[i] && *out[i] == probes[i] / 3);
+            } else {
+                assert(!out[i]);
+            }
+        }
+        table.finish_migration();
+    }
+
+    const auto& view = table;
+    std::vector<const int*> const_out(3);
+    view.get_batch(std::vector<int>{3, 4, 2997}, const_out);
+    assert(*const_out[0] == 1 && !const_out[1] && *const_out[2] == 999);
+
+    HashTable<std::string, int, 4> strings;
+    std::vector<std::string> names = {"alpha", "beta", "gamma"};
+    std::vector<int> ids = {1, 2, 3};
+    assert(strings.insert_batch(names, ids) == 3);
+    std::vector<int*> found(3);
+    strings.get_batch(names, found);
+    assert(*found[0] == 1 && *found[1] == 2 && *found[2] == 3);
+    std::cout << "Batch operations test passed.\n";
+}
+
+template <typename Table>
+void check_iteration(const Table& table, int n) {
+    static_assert(std::forward_iterator<typename Table::const_iterator>);
+    std::vector<int> seen(n, 0);
+    size_t count = 0;
+    for (const auto& [key, value] : table) {
+        assert(key >= 0 && key < n && value == key * 2);
+        ++seen[key];
+        ++count;
+    }
+    assert(count == table.size());
+    for (int i = 0; i < n; ++i) assert(seen[i] == table.contains(i));
+}
+
+template <typename Table, typename Key>
+void check_async_get(const Table& table, const std::vector<Key>& keys, size_t width) {
+    using Value = typename std::remove_reference_t<decltype(table.get(keys[0])->get())>;
+    std::vector<const Value*> expected(keys.size()), out(keys.size());
+    std::vector<bool> seen(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (auto value = table.get(keys[i])) expected[i] = &value->get();
+    }
+    run_round_robin(keys.size(), width, [&](size_t i) { return table.async_get(keys[i]); },
+                    [&](size_t i, const Value* value) {
+                        assert(!seen[i]);
+                        seen[i] = true;
+                        out[i] = value;
+                    });
+    assert(out == expected && std::find(seen.begin(), seen.end(), false) == seen.end());
+}
+
+// A task would outlive a temporary key.
+template <typename Table>
+concept async_get_takes_temporaries = requires(Table& table) { table.async_get(30); };
+
+struct ThrowingHash {
+    size_t operator()(int key) const {
+        if (key < 0) throw std::invalid_argument("negative key");
+        return std::hash<int>()(key);
+    }
+};
+
+void testAsyncGet() {
+    HashTable<int, int, 8> table;
+    std::vector<int> probes;
+    for (int i = 0; i < 3000; ++i) {
+        table.insert(i * 3, i);
+        probes.push_back(i);
+    }
+    // Mid-migration keys may still be in their old bucket.
+    table.grow();
+    for (size_t width : {1, 16, 5000}) {
+        assert(table.is_migrating() == (width == 1));
+        check_async_get(table, probes, width);
+        table.finish_migration();
+    }
+
+    // Tasks started from a mutable table yield mutable values.
+    const int thirty = 30;
+    static_assert(!async_get_takes_temporaries<HashTable<int, int, 8>>);
+    LookupTask<int*> task = table.async_get(thirty);
+    while (!task.done()) task.resume();
+    *task.result() = -1;
+    assert(table.get(30)->get() == -1);
+    LookupTask<int*> moved = std::move(task);
+    assert(moved && !task && moved.done());
+    run_round_robin(0, 16, [&](size_t) { return table.async_get(thirty); }, [](size_t, int*) { assert(false); });
+
+    HashTable<std::string, int, 4> strings;
+    std::vector<std::string> names;
+    for (int i = 0; i < 500; ++i) {
+        names.push_back("key" + std::to_string(i));
+        if (i % 2 == 0) strings.insert(names.back(), i);
+    }
+    check_async_get(strings, names, 8);
+
+    HashTable<uint8_t, int, 256> direct;
+    std::vector<uint8_t> bytes;
+    for (int i = 0; i < 256; ++i) {
+        bytes.push_back(static_cast<uint8_t>(i));
+        if (i % 3 == 0) direct.insert(static_cast<uint8_t>(i), i);
+    }
+    check_async_get(direct, bytes, 8);
+
+    HashTable<int, Blob, 16> blobs;
+    for (int i = 0; i < 1000; i += 2) blobs.try_emplace(i, i);
+    check_async_get(blobs, probes, 8);
+
+    // A throwing hasher surfaces from result().
+    HashTable<int, int, 8, ThrowingHash> throwing;
+    throwing.insert(1, 1);
+    std::vector<int> mixed = {1, -1, 2};
+    size_t results = 0, errors = 0;
+    for (const int& key : mixed) {
+        LookupTask<const int*> lookup = std::as_const(throwing).async_get(key);
+        while (!lookup.done()) lookup.resume();
+        try {
+            results += lookup.result() != nullptr;
+        } catch (const std::invalid_argument&) {
+            ++errors;
+        }
+    }
+    assert(results == 1 && errors == 1);
+    std::cout << "Async get test passed.\n";
+}
+
+void testIteration() {
+    HashTable<int, int, 16> empty;
+    assert(empty.begin() == empty.end());
+
+    // Mid-migration, entries are spread over the new layout and the old one.
+    HashTable<int, int, 16> table;
+    int n = 0;
+    for (; !table.is_migrating() || n < 1000; ++n) table.insert(n, n * 2);
+    check_iteration(table, n);
+    table.finish_migration();
+    for (int i = 0; i < n; i += 3) table.erase(i);
+    check_iteration(table, n);
+
+    // Chains behind base slots, from the bulk node block of from_range.
+    std::vector<std::pair<int, int>> pairs;
+    for (int i = 0; i < 300; ++i) pairs.emplace_back(i, i * 2);
+    check_iteration(HashTable<int, int, 8, ConstantHash>::from_range(pairs.begin(), pairs.end()), 300);
+
+    // for_each can update values in place; for_each_parallel visits each entry once.
+    auto big = HashTable<int, int, 64>::from_range(pairs.begin(), pairs.end());
+    for (int i = 300; i < 100000; ++i) big.insert(i, i * 2);
+    big.for_each([](const int&, int& value) { value /= 2; });
+    std::atomic<long long> sum{0};
+    std::atomic<size_t> visited{0};
+    big.for_each_parallel([&](const int& key, const int& value) {
+        assert(key == value);
+        sum.fetch_add(value, std::memory_order_relaxed);
+        visited.fetch_add(1, std::memory_order_relaxed);
+    }, 4);
+    assert(visited == big.size() && sum == 99999LL * 100000 / 2);
+
+    // A table is a range of pairs, so it can be frozen directly.
+    const auto image = frozen::freeze<int, int>(big);
+    auto view = MappedHashTable<int, int>::view(image);
+    assert(view.size() == big.size() && view.get(12345) == 12345);
+    std::cout << "Iteration test passed.\n";
+}
+
+void testMappedHashTable() {
+    std::vector<std::pair<std::string, int>> pairs;
+    for (int i = 0; i < 500; ++i) pairs.emplace_back("key" + std::to_string(i), i * 7);
+
+    const std::string path = (std::filesystem::temp_directory_path() / "mapped_hash_table_test.bin").string();
+    frozen::write_frozen<std::string, int>(path, pairs);
+    {
+        auto table = MappedHashTable<std::string, int>::open(path);
+        assert(table.size() == 500);
+        for (int i = 0; i < 500; ++i) {
+            assert(table.get("key" + std::to_string(i)) == i * 7);
+        }
+        assert(!table.get("key500") && !table.contains("") && table.contains("key0"));
+
+        auto moved = std::move(table);
+        assert(moved.get("key42") == 294);
+    }
+    std::filesystem::remove(path);
+
+    // In-memory images, integer keys and string values.
+    std::vector<std::pair<uint64_t, std::string>> numbers = {{1, "one"}, {2, "two"}, {1ull << 40, "big"}};
+    const auto image = frozen::freeze<uint64_t, std::string>(numbers);
+    auto view = MappedHashTable<uint64_t, std::string>::view(image);
+    assert(view.get(2) == "two" && view.get(1ull << 40) == "big" && !view.get(3));
+
+    // Empty tables, duplicates and corrupt images.
+    const auto empty = frozen::freeze<int, int>(std::vector<std::pair<int, int>>{});
+    assert((!MappedHashTable<int, int>::view(empty).get(0)));
+
+    bool threw = false;
+    try {
+        frozen::freeze<int, int>(std::vector<std::pair<int, int>>{{1, 1}, {1, 2}});
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+
+    auto corrupt = image;
+    corrupt[0] = std::byte{'X'};
+    threw = false;
+    try {
+        MappedHashTable<uint64_t, std::string>::view(corrupt);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    threw = false;
+    try {
+        MappedHashTable<uint64_t, std::string>::view(std::span(image).first(image.size() - 8));
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+    std::cout << "Mapped hash table test passed.\n";
+}
+
+// Compile-time images and the hash every reader (C++, c/frozen_table.h,
+// rust/frozen-table) must agree on; see docs/frozen_format.md.
+alignas(8) constexpr auto static_colors = frozen::freeze_static<std::string_view, uint32_t, [] {
+    return std::array{std::pair{std::string_view("red"), 1u}, std::pair{std::string_view("green"), 2u},
+                      std::pair{std::string_view(""), 3u}};
+}, 42>();
+
+void testFrozenFormat() {
+    struct Vector {
+        size_t len;
+        uint64_t seed0, seed42;
+    };
+    constexpr Vector vectors[] = {
+        {0, 0x93228a4de0eec5a2ull, 0x2ac44db3deb05300ull},  {1, 0x8e6d4af7d310c8c4ull, 0x033b5aab97d9c425ull},
+        {3, 0x78c4aa0c972a522dull, 0xce9d66a797307f94ull},  {4, 0xe08aeeb68058fb32ull, 0xd97d61b5206c8513ull},
+        {8, 0xb4d6ac74d009e1d4ull, 0x3ed6827b249c2f37ull},  {15, 0x87edaf96d89a08efull, 0xa3945aeea738f410ull},
+        {16, 0x305fdea0ed4a2619ull, 0x9dbc2356533b4014ull}, {17, 0xd29ffdd201a46f9aull, 0x56e46ac1a9175c52ull},
+        {47, 0xe2cb58f6ab8e4419ull, 0xff37cfbd5256d21cull}, {48, 0xecbfb7ff9e3d9a97ull, 0x827717ed2564ebb4ull},
+        {49, 0x0691f11bac523a91ull, 0x7815fc5b6d4b56bcull}, {96, 0x948137d69794b570ull, 0x174effdbb7ffa0b0ull},
+        {100, 0x77ed9a7dfb9ac9b7ull, 0x8ad7f73a16686981ull}, {256, 0x139c96a974ad43cbull, 0xf9a18ee9194a4507ull},
+    };
+    char bytes[256];
+    for (size_t i = 0; i < sizeof(bytes); ++i) bytes[i] = static_cast<char>(i);
+    for (const Vector& v : vectors) {
+        assert(hash_policy::wyhash(std::string_view(bytes, v.len), 0) == v.seed0);
+        assert(hash_policy::wyhash(std::string_view(bytes, v.len), 42) == v.seed42);
+    }
+
+    // The compile-time image is the runtime one, and string_view keys are
+    // encoded like std::string keys.
+    const auto runtime = frozen::freeze<std::string, uint32_t>(
+        std::vector<std::pair<std::string, uint32_t>>{{"red", 1}, {"green", 2}, {"", 3}}, 42);
+    assert(std::equal(runtime.begin(), runtime.end(), static_colors.begin(), static_colors.end()));
+
+    auto colors = MappedHashTable<std::string_view, uint32_t>::view(static_colors);
+    assert(colors.size() == 3 && colors.get("green") == 2u && colors.get("") == 3u && !colors.get("blue"));
+    std::cout << "Frozen format test passed.\n";
+}
+
+enum class Color : uint32_t { red = 10, green = 20, blue = 30 };
+
+constexpr auto small_lookup = make_static_lookup<std::string_view, int>({
+    {"red", 1}, {"green", 2}, {"blue", 3}
+});
+static_assert(small_lookup.lookup_strategy() == LookupStrategy::compare_chain);
+static_assert(small_lookup.get("green")->get() == 2);
+static_assert(!small_lookup.contains("purple"));
+
+template <typename K, size_t N>
+constexpr std::array<std::pair<K, int>, N> numbered_pairs(uint64_t stride) {
+    std::array<std::pair<K, int>, N> pairs{};
+    for (size_t i = 0; i < N; ++i) pairs[i] = {static_cast<K>(i * stride + 7), static_cast<int>(i)};
+    return pairs;
+}
+
+constexpr auto scan32 = StaticLookup<int32_t, int, 13>::from_nice_pairs(numbered_pairs<int32_t, 13>(1000));
+constexpr auto scan64 = StaticLookup<uint64_t, int, 27>::from_nice_pairs(numbered_pairs<uint64_t, 27>(1ull << 33));
+constexpr auto hashed = StaticLookup<int, int, 100>::from_nice_pairs(numbered_pairs<int, 100>(3));
+#if defined(CTRL_GROUP_SSE2)
+static_assert(scan32.lookup_strategy() == LookupStrategy::simd_scan);
+static_assert(scan64.lookup_strategy() == LookupStrategy::simd_scan);
+#endif
+static_assert(hashed.lookup_strategy() == LookupStrategy::perfect_hash);
+static_assert(scan64.get((5ull << 33) + 7)->get() == 5 && !scan64.contains(8));
+static_assert(hashed.get(3 * 99 + 7)->get() == 99);
+
+template <typename Lookup, typename K>
+void check_static_lookup(const Lookup& lookup, uint64_t stride) {
+    for (size_t i = 0; i < Lookup::size(); ++i) {
+        assert(lookup.get(static_cast<K>(i * stride + 7))->get() == static_cast<int>(i));
+        assert(!lookup.contains(static_cast<K>(i * stride + 8)));
+    }
+    // Padding lanes repeat the first key and must not match past N.
+    assert(lookup.get(static_cast<K>(7))->get() == 0);
+}
+
+void testStaticLookup() {
+    assert(small_lookup.get(std::string("blue"))->get() == 3);
+    assert(!small_lookup.get("re"));
+
+    check_static_lookup<decltype(scan32), int32_t>(scan32, 1000);
+    check_static_lookup<decltype(scan64), uint64_t>(scan64, 1ull << 33);
+    check_static_lookup<decltype(hashed), int>(hashed, 3);
+
+    // 64-bit keys that agree in one 32-bit half must not match.
+    constexpr auto halves = make_static_lookup<LookupStrategy::simd_scan, uint64_t, int>({
+        {1, 1}, {1ull << 32, 2}, {(1ull << 32) | 1, 3}
+    });
+    assert(halves.get(1)->get() == 1 && halves.get(1ull << 32)->get() == 2);
+    assert(halves.get((1ull << 32) | 1)->get() == 3 && !halves.contains(0));
+
+    constexpr auto colors = make_static_lookup<LookupStrategy::simd_scan, Color, std::string_view>({
+        {Color::red, "red"}, {Color::green, "green"}, {Color::blue, "blue"}
+    });
+    assert(colors.get(Color::blue)->get() == "blue");
+    assert(!colors.contains(static_cast<Color>(11)));
+
+    bool threw = false;
+    try {
+        StaticLookup<int, int, 2>::from_nice_pairs({{{1, 1}, {1, 2}}});
+    } catch (const std::logic_error&) {
+        threw = true;
+    }
+    assert(threw);
+    std::cout << "Static lookup test passed.\n";
+}
+
 int main() {
     testGlobalTable();
+    testNicePairs();
+    testPerfectHashTable();
     testHashTable();
+    testCompactBaseTier();
+    testFromRange();
+    testParallelBuild();
+    testIteration();
+    testTableStats();
     grow_test();
+    testIncrementalGrow();
+    testGrowDuringMigration();
+    testInsertApis();
+    testTransparentLookup();
+    testStoredHash();
+    testTableLayout();
+    testBuiltInHashers();
+    testOverlayHashTable();
+    testSlabAllocator();
+    testPageMemory();
+    testCtrlGroup();
+    testOpenHashTable();
+    testShrink();
+    testBatchOps();
+    testAsyncGet();
+    testConcurrentHashTable();
+    testShardedHashTable();
+    testNumaHashTable();
+    testMappedHashTable();
+    testFrozenFormat();
+    testStaticLookup();
     std::cout << "All tests passed successfully!\n";
     return 0;
 }
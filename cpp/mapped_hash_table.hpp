@@ -0,0 +1,204 @@
+#ifndef MAPPED_HASH_TABLE_HPP
+#define MAPPED_HASH_TABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "frozen_format.hpp"
+#include "hash_policy.hpp"
+
+
+// Read-only view of a frozen table image (frozen_format.hpp), served
+// straight from the bytes: opening a file maps it and checks its header,
+// with no deserialization, so load time does not depend on the table size
+// and the pages are shared by every process mapping the same file.
+//
+// get() returns FrozenCodec<V>::view_type: integers by value, strings as
+// string_views into the image, valid while the MappedHashTable lives.
+template <typename K, typename V>
+class MappedHashTable {
+    using KeyCodec = frozen::FrozenCodec<K>;
+    using ValueCodec = frozen::FrozenCodec<V>;
+
+    const std::byte* image = nullptr;
+    size_t image_size = 0;
+    bool owns_mapping = false;
+
+    uint64_t seed = 0;
+    uint64_t bucket_mask = 0;
+    uint64_t entry_count = 0;
+    const std::byte* buckets = nullptr;
+    const std::byte* entries = nullptr;
+    const std::byte* blob = nullptr;
+    uint64_t blob_size = 0;
+
+    MappedHashTable(const std::byte* data, size_t size, bool owned)
+        : image(data), image_size(size), owns_mapping(owned) {
+        try {
+            parse();
+        } catch (...) {
+            unmap();
+            throw;
+        }
+    }
+
+    static void fail(const char* what) {
+        throw std::runtime_error(std::string("Invalid frozen table: ") + what);
+    }
+
+    // Validate the header and every offset against the image size, so a
+    // truncated or corrupt file is rejected here rather than read out of
+    // bounds later. Entry offsets are checked when an entry is read.
+    void parse() {
+        using frozen::detail::load_le;
+        if (image_size < frozen::header_size) fail("shorter than its header");
+        if (std::memcmp(image, frozen::magic, sizeof(frozen::magic)) != 0) fail("bad magic");
+        if (load_le<uint32_t>(image + 8) != frozen::version) fail("unsupported version");
+
+        seed = load_le<uint64_t>(image + 16);
+        const uint64_t bucket_count = load_le<uint64_t>(image + 24);
+        entry_count = load_le<uint64_t>(image + 32);
+        const uint64_t buckets_offset = load_le<uint64_t>(image + 40);
+        const uint64_t entries_offset = load_le<uint64_t>(image + 48);
+        const uint64_t blob_offset = load_le<uint64_t>(image + 56);
+        blob_size = load_le<uint64_t>(image + 64);
+
+        if (bucket_count == 0 || (bucket_count & (bucket_count - 1)) != 0) fail("bucket count");
+        if (entry_count > UINT32_MAX || bucket_count > image_size) fail("counts");
+        if (buckets_offset > image_size || (bucket_count + 1) * 4 > image_size - buckets_offset) {
+            fail("bucket array out of bounds");
+        }
+        if (entries_offset > image_size || entry_count * frozen::entry_size > image_size - entries_offset) {
+            fail("entries out of bounds");
+        }
+        if (blob_offset > image_size || blob_size > image_size - blob_offset) fail("blob out of bounds");
+
+        bucket_mask = bucket_count - 1;
+        buckets = image + buckets_offset;
+        entries = image + entries_offset;
+        blob = image + blob_offset;
+        if (load_le<uint32_t>(buckets) != 0 || load_le<uint32_t>(buckets + 4 * bucket_count) != entry_count) {
+            fail("bucket array does not cover the entries");
+        }
+    }
+
+    std::string_view blob_slice(uint64_t offset, uint32_t size) const {
+        if (offset > blob_size || size > blob_size - offset) fail("entry out of bounds");
+        return std::string_view(reinterpret_cast<const char*>(blob + offset), size);
+    }
+
+    std::optional<std::string_view> find_value(std::string_view key) const {
+        using frozen::detail::load_le;
+        const uint64_t h = hash_policy::wyhash(key, seed);
+        const uint64_t b = h & bucket_mask;
+        uint32_t first = load_le<uint32_t>(buckets + 4 * b);
+        uint32_t last = load_le<uint32_t>(buckets + 4 * (b + 1));
+        if (last > entry_count) fail("bucket out of bounds");
+
+        for (uint32_t i = first; i < last; ++i) {
+            const std::byte* entry = entries + frozen::entry_size * i;
+            if (load_le<uint64_t>(entry) != h) continue;
+            if (blob_slice(load_le<uint64_t>(entry + 8), load_le<uint32_t>(entry + 24)) != key) continue;
+            return blob_slice(load_le<uint64_t>(entry + 16), load_le<uint32_t>(entry + 28));
+        }
+        return std::nullopt;  // Key not found
+    }
+
+    void unmap() {
+        if (owns_mapping && image) {
+            ::munmap(const_cast<std::byte*>(image), image_size);
+        }
+        image = nullptr;
+        owns_mapping = false;
+    }
+
+public:
+    // Map a frozen table file read-only. Throws std::runtime_error if the
+    // file cannot be mapped or is not a valid image.
+    static MappedHashTable open(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) throw std::runtime_error("Cannot open frozen table " + path);
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(frozen::header_size)) {
+            ::close(fd);
+            throw std::runtime_error("Invalid frozen table: " + path + " is too small");
+        }
+        const size_t size = static_cast<size_t>(st.st_size);
+        void* data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) throw std::runtime_error("Cannot map frozen table " + path);
+        return MappedHashTable(static_cast<const std::byte*>(data), size, true);
+    }
+
+    // View an image already in memory (e.g. the result of frozen::freeze);
+    // the bytes must outlive the view.
+    static MappedHashTable view(std::span<const std::byte> bytes) {
+        return MappedHashTable(bytes.data(), bytes.size(), false);
+    }
+
+    ~MappedHashTable() { unmap(); }
+
+    MappedHashTable(MappedHashTable&& other) noexcept
+        : image(std::exchange(other.image, nullptr)),
+          image_size(std::exchange(other.image_size, 0)),
+          owns_mapping(std::exchange(other.owns_mapping, false)),
+          seed(other.seed),
+          bucket_mask(other.bucket_mask),
+          entry_count(std::exchange(other.entry_count, 0)),
+          buckets(other.buckets),
+          entries(other.entries),
+          blob(other.blob),
+          blob_size(other.blob_size) {}
+
+    MappedHashTable& operator=(MappedHashTable&& other) noexcept {
+        if (this != &other) {
+            unmap();
+            image = std::exchange(other.image, nullptr);
+            image_size = std::exchange(other.image_size, 0);
+            owns_mapping = std::exchange(other.owns_mapping, false);
+            seed = other.seed;
+            bucket_mask = other.bucket_mask;
+            entry_count = std::exchange(other.entry_count, 0);
+            buckets = other.buckets;
+            entries = other.entries;
+            blob = other.blob;
+            blob_size = other.blob_size;
+        }
+        return *this;
+    }
+
+    MappedHashTable(const MappedHashTable&) = delete;
+    MappedHashTable& operator=(const MappedHashTable&) = delete;
+
+    size_t size() const { return static_cast<size_t>(entry_count); }
+    size_t bucket_count() const { return static_cast<size_t>(bucket_mask + 1); }
+
+    // Retrieve the value associated with a key
+    std::optional<typename ValueCodec::view_type> get(const typename KeyCodec::lookup_type& key) const {
+        auto bytes = KeyCodec::with_bytes(key, [&](std::string_view k) { return find_value(k); });
+        if (!bytes) return std::nullopt;  // Key not found
+        if constexpr (!std::is_same_v<typename ValueCodec::view_type, std::string_view>) {
+            if (bytes->size() != sizeof(V)) fail("value size");
+        }
+        return ValueCodec::decode(*bytes);
+    }
+
+    bool contains(const typename KeyCodec::lookup_type& key) const {
+        return KeyCodec::with_bytes(key, [&](std::string_view k) { return find_value(k).has_value(); });
+    }
+};
+
+
+#endif // MAPPED_HASH_TABLE_HPP
@@ -0,0 +1,188 @@
+#ifndef NUMA_HPP
+#define NUMA_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <new>
+#include <optional>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+// NUMA topology and node-local memory, straight from the kernel: the
+// topology comes from sysfs and page placement from mbind(2), so there is
+// no libnuma to link. Elsewhere, or on kernels without NUMA support,
+// everything degrades to one node 0 and ordinary memory.
+namespace numa {
+
+namespace detail {
+
+// Numbers of a sysfs list such as "0-3,8,10-11".
+inline std::vector<size_t> parse_list(const std::string& text) {
+    std::vector<size_t> numbers;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = text.find(',', pos);
+        if (end == std::string::npos) end = text.size();
+        const std::string item = text.substr(pos, end - pos);
+        const size_t dash = item.find('-');
+        try {
+            const size_t first = std::stoul(item.substr(0, dash));
+            const size_t last = dash == std::string::npos ? first : std::stoul(item.substr(dash + 1));
+            for (size_t n = first; n <= last; ++n) numbers.push_back(n);
+        } catch (const std::exception&) {
+            // Blank or malformed item: skip it.
+        }
+        pos = end + 1;
+    }
+    return numbers;
+}
+
+inline std::vector<size_t> read_list(const std::string& path) {
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    return parse_list(line);
+}
+
+struct Topology {
+    size_t nodes = 1;
+    std::vector<uint16_t> cpu_node;  // node of each CPU
+};
+
+inline const Topology& topology() {
+    static const Topology topology = [] {
+        Topology t;
+#if defined(__linux__)
+        for (size_t node : read_list("/sys/devices/system/node/online")) {
+            t.nodes = std::max(t.nodes, node + 1);
+            for (size_t cpu : read_list("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist")) {
+                if (cpu >= t.cpu_node.size()) t.cpu_node.resize(cpu + 1, 0);
+                t.cpu_node[cpu] = static_cast<uint16_t>(node);
+            }
+        }
+#endif
+        return t;
+    }();
+    return topology;
+}
+
+inline size_t page_size() {
+#if defined(__linux__)
+    static const size_t size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    return size;
+#else
+    return 4096;
+#endif
+}
+
+inline size_t round_to_pages(size_t bytes) {
+    const size_t page = page_size();
+    return (bytes + page - 1) / page * page;
+}
+
+// From <numaif.h>, which comes with libnuma rather than the kernel headers.
+inline constexpr int mpol_preferred = 1;
+inline constexpr unsigned long mpol_f_node = 1;
+inline constexpr unsigned long mpol_f_addr = 2;
+
+} // namespace detail
+
+// Number of nodes (highest online node id + 1); 1 without NUMA.
+inline size_t node_count() { return detail::topology().nodes; }
+
+// Node of the CPU the calling thread is running on. Threads migrate unless
+// pinned, so this is where the thread is now, not where it will stay.
+inline size_t current_node() {
+#if defined(__linux__)
+    const int cpu = ::sched_getcpu();
+    const auto& cpu_node = detail::topology().cpu_node;
+    if (cpu >= 0 && static_cast<size_t>(cpu) < cpu_node.size()) return cpu_node[static_cast<size_t>(cpu)];
+#endif
+    return 0;
+}
+
+// Ask the kernel to place the not yet touched pages of [p, p + bytes) on
+// `node`, or on another node once that one is full (MPOL_PREFERRED); p
+// must be page aligned. Returns false if the kernel refuses, e.g. for an
+// offline node or without NUMA support, leaving the default placement.
+inline bool bind_to_node(void* p, size_t bytes, size_t node) {
+#if defined(__linux__) && defined(SYS_mbind)
+    if (node >= 64) return false;
+    unsigned long mask = 1ul << node;
+    return ::syscall(SYS_mbind, p, bytes, detail::mpol_preferred, &mask, 65ul, 0u) == 0;
+#else
+    (void)p, (void)bytes, (void)node;
+    return false;
+#endif
+}
+
+// Zeroed, page-aligned memory for `bytes` (rounded up to whole pages)
+// placed on `node` as far as the kernel allows, since the policy is set
+// before any page is touched. Throws std::bad_alloc. Release it with
+// deallocate() and the same size.
+inline void* allocate_on_node(size_t bytes, size_t node) {
+#if defined(__linux__)
+    const size_t size = detail::round_to_pages(bytes);
+    void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) throw std::bad_alloc();
+    bind_to_node(p, size, node);
+    return p;
+#else
+    (void)node;
+    return ::operator new(detail::round_to_pages(bytes), std::align_val_t{detail::page_size()});
+#endif
+}
+
+inline void deallocate(void* p, size_t bytes) noexcept {
+#if defined(__linux__)
+    ::munmap(p, detail::round_to_pages(bytes));
+#else
+    (void)bytes;
+    ::operator delete(p, std::align_val_t{detail::page_size()});
+#endif
+}
+
+// Node holding the page at p (faulting it in if needed), if the kernel
+// can tell.
+inline std::optional<size_t> node_of(const void* p) {
+#if defined(__linux__) && defined(SYS_get_mempolicy)
+    int node = -1;
+    if (::syscall(SYS_get_mempolicy, &node, nullptr, 0ul, p, detail::mpol_f_node | detail::mpol_f_addr) == 0 &&
+        node >= 0) {
+        return static_cast<size_t>(node);
+    }
+#else
+    (void)p;
+#endif
+    return std::nullopt;
+}
+
+} // namespace numa
+
+
+// SlabAllocator memory source (slab_allocator.hpp) placing every chunk and
+// array on one node. Each request is its own mapping of whole pages, which
+// suits the node chunks and bucket arrays of a table, not small objects.
+struct NumaMemory {
+    size_t node = 0;
+
+    void* allocate(size_t bytes, size_t alignment) const {
+        if (alignment > numa::detail::page_size()) throw std::bad_alloc();
+        return numa::allocate_on_node(bytes, node);
+    }
+
+    void deallocate(void* p, size_t bytes, size_t) const noexcept { numa::deallocate(p, bytes); }
+};
+
+
+#endif // NUMA_HPP
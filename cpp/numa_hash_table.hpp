@@ -0,0 +1,285 @@
+#ifndef NUMA_HASH_TABLE_HPP
+#define NUMA_HASH_TABLE_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "capacity_policy.hpp"
+#include "hash_policy.hpp"
+#include "hash_table.hpp"
+#include "numa.hpp"
+#include "slab_allocator.hpp"
+
+
+enum class NumaPlacement {
+    partitioned,  // each shard lives on one node; a key has one copy
+    replicated,   // every node holds a full copy; reads stay on their node
+};
+
+
+// Sharded hash table for multi-socket hosts, laid out like
+// ShardedHashTable (num_shards HashTables, a key hashed once and routed by
+// Capacity::partition) but with every shard placed on a NUMA node: the
+// shard object with its base tier, its heap bucket arrays and its node
+// arena all come from that node's memory (NumaMemory).
+//
+// partitioned  shard s belongs to node s % nodes. Memory is spread evenly
+//              and every key has one copy, but a thread reaches the shards
+//              of other nodes remotely; node_for(key) tells callers that
+//              hand work to per-node threads where to send it.
+// replicated   every node gets its own set of shards holding every key.
+//              get() reads the calling thread's node's copy under a shared
+//              lock, so read-mostly tables never leave the node. A write
+//              updates the copies one after the other, serialized per
+//              shard index so all copies see writes in the same order; a
+//              read racing it may find the new value on one node and the
+//              old one on another.
+//
+// Placement is a kernel preference (see numa::bind_to_node): on a host
+// without NUMA, or for nodes that are not online, shards get ordinary
+// memory and the table behaves like a ShardedHashTable.
+template <typename K, typename V, size_t base_size, size_t num_shards = 64,
+          typename Hash = hash_policy::DefaultHash<K>,
+          typename KeyEqual = hash_policy::DefaultKeyEqual<K>,
+          typename Capacity = PowerOfTwoCapacity>
+class NumaHashTable {
+    static_assert(std::has_single_bit(num_shards), "num_shards must be a power of two");
+
+public:
+    using Allocator = SlabAllocator<std::pair<const K, V>, 256, NumaMemory>;
+
+private:
+    using Table = HashTable<K, V, base_size, Hash, KeyEqual, Capacity, Allocator>;
+
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        Table table;
+
+        Shard(const Hash& hash, const KeyEqual& equal, size_t node)
+            : table(hash, equal, Allocator(NumaMemory{node})) {}
+    };
+
+    // Each shard is its own mapping on its node.
+    struct ShardDeleter {
+        void operator()(Shard* shard) const noexcept {
+            shard->~Shard();
+            numa::deallocate(shard, sizeof(Shard));
+        }
+    };
+
+    // Orders writes to one shard index across the replicas.
+    struct alignas(64) Writer {
+        std::mutex mutex;
+    };
+
+    template <typename Q>
+    static constexpr bool lookup_with =
+        hash_policy::is_transparent_v<Hash, KeyEqual> && !std::is_same_v<Q, K>;
+
+    NumaPlacement policy;
+    size_t nodes;
+    [[no_unique_address]] Hash hasher;
+    std::vector<std::unique_ptr<Shard, ShardDeleter>> shards;  // replica-major
+    std::unique_ptr<Writer[]> writers;                         // replicated only
+
+    static std::unique_ptr<Shard, ShardDeleter> make_shard(size_t node, const Hash& hash,
+                                                           const KeyEqual& equal) {
+        void* memory = numa::allocate_on_node(sizeof(Shard), node);
+        try {
+            return std::unique_ptr<Shard, ShardDeleter>(::new (memory) Shard(hash, equal, node));
+        } catch (...) {
+            numa::deallocate(memory, sizeof(Shard));
+            throw;
+        }
+    }
+
+    template <typename Q>
+    size_t hash_of(const Q& key) const {
+        if constexpr (Table::direct) return direct_index(key);
+        return static_cast<size_t>(hash_policy::finalize<Hash>(static_cast<uint64_t>(hasher(key))));
+    }
+
+    // Direct keys are unhashed indices below 2^16; partition reads the top
+    // bits with power-of-two masking, so they are mixed first.
+    static size_t shard_index(size_t hash) {
+        if constexpr (Table::direct) hash = static_cast<size_t>(hash_policy::mix(hash));
+        return Capacity::partition(hash, num_shards);
+    }
+
+    Shard& shard(size_t replica, size_t index) const { return *shards[replica * num_shards + index]; }
+
+    // Replica serving reads on `node`.
+    size_t replica_on(size_t node) const { return policy == NumaPlacement::replicated ? node % nodes : 0; }
+
+    template <typename Q, typename F>
+    bool visit_impl(size_t replica, const Q& key, F&& f) const {
+        size_t hash = hash_of(key);
+        Shard& s = shard(replica, shard_index(hash));
+        std::shared_lock<std::shared_mutex> lock(s.mutex);
+        auto value = s.table.template get_impl<const V>(key, hash);
+        if (!value) return false;
+        std::forward<F>(f)(value->get());
+        return true;
+    }
+
+    template <typename Q>
+    std::optional<V> get_impl(size_t replica, const Q& key) const {
+        std::optional<V> result;
+        visit_impl(replica, key, [&](const V& value) { result.emplace(value); });
+        return result;
+    }
+
+    // Run write(table, hash) on the key's shard in every replica and return
+    // its result, which is the same for all of them.
+    template <typename Q, typename Write>
+    bool write_impl(const Q& key, Write&& write) {
+        size_t hash = hash_of(key);
+        size_t index = shard_index(hash);
+        if (replica_count() == 1) {
+            Shard& s = shard(0, index);
+            std::lock_guard<std::shared_mutex> lock(s.mutex);
+            return write(s.table, hash);
+        }
+        std::lock_guard<std::mutex> order(writers[index].mutex);
+        bool result = false;
+        for (size_t replica = 0; replica < nodes; ++replica) {
+            Shard& s = shard(replica, index);
+            std::lock_guard<std::shared_mutex> lock(s.mutex);
+            result = write(s.table, hash);
+        }
+        return result;
+    }
+
+public:
+    // `nodes` defaults to the host's; tables with fewer nodes than the host
+    // fold the extra nodes' threads onto node % nodes.
+    explicit NumaHashTable(NumaPlacement placement = NumaPlacement::partitioned,
+                           size_t nodes = numa::node_count(), const Hash& hash = Hash(),
+                           const KeyEqual& equal = KeyEqual())
+        : policy(placement), nodes(std::max<size_t>(nodes, 1)), hasher(hash) {
+        const size_t replicas = replica_count();
+        shards.reserve(replicas * num_shards);
+        for (size_t replica = 0; replica < replicas; ++replica) {
+            for (size_t i = 0; i < num_shards; ++i) {
+                shards.push_back(make_shard(shard_node(replica, i), hash, equal));
+            }
+        }
+        if (replicas > 1) writers = std::make_unique<Writer[]>(num_shards);
+    }
+
+    NumaHashTable(const NumaHashTable&) = delete;
+    NumaHashTable& operator=(const NumaHashTable&) = delete;
+
+    static constexpr size_t shard_count() { return num_shards; }
+
+    NumaPlacement placement() const { return policy; }
+
+    size_t node_count() const { return nodes; }
+
+    // Copies of the table: one per node when replicated, else 1.
+    size_t replica_count() const { return policy == NumaPlacement::replicated ? nodes : 1; }
+
+    // Node holding shard `index` of `replica`.
+    size_t shard_node(size_t replica, size_t index) const {
+        return policy == NumaPlacement::replicated ? replica : index % nodes;
+    }
+
+    // Node of the calling thread, as this table numbers them.
+    size_t local_node() const { return numa::current_node() % nodes; }
+
+    // Node whose memory serves `key` for the calling thread: the owner of
+    // the key's shard when partitioned, the thread's own node when
+    // replicated. Work on the key done by a thread of that node stays local.
+    size_t node_for(const K& key) const {
+        if (policy == NumaPlacement::replicated) return local_node();
+        return shard_node(0, shard_index(hash_of(key)));
+    }
+
+    // Entries of one copy, each shard read under its lock; a snapshot while
+    // writers are active.
+    size_t size() const {
+        size_t total = 0;
+        for (size_t i = 0; i < num_shards; ++i) {
+            std::shared_lock<std::shared_mutex> lock(shard(0, i).mutex);
+            total += shard(0, i).table.size();
+        }
+        return total;
+    }
+
+    // Insert a key-value pair if the key is absent. Returns whether it was
+    // inserted; an existing key keeps its value.
+    bool insert(const K& key, const V& value) {
+        return write_impl(key, [&](Table& table, size_t hash) {
+            return table.try_emplace_hashed(hash, key, value).second;
+        });
+    }
+
+    // Construct the value from args if key is absent. Replicas each build
+    // their own value, so args are passed as lvalues, once per replica.
+    template <typename... Args>
+    bool try_emplace(const K& key, const Args&... args) {
+        return write_impl(key, [&](Table& table, size_t hash) {
+            return table.try_emplace_hashed(hash, key, args...).second;
+        });
+    }
+
+    // Insert, or assign to the existing value. Returns whether the key was
+    // inserted.
+    template <typename M>
+    bool insert_or_assign(const K& key, const M& obj) {
+        return write_impl(key, [&](Table& table, size_t hash) {
+            auto result = table.try_emplace_hashed(hash, key, obj);
+            if (!result.second) result.first = obj;
+            return result.second;
+        });
+    }
+
+    // Call f(V&) on the value of `key` under its shard's exclusive lock,
+    // once per replica, so f must compute the same update each time (e.g.
+    // ++value). Returns whether the key was found.
+    template <typename F>
+    bool update(const K& key, F&& f) {
+        return write_impl(key, [&](Table& table, size_t hash) {
+            auto value = table.template get_impl<V>(key, hash);
+            if (!value) return false;
+            f(value->get());
+            return true;
+        });
+    }
+
+    // Copy of the value associated with a key, from the calling thread's
+    // replica (or the owner shard when partitioned).
+    std::optional<V> get(const K& key) const { return get_impl(replica_on(local_node()), key); }
+
+    template <typename Q> requires lookup_with<Q>
+    std::optional<V> get(const Q& key) const { return get_impl(replica_on(local_node()), key); }
+
+    // get() from the replica of `node` rather than the caller's, e.g. for a
+    // thread that knows where it is pinned. Same as get() when partitioned.
+    std::optional<V> get_on(size_t node, const K& key) const { return get_impl(replica_on(node), key); }
+
+    bool contains(const K& key) const {
+        return visit_impl(replica_on(local_node()), key, [](const V&) {});
+    }
+
+    template <typename Q> requires lookup_with<Q>
+    bool contains(const Q& key) const {
+        return visit_impl(replica_on(local_node()), key, [](const V&) {});
+    }
+
+    // Remove the key-value pair associated with a key
+    bool erase(const K& key) {
+        return write_impl(key, [&](Table& table, size_t hash) { return table.erase_impl(key, hash); });
+    }
+};
+
+
+#endif // NUMA_HASH_TABLE_HPP
@@ -0,0 +1,481 @@
+#ifndef OPEN_HASH_TABLE_HPP
+#define OPEN_HASH_TABLE_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "ctrl_group.hpp"
+#include "hash_policy.hpp"
+#include "hash_table.hpp"
+#include "slab_allocator.hpp"
+
+
+// Open-addressing hash table with linear probing and a struct-of-arrays
+// layout: control bytes, keys and values live in three separate contiguous
+// arrays. A probe scans the dense control bytes and only touches a key when
+// its tag matches, so a lookup usually costs one or two cache lines instead
+// of one miss per chained HashNode.
+//
+// Probing is still linear, but runs a whole CtrlGroup (16 control bytes with
+// SSE2/NEON, 32 with AVX2, 8 in the portable fallback) per step: the tag is
+// compared against every byte of the window at once, and the scan stops at
+// the first window containing an empty slot. The control array carries
+// width - 1 cloned bytes past the end so a window starting near the end can
+// be loaded without wrapping.
+//
+// Erase uses backward-shift deletion instead of tombstones: the entries
+// after the erased one in its probe run move back into the hole, so every
+// key stays where a fresh insert would put it and probe lengths do not
+// creep up under long-running insert/erase churn. The table also shrinks
+// once fewer than one in sixteen slots is used (see shrink_if_sparse).
+//
+// The interface mirrors HashTable (insert/get/erase/rehash/from_pairs), so
+// the two engines can be swapped with SelectHashTable below, including
+// heterogeneous lookup with transparent Hash/KeyEqual. base_size is the
+// initial (and smallest) capacity, rounded up to a power of two.
+//
+// The three slot arrays come from Storage, a memory source like
+// SlabAllocator's (slab_allocator.hpp), cache-line aligned. PageMemory
+// (page_memory.hpp) puts large ones on huge pages and faults them in on
+// allocation, so that reserve() leaves nothing to fault in later.
+template <typename K, typename V, size_t base_size,
+          typename Hash = hash_policy::DefaultHash<K>,
+          typename KeyEqual = hash_policy::DefaultKeyEqual<K>,
+          typename Storage = HeapMemory>
+class OpenHashTable {
+    using Group = CtrlGroup;
+    static constexpr size_t min_capacity = Group::width < 16 ? 16 : Group::width;
+    static constexpr size_t num_cloned = Group::width - 1;
+    static constexpr size_t initial_capacity = std::bit_ceil(std::max(base_size, min_capacity));
+
+    template <typename Q>
+    static constexpr bool lookup_with =
+        hash_policy::is_transparent_v<Hash, KeyEqual> && !std::is_same_v<Q, K>;
+
+    [[no_unique_address]] Hash hasher;
+    [[no_unique_address]] KeyEqual key_eq;
+    [[no_unique_address]] Storage storage;
+    uint8_t* ctrl = nullptr;
+    K* keys = nullptr;
+    V* values = nullptr;
+    size_t slot_count = 0;
+    size_t num_entries = 0;
+
+    // std::hash<int> is the identity; mix it so both the slot index (low
+    // bits) and the tag (high bits) see every input bit. Avalanching
+    // hashers already do.
+    template <typename Q>
+    uint64_t hash_of(const Q& key) const {
+        return hash_policy::finalize<Hash>(static_cast<uint64_t>(hasher(key)));
+    }
+
+    static uint8_t tag_of(uint64_t h) { return static_cast<uint8_t>(h >> 57); }
+
+    // Cache-line aligned, so a group load at the start of an array never
+    // splits a line.
+    static constexpr size_t slot_alignment(size_t align) { return align < 64 ? 64 : align; }
+
+    template <typename T>
+    T* allocate_slots(size_t n) {
+        return static_cast<T*>(storage.allocate(n * sizeof(T), slot_alignment(alignof(T))));
+    }
+
+    template <typename T>
+    void free_slots(T* p, size_t n) {
+        storage.deallocate(p, n * sizeof(T), slot_alignment(alignof(T)));
+    }
+
+    // Max load factor of 7/8.
+    size_t max_load() const { return slot_count - slot_count / 8; }
+
+    // Smallest capacity holding n entries below the max load factor.
+    static size_t capacity_for(size_t n) {
+        size_t capacity = initial_capacity;
+        while (n >= capacity - capacity / 8) capacity *= 2;
+        return capacity;
+    }
+
+    // The three arrays of one capacity.
+    struct SlotArrays {
+        uint8_t* ctrl;
+        K* keys;
+        V* values;
+    };
+
+    // Arrays for `capacity` empty slots. If an allocation throws, the ones
+    // already made are released.
+    SlotArrays allocate_arrays(size_t capacity) {
+        uint8_t* new_ctrl = allocate_slots<uint8_t>(capacity + num_cloned);
+        K* new_keys = nullptr;
+        try {
+            new_keys = allocate_slots<K>(capacity);
+            V* new_values = allocate_slots<V>(capacity);
+            std::fill_n(new_ctrl, capacity + num_cloned, static_cast<uint8_t>(Ctrl::empty));
+            return {new_ctrl, new_keys, new_values};
+        } catch (...) {
+            if (new_keys) free_slots(new_keys, capacity);
+            free_slots(new_ctrl, capacity + num_cloned);
+            throw;
+        }
+    }
+
+    // Destroy the entries of `arrays` and release them.
+    void free_arrays(const SlotArrays& arrays, size_t capacity) {
+        for (size_t i = 0; i < capacity; ++i) {
+            if (is_full(arrays.ctrl[i])) {
+                std::destroy_at(&arrays.keys[i]);
+                std::destroy_at(&arrays.values[i]);
+            }
+        }
+        free_slots(arrays.ctrl, capacity + num_cloned);
+        free_slots(arrays.keys, capacity);
+        free_slots(arrays.values, capacity);
+    }
+
+    void allocate(size_t capacity) {
+        const SlotArrays arrays = allocate_arrays(capacity);
+        ctrl = arrays.ctrl;
+        keys = arrays.keys;
+        values = arrays.values;
+        slot_count = capacity;
+    }
+
+    // Write a control byte, keeping the cloned tail in sync.
+    static void set_ctrl(uint8_t* ctrl_bytes, size_t count, size_t i, uint8_t c) {
+        ctrl_bytes[i] = c;
+        if (i < num_cloned) ctrl_bytes[count + i] = c;
+    }
+
+    void set_ctrl(size_t i, uint8_t c) { set_ctrl(ctrl, slot_count, i, c); }
+
+    // First empty slot in probe order from h.
+    static size_t find_empty(const uint8_t* ctrl_bytes, size_t count, uint64_t h) {
+        const size_t mask = count - 1;
+        for (size_t i = h & mask;; i = (i + Group::width) & mask) {
+            if (auto empty = Group(ctrl_bytes + i).match_empty()) {
+                return (i + empty.lowest()) & mask;
+            }
+        }
+    }
+
+    void destroy() {
+        if (!ctrl) return;
+        free_arrays({ctrl, keys, values}, slot_count);
+        ctrl = nullptr;
+        keys = nullptr;
+        values = nullptr;
+    }
+
+    // Index of the slot holding key, or slot_count if absent.
+    template <typename Q>
+    size_t find_index(const Q& key) const {
+        const uint64_t h = hash_of(key);
+        const uint8_t tag = tag_of(h);
+        const size_t mask = slot_count - 1;
+
+        for (size_t i = h & mask;; i = (i + Group::width) & mask) {
+            Group g(ctrl + i);
+            for (int pos : g.match(tag)) {
+                size_t index = (i + pos) & mask;
+                if (key_eq(keys[index], key)) return index;
+            }
+            if (g.match_empty()) return slot_count;
+        }
+    }
+
+    template <typename R, typename Q>
+    std::optional<std::reference_wrapper<R>> get_impl(const Q& key) const {
+        size_t i = find_index(key);
+        if (i == slot_count) return std::nullopt;  // Key not found
+        return std::ref<R>(values[i]);
+    }
+
+    template <typename Q>
+    bool erase_impl(const Q& key) {
+        size_t i = find_index(key);
+        if (i == slot_count) return false;  // Key not found
+
+        erase_at(i);
+        --num_entries;
+        shrink_if_sparse();
+        return true;
+    }
+
+    // Empty slot `hole`, then walk the rest of its probe run and move each
+    // entry whose home slot is at or before the hole (cyclically) back into
+    // it, leaving a new hole behind. Lookups only rely on there being no
+    // empty slot between a key's home and its slot, which this keeps; the
+    // run ends at the first empty slot. Moving entries costs a rehash of
+    // each key visited.
+    void erase_at(size_t hole) {
+        const size_t mask = slot_count - 1;
+        std::destroy_at(&keys[hole]);
+        std::destroy_at(&values[hole]);
+
+        for (size_t j = (hole + 1) & mask; is_full(ctrl[j]); j = (j + 1) & mask) {
+            const size_t home = hash_of(keys[j]) & mask;
+            if (((j - home) & mask) < ((j - hole) & mask)) continue;  // home lies past the hole
+
+            std::construct_at(&keys[hole], std::move(keys[j]));
+            std::construct_at(&values[hole], std::move(values[j]));
+            std::destroy_at(&keys[j]);
+            std::destroy_at(&values[j]);
+            set_ctrl(hole, ctrl[j]);
+            hole = j;
+        }
+        set_ctrl(hole, static_cast<uint8_t>(Ctrl::empty));
+    }
+
+    // Shrink once fewer than 1/16 of the slots are used, to the capacity
+    // that fits twice the remaining entries. The table then has to lose half
+    // (or double) its entries again before the next resize, so bursts of
+    // inserts followed by mass erases do not resize back and forth.
+    void shrink_if_sparse() {
+        if (slot_count <= initial_capacity || num_entries >= slot_count / 16) return;
+        const size_t target = capacity_for(2 * num_entries);
+        if (target < slot_count) rebuild(target);
+    }
+
+    // Single-pass find-or-insert. The probe runs to the end of the key's
+    // run to rule out a duplicate, and on a miss the entry is constructed
+    // in the first empty slot, where the run ended. A full table grows only
+    // then, for an entry that is really inserted.
+    template <typename KArg, typename... Args>
+    std::pair<V&, bool> try_emplace_impl(KArg&& key, Args&&... args) {
+        const uint64_t h = hash_of(key);
+        const uint8_t tag = tag_of(h);
+        const size_t mask = slot_count - 1;
+        size_t target;
+
+        for (size_t i = h & mask;; i = (i + Group::width) & mask) {
+            Group g(ctrl + i);
+            for (int pos : g.match(tag)) {
+                size_t index = (i + pos) & mask;
+                if (key_eq(keys[index], key)) return {values[index], false};
+            }
+            if (auto empty = g.match_empty()) {
+                target = (i + empty.lowest()) & mask;
+                break;
+            }
+        }
+        if (num_entries >= max_load()) {
+            rebuild(slot_count * 2);
+            target = find_empty(ctrl, slot_count, h);
+        }
+
+        std::construct_at(&keys[target], std::forward<KArg>(key));
+        try {
+            std::construct_at(&values[target], std::forward<Args>(args)...);
+        } catch (...) {
+            std::destroy_at(&keys[target]);
+            throw;
+        }
+        set_ctrl(target, tag);
+        ++num_entries;
+        return {values[target], true};
+    }
+
+    // Rebuild into a table of new_capacity slots. The entries go into new
+    // arrays, which replace the old ones only once they are complete: if an
+    // allocation, a hash or an entry's move throws, the table is left as it
+    // was. Entries whose move may throw are copied, as std::vector does.
+    void rebuild(size_t new_capacity) {
+        const SlotArrays fresh = allocate_arrays(new_capacity);
+        try {
+            for (size_t j = 0; j < slot_count; ++j) {
+                if (!is_full(ctrl[j])) continue;
+
+                const uint64_t h = hash_of(keys[j]);
+                const size_t i = find_empty(fresh.ctrl, new_capacity, h);
+                std::construct_at(&fresh.keys[i], std::move_if_noexcept(keys[j]));
+                try {
+                    std::construct_at(&fresh.values[i], std::move_if_noexcept(values[j]));
+                } catch (...) {
+                    std::destroy_at(&fresh.keys[i]);
+                    throw;
+                }
+                set_ctrl(fresh.ctrl, new_capacity, i, tag_of(h));
+            }
+        } catch (...) {
+            free_arrays(fresh, new_capacity);
+            throw;
+        }
+
+        destroy();
+        ctrl = fresh.ctrl;
+        keys = fresh.keys;
+        values = fresh.values;
+        slot_count = new_capacity;
+    }
+
+public:
+    // Constructor
+    OpenHashTable() { allocate(initial_capacity); }
+
+    ~OpenHashTable() { destroy(); }
+
+    explicit OpenHashTable(const Hash& hash, const KeyEqual& equal = KeyEqual(),
+                           const Storage& source = Storage())
+        : hasher(hash), key_eq(equal), storage(source) {
+        allocate(initial_capacity);
+    }
+
+    explicit OpenHashTable(const Storage& source) : storage(source) { allocate(initial_capacity); }
+
+    OpenHashTable(OpenHashTable&& other) noexcept
+        : hasher(std::move(other.hasher)),
+          key_eq(std::move(other.key_eq)),
+          storage(other.storage),
+          ctrl(std::exchange(other.ctrl, nullptr)),
+          keys(std::exchange(other.keys, nullptr)),
+          values(std::exchange(other.values, nullptr)),
+          slot_count(std::exchange(other.slot_count, 0)),
+          num_entries(std::exchange(other.num_entries, 0)) {}
+
+    OpenHashTable& operator=(OpenHashTable&& other) noexcept {
+        if (this != &other) {
+            destroy();
+            hasher = std::move(other.hasher);
+            key_eq = std::move(other.key_eq);
+            storage = other.storage;
+            ctrl = std::exchange(other.ctrl, nullptr);
+            keys = std::exchange(other.keys, nullptr);
+            values = std::exchange(other.values, nullptr);
+            slot_count = std::exchange(other.slot_count, 0);
+            num_entries = std::exchange(other.num_entries, 0);
+        }
+        return *this;
+    }
+
+    OpenHashTable(const OpenHashTable&) = delete;
+    OpenHashTable& operator=(const OpenHashTable&) = delete;
+
+    size_t size() const { return num_entries; }
+    size_t capacity() const { return slot_count; }
+
+    // Resize to at least n slots, and at least enough for size() entries
+    // below the max load factor, but never below the initial capacity;
+    // rehash(0) shrinks to fit. Smaller and larger targets both rebuild the
+    // slot arrays at once.
+    void rehash(size_t n) {
+        const size_t target = std::max(capacity_for(num_entries), std::bit_ceil(std::max<size_t>(n, 1)));
+        if (target != slot_count) rebuild(target);
+    }
+
+    // Make room for n entries without further rebuilds; never shrinks.
+    void reserve(size_t n) {
+        const size_t target = capacity_for(n);
+        if (target > slot_count) rebuild(target);
+    }
+
+    void shrink_to_fit() { rehash(0); }
+
+    // Insert a key-value pair if the key is absent; the same contract as
+    // HashTable::insert and friends. References stay valid until the next
+    // insertion or erase.
+    std::pair<V&, bool> insert(const K& key, const V& value) {
+        return try_emplace_impl(key, value);
+    }
+
+    std::pair<V&, bool> insert(K&& key, V&& value) {
+        return try_emplace_impl(std::move(key), std::move(value));
+    }
+
+    template <typename... Args>
+    std::pair<V&, bool> try_emplace(const K& key, Args&&... args) {
+        return try_emplace_impl(key, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    std::pair<V&, bool> try_emplace(K&& key, Args&&... args) {
+        return try_emplace_impl(std::move(key), std::forward<Args>(args)...);
+    }
+
+    template <typename M>
+    std::pair<V&, bool> insert_or_assign(const K& key, M&& obj) {
+        auto result = try_emplace_impl(key, std::forward<M>(obj));
+        if (!result.second) result.first = std::forward<M>(obj);
+        return result;
+    }
+
+    template <typename M>
+    std::pair<V&, bool> insert_or_assign(K&& key, M&& obj) {
+        auto result = try_emplace_impl(std::move(key), std::forward<M>(obj));
+        if (!result.second) result.first = std::forward<M>(obj);
+        return result;
+    }
+
+    // Slots hold keys and values in separate arrays, so the entry is built
+    // as a pair first and then moved into place.
+    template <typename... Args>
+    std::pair<V&, bool> emplace(Args&&... args) {
+        std::pair<K, V> entry(std::forward<Args>(args)...);
+        return try_emplace_impl(std::move(entry.first), std::move(entry.second));
+    }
+
+    // Retrieve the value associated with a key (const version)
+    std::optional<std::reference_wrapper<const V>> get(const K& key) const {
+        return get_impl<const V>(key);
+    }
+
+    // Retrieve the value associated with a key (mutable version)
+    std::optional<std::reference_wrapper<V>> get(const K& key) {
+        return get_impl<V>(key);
+    }
+
+    // Heterogeneous lookup with transparent Hash and KeyEqual
+    template <typename Q> requires lookup_with<Q>
+    std::optional<std::reference_wrapper<const V>> get(const Q& key) const {
+        return get_impl<const V>(key);
+    }
+
+    template <typename Q> requires lookup_with<Q>
+    std::optional<std::reference_wrapper<V>> get(const Q& key) {
+        return get_impl<V>(key);
+    }
+
+    bool contains(const K& key) const { return find_index(key) != slot_count; }
+
+    template <typename Q> requires lookup_with<Q>
+    bool contains(const Q& key) const { return find_index(key) != slot_count; }
+
+    // Remove the key-value pair associated with a key
+    bool erase(const K& key) { return erase_impl(key); }
+
+    template <typename Q> requires lookup_with<Q>
+    bool erase(const Q& key) { return erase_impl(key); }
+
+    // Construct a hash table from pairs
+    static OpenHashTable from_pairs(std::initializer_list<std::pair<K, V>> pairs) {
+        OpenHashTable table;
+        for (const auto& [key, value] : pairs) {
+            table.insert(key, value);
+        }
+        return table;
+    }
+};
+
+
+// Storage engine for SelectHashTable.
+enum class TableEngine {
+    chained,          // HashTable: base array plus heap-allocated chains
+    open_addressing,  // OpenHashTable: linear probing over SoA slots
+};
+
+// Pick a table implementation by template parameter, e.g. to benchmark both
+// engines behind the same code.
+template <typename K, typename V, size_t base_size, TableEngine engine = TableEngine::chained>
+using SelectHashTable = std::conditional_t<engine == TableEngine::chained,
+                                           HashTable<K, V, base_size>,
+                                           OpenHashTable<K, V, base_size>>;
+
+
+#endif // OPEN_HASH_TABLE_HPP
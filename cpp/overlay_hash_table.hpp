@@ -0,0 +1,189 @@
+#ifndef OVERLAY_HASH_TABLE_HPP
+#define OVERLAY_HASH_TABLE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "hash_policy.hpp"
+#include "hash_table.hpp"
+#include "perfect_hash_table.hpp"
+
+
+// A compile-time PerfectHashTable snapshot with a runtime overlay on top:
+//
+//     static constexpr auto defaults = PerfectHashTable<std::string_view, int, 3>::from_nice_pairs({
+//         {"red", 1}, {"green", 2}, {"blue", 3}});
+//     OverlayHashTable<std::string_view, int, 3> colors(defaults);
+//     colors.insert("cyan", 4);           // goes to the overlay
+//     colors.insert_or_assign("red", 5);  // shadows the snapshot's entry
+//     colors.erase("blue");               // tombstone in the overlay
+//
+// The snapshot is never written, so a constexpr (static storage) one stays
+// in read-only memory and can be shared by any number of overlays. Every
+// change lives in the overlay, a HashTable from key to std::optional<V>
+// where an empty optional hides the snapshot's entry for that key.
+//
+// A lookup hashes the key once, with the snapshot's seeded hash. While
+// the overlay is empty, or the bloom filter (bloom_bits bits, two per key,
+// taken from that hash) rules the key out, the lookup is the snapshot's
+// single probe; only possible overlay keys pay for an overlay lookup, and
+// that reuses the hash too (the overlay hashes its keys the same way). The
+// filter's bits are only cleared when the overlay empties, so erases from a
+// large overlay leave it pessimistic (never wrong) until then.
+//
+// std::string_view keys are stored as std::string in the overlay, so keys
+// inserted at runtime need not outlive the table.
+template <typename K, typename V, size_t base_size, typename Hash = hash_policy::WyHash,
+          size_t overlay_size = 16, size_t bloom_bits = 512>
+class OverlayHashTable {
+    static_assert(bloom_bits >= 64 && (bloom_bits & (bloom_bits - 1)) == 0,
+                  "bloom_bits must be a power of two of at least 64");
+
+public:
+    using Base = PerfectHashTable<K, V, base_size, Hash>;
+
+private:
+    using OverlayKey = std::conditional_t<std::is_same_v<K, std::string_view>, std::string, K>;
+
+    // The snapshot's seeded hash, which needs no further mixing.
+    struct SnapshotHash {
+        using is_avalanching = std::true_type;
+        using is_transparent = void;
+
+        const Base* base = nullptr;
+
+        uint64_t operator()(const K& key) const { return base->hash_of(key); }
+    };
+
+    using Overlay = HashTable<OverlayKey, std::optional<V>, overlay_size, SnapshotHash>;
+
+    const Base* base;
+    Overlay overlay;
+    std::array<uint64_t, bloom_bits / 64> bloom{};
+    size_t num_entries;
+
+    static constexpr std::pair<size_t, size_t> bloom_bits_of(uint64_t h) {
+        return {static_cast<size_t>(h) & (bloom_bits - 1), static_cast<size_t>(h >> 32) & (bloom_bits - 1)};
+    }
+
+    void bloom_add(uint64_t h) {
+        auto [a, b] = bloom_bits_of(h);
+        bloom[a / 64] |= uint64_t{1} << (a % 64);
+        bloom[b / 64] |= uint64_t{1} << (b % 64);
+    }
+
+    bool bloom_may_contain(uint64_t h) const {
+        auto [a, b] = bloom_bits_of(h);
+        return (bloom[a / 64] >> (a % 64) & bloom[b / 64] >> (b % 64) & 1) != 0;
+    }
+
+    bool in_overlay(uint64_t h) const { return overlay.size() != 0 && bloom_may_contain(h); }
+
+    // What the overlay hashes `key` to, given its snapshot hash h.
+    static size_t overlay_hash(const K& key, uint64_t h) {
+        if constexpr (Overlay::direct) return direct_index(key);
+        return static_cast<size_t>(h);
+    }
+
+    std::optional<std::reference_wrapper<std::optional<V>>> overlay_entry(const K& key, uint64_t h) {
+        if (!in_overlay(h)) return std::nullopt;
+        return overlay.template get_impl<std::optional<V>>(key, overlay_hash(key, h));
+    }
+
+    template <typename M>
+    bool insert_impl(const K& key, M&& value, bool assign) {
+        const uint64_t h = base->hash_of(key);
+        if (auto entry = overlay_entry(key, h)) {
+            std::optional<V>& slot = entry->get();
+            if (slot.has_value()) {
+                if (assign) *slot = std::forward<M>(value);
+                return false;
+            }
+            slot.emplace(std::forward<M>(value));  // revive a key erased from the snapshot
+            ++num_entries;
+            return true;
+        }
+        const bool in_base = base->get_hashed(key, h).has_value();
+        if (in_base && !assign) return false;
+        overlay.try_emplace_hashed(overlay_hash(key, h), OverlayKey(key), std::forward<M>(value));
+        bloom_add(h);
+        num_entries += !in_base;
+        return !in_base;
+    }
+
+public:
+    explicit OverlayHashTable(const Base& snapshot)
+        : base(&snapshot), overlay(SnapshotHash{&snapshot}), num_entries(snapshot.size()) {}
+
+    const Base& snapshot() const { return *base; }
+
+    // Live keys: the snapshot's, minus erased ones, plus runtime inserts.
+    size_t size() const { return num_entries; }
+
+    // Entries held by the overlay, tombstones included.
+    size_t overlay_entries() const { return overlay.size(); }
+
+    // Retrieve the value associated with a key
+    std::optional<std::reference_wrapper<const V>> get(const K& key) const {
+        const uint64_t h = base->hash_of(key);
+        if (in_overlay(h)) {
+            if (auto entry = overlay.template get_impl<const std::optional<V>>(key, overlay_hash(key, h))) {
+                const std::optional<V>& slot = entry->get();
+                if (!slot.has_value()) return std::nullopt;  // Erased from the snapshot
+                return std::cref(*slot);
+            }
+        }
+        return base->get_hashed(key, h);
+    }
+
+    bool contains(const K& key) const { return get(key).has_value(); }
+
+    // Insert key -> value if the key is absent (from both tiers); returns
+    // whether it was inserted.
+    bool insert(const K& key, const V& value) { return insert_impl(key, value, false); }
+
+    // Insert, or overwrite the current value, shadowing the snapshot's entry
+    // if needed; returns whether the key was new.
+    template <typename M>
+    bool insert_or_assign(const K& key, M&& value) { return insert_impl(key, std::forward<M>(value), true); }
+
+    // Remove a key. Snapshot keys leave a tombstone behind in the overlay.
+    bool erase(const K& key) {
+        const uint64_t h = base->hash_of(key);
+        const bool in_base = base->get_hashed(key, h).has_value();
+        if (auto entry = overlay_entry(key, h)) {
+            std::optional<V>& slot = entry->get();
+            if (!slot.has_value()) return false;
+            if (in_base) {
+                slot.reset();
+            } else {
+                overlay.erase_impl(key, overlay_hash(key, h));
+                if (overlay.size() == 0) bloom = {};
+            }
+            --num_entries;
+            return true;
+        }
+        if (!in_base) return false;
+        overlay.try_emplace_hashed(overlay_hash(key, h), OverlayKey(key), std::nullopt);
+        bloom_add(h);
+        --num_entries;
+        return true;
+    }
+
+    // Drop every runtime change, back to the snapshot.
+    void reset() {
+        overlay = Overlay(SnapshotHash{base});
+        bloom = {};
+        num_entries = base->size();
+    }
+};
+
+
+#endif // OVERLAY_HASH_TABLE_HPP
@@ -0,0 +1,145 @@
+#ifndef PAGE_MEMORY_HPP
+#define PAGE_MEMORY_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+
+// Huge-page backing for PageMemory's mappings.
+enum class HugePages {
+    off,          // ordinary pages
+    transparent,  // madvise(MADV_HUGEPAGE): THP where the system allows it
+    hugetlb,      // MAP_HUGETLB from the reserved pool; transparent if it is empty
+};
+
+namespace detail {
+
+inline size_t system_page_size() {
+#if defined(__linux__)
+    static const size_t size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    return size;
+#else
+    return 4096;
+#endif
+}
+
+inline size_t round_up(size_t bytes, size_t unit) { return (bytes + unit - 1) / unit * unit; }
+
+// Write one byte per page so every page is faulted in now.
+inline void touch_pages(void* p, size_t bytes) {
+    const size_t page = system_page_size();
+    auto* bytes_of = static_cast<volatile unsigned char*>(p);
+    for (size_t offset = 0; offset < bytes; offset += page) bytes_of[offset] = bytes_of[offset];
+}
+
+} // namespace detail
+
+
+// Memory source (the SlabAllocator source interface, slab_allocator.hpp)
+// for the large arrays of a table: bucket arrays, slot arrays and node
+// chunks. Every block is at least cache-line aligned, so a bucket or slot
+// group never straddles two lines at its start.
+//
+// Blocks of mapping_threshold bytes and more are their own anonymous
+// mapping, which huge_pages backs with 2 MiB pages: madvise(MADV_HUGEPAGE)
+// on a 2 MiB-aligned mapping, or MAP_HUGETLB when the hugetlbfs pool has
+// pages to spare (falling back to transparent huge pages otherwise). With
+// prefault, every page of a block is faulted in when it is allocated, so a
+// table that reserve()s up front serves its first requests without page
+// faults. Smaller blocks come from the aligned operator new.
+//
+//     using Nodes = SlabAllocator<std::pair<const int, Row>, 256, PageMemory>;
+//     HashTable<int, Row, 64, std::hash<int>, std::equal_to<int>, PowerOfTwoCapacity, Nodes> table(
+//         std::hash<int>(), std::equal_to<int>(), Nodes(PageMemory{HugePages::transparent, true}));
+//     table.reserve(50'000'000);  // buckets and nodes, all faulted in
+//
+// Blocks must be released through a PageMemory with the same settings.
+// Off Linux, every block comes from operator new and huge pages are ignored.
+struct PageMemory {
+    static constexpr size_t cache_line = 64;
+    static constexpr size_t huge_page_size = size_t{2} << 20;
+    static constexpr size_t mapping_threshold = size_t{64} << 10;
+
+    HugePages huge_pages = HugePages::off;
+    bool prefault = false;
+
+    // Throws std::bad_alloc.
+    void* allocate(size_t bytes, size_t alignment) const {
+        alignment = std::max(alignment, cache_line);
+#if defined(__linux__)
+        if (bytes >= mapping_threshold) return map(bytes, alignment);
+#endif
+        void* p = ::operator new(bytes, std::align_val_t{alignment});
+        if (prefault) detail::touch_pages(p, bytes);
+        return p;
+    }
+
+    void deallocate(void* p, size_t bytes, size_t alignment) const noexcept {
+        alignment = std::max(alignment, cache_line);
+#if defined(__linux__)
+        if (bytes >= mapping_threshold) {
+            ::munmap(p, mapping_size(bytes));
+            return;
+        }
+#endif
+        ::operator delete(p, std::align_val_t{alignment});
+    }
+
+private:
+#if defined(__linux__)
+    // hugetlb mappings are whole huge pages, and so are their fallbacks,
+    // so that deallocate can unmap either without knowing which it got.
+    size_t mapping_size(size_t bytes) const {
+        return detail::round_up(bytes, huge_pages == HugePages::hugetlb ? huge_page_size : detail::system_page_size());
+    }
+
+    void* map(size_t bytes, size_t alignment) const {
+        const size_t size = mapping_size(bytes);
+        if (huge_pages == HugePages::hugetlb && alignment <= huge_page_size) {
+            const int populate = prefault ? MAP_POPULATE : 0;
+            void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | populate, -1, 0);
+            if (p != MAP_FAILED) return p;
+        }
+
+        // Over-map and trim to the alignment: THP only backs 2 MiB-aligned
+        // ranges with huge pages.
+        const size_t page = detail::system_page_size();
+        if (huge_pages != HugePages::off && size >= huge_page_size) alignment = std::max(alignment, huge_page_size);
+        alignment = detail::round_up(alignment, page);
+        const size_t padded = size + alignment - page;
+        void* mapping = ::mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapping == MAP_FAILED) throw std::bad_alloc();
+        const auto start = reinterpret_cast<uintptr_t>(mapping);
+        const uintptr_t aligned = detail::round_up(start, alignment);
+        if (aligned != start) ::munmap(mapping, aligned - start);
+        if (const size_t tail = start + padded - (aligned + size)) {
+            ::munmap(reinterpret_cast<void*>(aligned + size), tail);
+        }
+        void* p = reinterpret_cast<void*>(aligned);
+
+#if defined(MADV_HUGEPAGE)
+        if (huge_pages != HugePages::off) ::madvise(p, size, MADV_HUGEPAGE);
+#endif
+        if (prefault) populate(p, size);
+        return p;
+    }
+
+    static void populate(void* p, size_t size) {
+#if defined(MADV_POPULATE_WRITE)
+        if (::madvise(p, size, MADV_POPULATE_WRITE) == 0) return;
+#endif
+        detail::touch_pages(p, size);
+    }
+#endif
+};
+
+
+#endif // PAGE_MEMORY_HPP
@@ -0,0 +1,56 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// Worker count for a `threads` argument, where 0 means one per hardware
+// thread.
+inline size_t resolve_workers(size_t threads) {
+    if (threads > 0) return threads;
+    const unsigned hardware = std::thread::hardware_concurrency();
+    return hardware > 0 ? hardware : 1;
+}
+
+// Run f(0), ..., f(workers - 1) concurrently and wait for all of them; the
+// calling thread runs f(0). The parallel table operations split their work
+// into equal, independent partitions up front, so there is nothing to
+// balance and no pool to keep around. If workers throw, the first
+// exception is rethrown here after every worker has finished.
+template <typename F>
+void run_parallel(size_t workers, F&& f) {
+    if (workers <= 1) {
+        f(size_t{0});
+        return;
+    }
+
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    auto run = [&](size_t worker) {
+        try {
+            f(worker);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) error = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    try {
+        for (size_t w = 1; w < workers; ++w) threads.emplace_back(run, w);
+    } catch (...) {
+        for (auto& thread : threads) thread.join();
+        throw;
+    }
+    run(0);
+    for (auto& thread : threads) thread.join();
+    if (error) std::rethrow_exception(error);
+}
+
+
+#endif // PARALLEL_HPP
@@ -0,0 +1,197 @@
+#ifndef PERFECT_HASH_TABLE_HPP
+#define PERFECT_HASH_TABLE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+#include "capacity_policy.hpp"
+#include "hash_policy.hpp"
+#include "static_hash_table.hpp"
+
+
+// Minimal perfect hash table for a static key set, built at compile time.
+//
+// Construction follows the PTHash/CHD scheme: keys are split into small
+// buckets, and for each bucket (largest first) a 32-bit pilot is searched so
+// that every key of the bucket lands in a free slot at
+//
+//     h    = mix(hash ^ seed)
+//     slot = fastrange(mix(h, mix(pilot)), base_size)
+//
+// where the bucket is fastrange(h, num_buckets) and mix(pilot) is what the
+// table stores.
+//
+// If some bucket cannot be placed the whole search restarts with a new seed.
+// The result has exactly base_size slots (one per key when the table is
+// full), and a lookup is one pilot load, one slot probe and one key compare.
+template <typename K, typename V, size_t base_size, typename Hash = hash_policy::WyHash>
+class PerfectHashTable {
+    static_assert(base_size > 0, "PerfectHashTable needs at least one slot");
+
+public:
+    // About two keys per bucket keeps the pilot search short even when the
+    // table is completely full, at a cost of four bytes of pilots per key
+    // (stored pre-mixed, so a lookup does not hash the pilot again).
+    static constexpr size_t num_buckets = base_size / 2 + 1;
+
+private:
+    static constexpr uint32_t max_pilot = 1u << 20;
+    static constexpr uint64_t max_seeds = 64;
+
+    std::array<StaticNode<K, V>, base_size> base_array{};
+    std::array<uint64_t, num_buckets> pilots{};
+    uint64_t seed = 0;
+    size_t num_entries = 0;
+
+    static constexpr uint64_t seeded_hash(const K& key, uint64_t seed) {
+        return hash_policy::mix(static_cast<uint64_t>(Hash{}(key)) ^ seed);
+    }
+
+    static constexpr size_t bucket_of(uint64_t h) { return fastrange(h, num_buckets); }
+
+    static constexpr size_t slot_of(uint64_t h, uint64_t mixed_pilot) {
+        return fastrange(hash_policy::detail::wymix(h, mixed_pilot), base_size);
+    }
+
+    constexpr size_t slot_of(uint64_t h) const { return slot_of(h, pilots[bucket_of(h)]); }
+
+    // One attempt at placing every key with the given seed. Returns false if
+    // some bucket needs a pilot beyond max_pilot.
+    constexpr bool try_build(const std::pair<K, V>* pairs, size_t n, uint64_t try_seed) {
+        std::array<uint64_t, base_size> hashes{};
+        std::array<size_t, num_buckets + 1> bucket_start{};
+        std::array<size_t, base_size> members{};
+        std::array<size_t, num_buckets> order{};
+        std::array<bool, base_size> taken{};
+        std::array<size_t, base_size> slots{};  // of the bucket being placed
+
+        for (size_t i = 0; i < n; ++i) {
+            hashes[i] = seeded_hash(pairs[i].first, try_seed);
+            ++bucket_start[bucket_of(hashes[i]) + 1];
+        }
+
+        // Group the keys by bucket (counting sort).
+        for (size_t b = 0; b < num_buckets; ++b) bucket_start[b + 1] += bucket_start[b];
+        {
+            std::array<size_t, num_buckets> fill{};
+            for (size_t i = 0; i < n; ++i) {
+                size_t b = bucket_of(hashes[i]);
+                members[bucket_start[b] + fill[b]++] = i;
+            }
+        }
+
+        // Keys of one bucket must differ in their seeded hash, otherwise no
+        // pilot can separate them.
+        for (size_t b = 0; b < num_buckets; ++b) {
+            for (size_t i = bucket_start[b]; i < bucket_start[b + 1]; ++i) {
+                for (size_t j = i + 1; j < bucket_start[b + 1]; ++j) {
+                    if (hashes[members[i]] == hashes[members[j]]) {
+                        if (pairs[members[i]].first == pairs[members[j]].first) {
+                            throw std::logic_error("Duplicate key in perfect hash construction.");
+                        }
+                        return false;
+                    }
+                }
+            }
+        }
+
+        auto bucket_size = [&](size_t b) { return bucket_start[b + 1] - bucket_start[b]; };
+        for (size_t b = 0; b < num_buckets; ++b) order[b] = b;
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return bucket_size(a) != bucket_size(b) ? bucket_size(a) > bucket_size(b) : a < b;
+        });
+
+        pilots = {};
+        for (size_t b : order) {
+            const size_t first = bucket_start[b], count = bucket_size(b);
+            if (count == 0) break;
+
+            uint32_t pilot = 0;
+            for (; pilot < max_pilot; ++pilot) {
+                const uint64_t mixed_pilot = hash_policy::wyhash(uint64_t{pilot});
+                bool fits = true;
+                for (size_t m = 0; m < count && fits; ++m) {
+                    slots[m] = slot_of(hashes[members[first + m]], mixed_pilot);
+                    fits = !taken[slots[m]];
+                    for (size_t o = 0; o < m && fits; ++o) fits = slots[o] != slots[m];
+                }
+                if (fits) break;
+            }
+            if (pilot == max_pilot) return false;
+
+            pilots[b] = hash_policy::wyhash(uint64_t{pilot});
+            for (size_t m = 0; m < count; ++m) taken[slots[m]] = true;
+        }
+
+        base_array = {};
+        for (size_t i = 0; i < n; ++i) {
+            const auto& [key, value] = pairs[i];
+            uint64_t h = seeded_hash(key, try_seed);
+            auto& slot = base_array[slot_of(h)];
+            slot.key = key;
+            slot.value = value;
+            slot.occupied = true;
+        }
+        seed = try_seed;
+        num_entries = n;
+        return true;
+    }
+
+public:
+    constexpr PerfectHashTable() = default;
+
+    constexpr size_t size() const { return num_entries; }
+    static constexpr size_t capacity() { return base_size; }
+
+    // Retrieve the value associated with a key
+    constexpr std::optional<std::reference_wrapper<const V>> get(const K& key) const {
+        return get_hashed(key, hash_of(key));
+    }
+
+    // The seeded hash a lookup probes with, and a lookup reusing it; lets a
+    // caller derive more from the one hash (OverlayHashTable's filter).
+    constexpr uint64_t hash_of(const K& key) const { return seeded_hash(key, seed); }
+
+    constexpr std::optional<std::reference_wrapper<const V>> get_hashed(const K& key, uint64_t h) const {
+        const auto& slot = base_array[slot_of(h)];
+        if (slot.occupied && slot.key == key) {
+            return std::cref(slot.value);
+        }
+        return std::nullopt;  // Key not found
+    }
+
+    constexpr bool contains(const K& key) const { return get(key).has_value(); }
+
+    // Build a collision-free table from pairs. Any key set of at most
+    // base_size distinct keys is accepted; duplicates or a failed seed search
+    // throw, which is a compile error inside a constant expression.
+    static constexpr PerfectHashTable from_nice_pairs(const std::pair<K, V>* pairs, size_t n) {
+        if (n > base_size) {
+            throw std::length_error("More keys than slots in perfect hash construction.");
+        }
+
+        PerfectHashTable table;
+        for (uint64_t s = 0; s < max_seeds; ++s) {
+            if (table.try_build(pairs, n, s)) return table;
+        }
+        throw std::runtime_error("No perfect hash found for the given keys.");
+    }
+
+    static constexpr PerfectHashTable from_nice_pairs(std::initializer_list<std::pair<K, V>> pairs) {
+        return from_nice_pairs(pairs.begin(), pairs.size());
+    }
+
+    template <size_t count>
+    static constexpr PerfectHashTable from_nice_pairs(const std::array<std::pair<K, V>, count>& pairs) {
+        return from_nice_pairs(pairs.data(), count);
+    }
+};
+
+
+#endif // PERFECT_HASH_TABLE_HPP
@@ -0,0 +1,194 @@
+#ifndef SHARDED_HASH_TABLE_HPP
+#define SHARDED_HASH_TABLE_HPP
+
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "capacity_policy.hpp"
+#include "hash_policy.hpp"
+#include "hash_table.hpp"
+
+
+// Hash table for write-heavy workloads shared between threads.
+//
+// The key space is split over num_shards independent HashTables, each on
+// its own cache line with its own mutex, so threads touching different
+// shards never contend. Shards keep their own entry count and grow (and
+// migrate incrementally) on their own; there is no table-wide counter or
+// grow().
+//
+// A key is hashed once. Capacity::partition picks the shard from the bits
+// the in-shard index depends on least (the top bits with power-of-two
+// masking, the low bits with fastrange), and the same hash is handed to
+// the shard, so every shard still uses all of its buckets.
+//
+// Values are returned by copy since a reference would outlive the shard
+// lock; visit() runs a callback on the value under the lock instead.
+template <typename K, typename V, size_t base_size, size_t num_shards = 64,
+          typename Hash = hash_policy::DefaultHash<K>,
+          typename KeyEqual = hash_policy::DefaultKeyEqual<K>,
+          typename Capacity = PowerOfTwoCapacity,
+          typename Allocator = std::allocator<std::pair<const K, V>>>
+class ShardedHashTable {
+    static_assert(std::has_single_bit(num_shards), "num_shards must be a power of two");
+
+    using Table = HashTable<K, V, base_size, Hash, KeyEqual, Capacity, Allocator>;
+
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        Table table;
+    };
+
+    template <typename Q>
+    static constexpr bool lookup_with =
+        hash_policy::is_transparent_v<Hash, KeyEqual> && !std::is_same_v<Q, K>;
+
+    [[no_unique_address]] Hash hasher;
+    std::unique_ptr<Shard[]> shards;
+
+    template <typename Q>
+    size_t hash_of(const Q& key) const {
+        if constexpr (Table::direct) return direct_index(key);
+        return static_cast<size_t>(hash_policy::finalize<Hash>(static_cast<uint64_t>(hasher(key))));
+    }
+
+    // Direct keys are unhashed indices below 2^16; partition reads the top
+    // bits with power-of-two masking, so they are mixed first.
+    Shard& shard_for(size_t hash) const {
+        if constexpr (Table::direct) hash = static_cast<size_t>(hash_policy::mix(hash));
+        return shards[Capacity::partition(hash, num_shards)];
+    }
+
+    template <typename KArg, typename... Args>
+    bool try_emplace_impl(KArg&& key, Args&&... args) {
+        size_t hash = hash_of(key);
+        Shard& shard = shard_for(hash);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.table.try_emplace_hashed(hash, std::forward<KArg>(key),
+                                              std::forward<Args>(args)...).second;
+    }
+
+    template <typename KArg, typename M>
+    bool insert_or_assign_impl(KArg&& key, M&& obj) {
+        size_t hash = hash_of(key);
+        Shard& shard = shard_for(hash);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto result = shard.table.try_emplace_hashed(hash, std::forward<KArg>(key), std::forward<M>(obj));
+        if (!result.second) result.first = std::forward<M>(obj);
+        return result.second;
+    }
+
+    template <typename Q, typename F>
+    bool visit_impl(const Q& key, F&& f) const {
+        size_t hash = hash_of(key);
+        Shard& shard = shard_for(hash);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto value = shard.table.template get_impl<V>(key, hash);
+        if (!value) return false;
+        std::forward<F>(f)(value->get());
+        return true;
+    }
+
+    template <typename Q>
+    std::optional<V> get_impl(const Q& key) const {
+        std::optional<V> result;
+        visit_impl(key, [&](const V& value) { result.emplace(value); });
+        return result;
+    }
+
+    template <typename Q>
+    bool erase_impl(const Q& key) {
+        size_t hash = hash_of(key);
+        Shard& shard = shard_for(hash);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.table.erase_impl(key, hash);
+    }
+
+public:
+    ShardedHashTable() : shards(std::make_unique<Shard[]>(num_shards)) {}
+
+    explicit ShardedHashTable(const Hash& hash, const KeyEqual& equal = KeyEqual(),
+                              const Allocator& alloc = Allocator())
+        : hasher(hash), shards(std::make_unique<Shard[]>(num_shards)) {
+        for (size_t i = 0; i < num_shards; ++i) {
+            shards[i].table = Table(hash, equal, alloc);
+        }
+    }
+
+    ShardedHashTable(const ShardedHashTable&) = delete;
+    ShardedHashTable& operator=(const ShardedHashTable&) = delete;
+
+    static constexpr size_t shard_count() { return num_shards; }
+
+    // Sum over the shards, each read under its lock; a snapshot while
+    // writers are active.
+    size_t size() const {
+        size_t total = 0;
+        for (size_t i = 0; i < num_shards; ++i) {
+            std::lock_guard<std::mutex> lock(shards[i].mutex);
+            total += shards[i].table.size();
+        }
+        return total;
+    }
+
+    // Insert a key-value pair if the key is absent. Returns whether it was
+    // inserted; an existing key keeps its value.
+    bool insert(const K& key, const V& value) { return try_emplace_impl(key, value); }
+    bool insert(K&& key, V&& value) { return try_emplace_impl(std::move(key), std::move(value)); }
+
+    // Construct the value in place from args if key is absent.
+    template <typename... Args>
+    bool try_emplace(const K& key, Args&&... args) {
+        return try_emplace_impl(key, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    bool try_emplace(K&& key, Args&&... args) {
+        return try_emplace_impl(std::move(key), std::forward<Args>(args)...);
+    }
+
+    // Insert, or assign to the existing value. Returns whether the key was
+    // inserted.
+    template <typename M>
+    bool insert_or_assign(const K& key, M&& obj) {
+        return insert_or_assign_impl(key, std::forward<M>(obj));
+    }
+
+    template <typename M>
+    bool insert_or_assign(K&& key, M&& obj) {
+        return insert_or_assign_impl(std::move(key), std::forward<M>(obj));
+    }
+
+    // Copy of the value associated with a key
+    std::optional<V> get(const K& key) const { return get_impl(key); }
+
+    template <typename Q> requires lookup_with<Q>
+    std::optional<V> get(const Q& key) const { return get_impl(key); }
+
+    // Call f(V&) on the value of `key` while holding its shard's lock, e.g.
+    // to update it in place. Returns whether the key was found.
+    template <typename F>
+    bool visit(const K& key, F&& f) { return visit_impl(key, std::forward<F>(f)); }
+
+    template <typename Q, typename F> requires lookup_with<Q>
+    bool visit(const Q& key, F&& f) { return visit_impl(key, std::forward<F>(f)); }
+
+    bool contains(const K& key) const { return visit_impl(key, [](const V&) {}); }
+
+    template <typename Q> requires lookup_with<Q>
+    bool contains(const Q& key) const { return visit_impl(key, [](const V&) {}); }
+
+    // Remove the key-value pair associated with a key
+    bool erase(const K& key) { return erase_impl(key); }
+
+    template <typename Q> requires lookup_with<Q>
+    bool erase(const Q& key) { return erase_impl(key); }
+};
+
+
+#endif // SHARDED_HASH_TABLE_HPP
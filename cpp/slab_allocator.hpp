@@ -0,0 +1,184 @@
+#ifndef SLAB_ALLOCATOR_HPP
+#define SLAB_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+// Where a SlabAllocator gets its memory from: the global operator new.
+// Other sources (e.g. NumaMemory in numa.hpp) provide the same two calls
+// and may carry state, which every copy and rebind of the allocator keeps.
+struct HeapMemory {
+    static void* allocate(size_t bytes, size_t alignment) {
+        return ::operator new(bytes, std::align_val_t{alignment});
+    }
+
+    static void deallocate(void* p, size_t, size_t alignment) noexcept {
+        ::operator delete(p, std::align_val_t{alignment});
+    }
+};
+
+
+// Standard-conforming allocator that carves single objects out of
+// contiguous chunks and recycles freed ones through an intrusive free list.
+//
+// Copies share one arena; the chunks are released together when the last
+// copy goes away, in O(chunks). Rebinding to another type starts a new,
+// empty arena, since the slot size changes with the type. Requests for more
+// than one object (bucket arrays and the like) bypass the arena and go
+// straight to the Source.
+template <typename T, size_t nodes_per_chunk = 256, typename Source = HeapMemory>
+class SlabAllocator {
+    static_assert(nodes_per_chunk > 0, "a chunk needs at least one slot");
+
+    union Slot {
+        Slot* next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    struct Chunk {
+        Chunk* prev;
+        Slot slots[nodes_per_chunk];
+    };
+
+    struct Arena {
+        [[no_unique_address]] Source source;
+        Chunk* chunks = nullptr;
+        Slot* free_list = nullptr;
+        size_t free_count = 0;
+        size_t used_in_chunk = nodes_per_chunk;  // bump index into `chunks`
+
+        explicit Arena(const Source& s) : source(s) {}
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        ~Arena() {
+            while (chunks) {
+                Chunk* prev = chunks->prev;
+                source.deallocate(chunks, sizeof(Chunk), alignof(Chunk));
+                chunks = prev;
+            }
+        }
+
+        void* take() {
+            if (free_list) {
+                Slot* slot = free_list;
+                free_list = slot->next;
+                --free_count;
+                return slot;
+            }
+            if (used_in_chunk == nodes_per_chunk) {
+                Chunk* chunk = ::new (source.allocate(sizeof(Chunk), alignof(Chunk))) Chunk;
+                chunk->prev = chunks;
+                chunks = chunk;
+                used_in_chunk = 0;
+            }
+            return &chunks->slots[used_in_chunk++];
+        }
+
+        void give_back(void* p) {
+            Slot* slot = static_cast<Slot*>(p);
+            slot->next = free_list;
+            free_list = slot;
+            ++free_count;
+        }
+
+        // Chunks for n more take()s, their slots threaded onto the free
+        // list, which also faults every page of them in. New chunks go
+        // behind the one being bumped through.
+        void reserve(size_t n) {
+            size_t available = free_count + (nodes_per_chunk - used_in_chunk);
+            for (; available < n; available += nodes_per_chunk) {
+                Chunk* chunk = ::new (source.allocate(sizeof(Chunk), alignof(Chunk))) Chunk;
+                if (chunks) {
+                    chunk->prev = chunks->prev;
+                    chunks->prev = chunk;
+                } else {
+                    chunk->prev = nullptr;
+                    chunks = chunk;
+                }
+                for (size_t i = nodes_per_chunk; i-- > 0;) give_back(&chunk->slots[i]);
+            }
+        }
+    };
+
+    template <typename U, size_t, typename>
+    friend class SlabAllocator;
+
+    std::shared_ptr<Arena> arena;
+
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    // Tables holding the only copy (sole_owner()) may skip per-node
+    // deallocation on destruction: the arena reclaims every chunk at once.
+    using is_arena = std::true_type;
+
+    template <typename U>
+    struct rebind {
+        using other = SlabAllocator<U, nodes_per_chunk, Source>;
+    };
+
+    SlabAllocator() : SlabAllocator(Source()) {}
+
+    explicit SlabAllocator(const Source& source) : arena(std::make_shared<Arena>(source)) {}
+
+    // Moving copies, so a moved-from allocator keeps working on the same arena.
+    SlabAllocator(const SlabAllocator&) = default;
+    SlabAllocator& operator=(const SlabAllocator&) = default;
+
+    template <typename U>
+    SlabAllocator(const SlabAllocator<U, nodes_per_chunk, Source>& other) : SlabAllocator(other.source()) {}
+
+    const Source& source() const { return arena->source; }
+
+    // Whether no other copy shares this arena, so that destroying this one
+    // releases the arena.
+    bool sole_owner() const { return arena.use_count() == 1; }
+
+    static constexpr size_t max_size() { return static_cast<size_t>(PTRDIFF_MAX) / sizeof(T); }
+
+    T* allocate(size_t n) {
+        if (n != 1) {
+            if (n > max_size()) throw std::bad_array_new_length();
+            return static_cast<T*>(arena->source.allocate(n * sizeof(T), alignof(T)));
+        }
+        return static_cast<T*>(arena->take());
+    }
+
+    // Set aside memory for n more single-object allocations, so they neither
+    // allocate nor page-fault. HashTable::reserve calls this for its nodes.
+    void reserve(size_t n) { arena->reserve(n); }
+
+    void deallocate(T* p, size_t n) noexcept {
+        if (n != 1) {
+            arena->source.deallocate(p, n * sizeof(T), alignof(T));
+            return;
+        }
+        arena->give_back(p);
+    }
+
+    friend bool operator==(const SlabAllocator& a, const SlabAllocator& b) { return a.arena == b.arena; }
+    friend bool operator!=(const SlabAllocator& a, const SlabAllocator& b) { return a.arena != b.arena; }
+};
+
+
+// True for allocators that release all their memory when destroyed, so a
+// container holding the only copy (sole_owner()) need not return elements
+// one by one.
+template <typename A, typename = void>
+struct allocator_is_arena : std::false_type {};
+
+template <typename A>
+struct allocator_is_arena<A, std::void_t<typename A::is_arena>> : A::is_arena {};
+
+
+#endif // SLAB_ALLOCATOR_HPP
@@ -0,0 +1,80 @@
+#ifndef STATIC_HASH_TABLE_HPP
+#define STATIC_HASH_TABLE_HPP
+
+#include <array>
+#include <functional>
+#include <initializer_list>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+#include "hash_policy.hpp"
+
+
+// Slot of a StaticHashTable. Unlike HashNode it owns no heap memory, so a
+// table made of these is a literal type and can live in constant memory.
+template <typename K, typename V>
+struct StaticNode {
+    K key{};
+    V value{};
+    bool occupied = false;
+};
+
+
+// Fixed-size table that is built entirely at compile time.
+//
+// Every key lives in its home slot `Hash(key) % base_size`; there is no
+// chaining, so the layout is a flat array of StaticNode and a lookup is one
+// probe and one key compare. K and V must be literal types (integers,
+// enums, std::string_view, ...). When declared `constexpr`/`constinit` the
+// whole table is emitted into the binary's read-only data.
+template <typename K, typename V, size_t base_size, typename Hash = hash_policy::WyHash>
+class StaticHashTable {
+    std::array<StaticNode<K, V>, base_size> base_array{};
+    size_t num_entries = 0;
+
+    static constexpr size_t index_of(const K& key) {
+        return static_cast<size_t>(Hash{}(key) % base_size);
+    }
+
+public:
+    constexpr StaticHashTable() = default;
+
+    constexpr size_t size() const { return num_entries; }
+    static constexpr size_t capacity() { return base_size; }
+
+    // Retrieve the value associated with a key
+    constexpr std::optional<std::reference_wrapper<const V>> get(const K& key) const {
+        const auto& slot = base_array[index_of(key)];
+        if (slot.occupied && slot.key == key) {
+            return std::cref(slot.value);
+        }
+        return std::nullopt;  // Key not found
+    }
+
+    constexpr bool contains(const K& key) const { return get(key).has_value(); }
+
+    // Build the table from pairs. A collision is reported by throwing, which
+    // turns into a compile error when evaluated in a constant expression.
+    static constexpr StaticHashTable from_nice_pairs(std::initializer_list<std::pair<K, V>> pairs) {
+        StaticHashTable table;
+
+        for (const auto& [key, value] : pairs) {
+            auto& slot = table.base_array[index_of(key)];
+
+            if (!slot.occupied) {
+                slot.key = key;
+                slot.value = value;
+                slot.occupied = true;
+                ++table.num_entries;
+            } else {
+                throw std::logic_error("Collision detected during constexpr construction.");
+            }
+        }
+
+        return table;
+    }
+};
+
+
+#endif // STATIC_HASH_TABLE_HPP
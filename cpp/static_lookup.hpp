@@ -0,0 +1,179 @@
+#ifndef STATIC_LOOKUP_HPP
+#define STATIC_LOOKUP_HPP
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "ctrl_group.hpp"
+#include "hash_policy.hpp"
+#include "perfect_hash_table.hpp"
+
+
+// How a StaticLookup resolves a key.
+enum class LookupStrategy {
+    compare_chain,  // unrolled compare against every key, no branches on a miss
+    simd_scan,      // all keys compared at once, 4 or 2 per SSE2 register
+    perfect_hash,   // PerfectHashTable: one probe and one compare
+};
+
+// Default strategy for N keys of type K. With SSE2, 4- and 8-byte integer
+// keys are scanned up to a few registers' worth, which beats both compares
+// and hashing; otherwise a handful of compares beats hashing, and beyond
+// that a perfect hash wins. Keys the compile-time hashers cannot hash keep
+// the compare chain.
+template <typename K>
+inline constexpr bool simd_scan_key_v =
+    hash_policy::is_integral_key_v<K> && (sizeof(K) == 4 || sizeof(K) == 8);
+
+template <typename K, size_t N>
+inline constexpr LookupStrategy default_lookup_strategy =
+#if defined(CTRL_GROUP_SSE2)
+    simd_scan_key_v<K> && N <= 32 ? LookupStrategy::simd_scan :
+#endif
+    N <= 8 ? LookupStrategy::compare_chain
+    : hash_policy::is_integral_key_v<K> || std::is_convertible_v<const K&, std::string_view>
+        ? LookupStrategy::perfect_hash
+        : LookupStrategy::compare_chain;
+
+
+// Lookup routine specialized for a fixed key set, built at compile time
+// like StaticHashTable and PerfectHashTable:
+//
+//     constexpr auto colors = make_static_lookup<std::string_view, int>({
+//         {"red", 1}, {"green", 2}, {"blue", 3}});
+//     static_assert(colors.get("green")->get() == 2);
+//
+// The keys are template-sized arrays inside a constexpr object, so the
+// compare chain unrolls into compares against immediates and the scan into
+// straight-line vector code. Any strategy can be forced through the last
+// template parameter, except that simd_scan requires 4- or 8-byte integer
+// or enum keys.
+template <typename K, typename V, size_t N,
+          LookupStrategy strategy = default_lookup_strategy<K, N>>
+class StaticLookup {
+    static_assert(N > 0, "StaticLookup needs at least one key");
+    static_assert(strategy != LookupStrategy::simd_scan || simd_scan_key_v<K>,
+                  "simd_scan needs 4- or 8-byte integer or enum keys");
+    static_assert(strategy != LookupStrategy::simd_scan || N <= 64,
+                  "simd_scan reports matches in a 64-bit mask");
+
+    static constexpr bool hashed = strategy == LookupStrategy::perfect_hash;
+
+    // The scan reads whole 16-byte registers; tail lanes repeat the first key
+    // and are masked off.
+    static constexpr size_t lanes = 16 / sizeof(K);
+    static constexpr size_t stored_keys =
+        hashed ? 0 : strategy == LookupStrategy::simd_scan ? (N + lanes - 1) / lanes * lanes : N;
+
+    using Table = std::conditional_t<hashed, PerfectHashTable<K, V, N>, std::monostate>;
+
+    alignas(16) std::array<K, stored_keys> keys{};
+    std::array<V, hashed ? 0 : N> values{};
+    Table table{};
+
+    template <size_t... I>
+    constexpr size_t find_chain(const K& key, std::index_sequence<I...>) const {
+        size_t found = N;
+        ((found = keys[I] == key ? I : found), ...);
+        return found;
+    }
+
+    constexpr size_t find_scan(const K& key) const {
+        uint64_t mask = 0;
+#if defined(CTRL_GROUP_SSE2)
+        if (!std::is_constant_evaluated()) {
+            const __m128i needle = sizeof(K) == 4
+                ? _mm_set1_epi32(static_cast<int32_t>(key))
+                : _mm_set1_epi64x(static_cast<int64_t>(key));
+            for (size_t i = 0; i < stored_keys; i += lanes) {
+                __m128i eq = _mm_cmpeq_epi32(
+                    _mm_load_si128(reinterpret_cast<const __m128i*>(&keys[i])), needle);
+                uint64_t bits;
+                if constexpr (sizeof(K) == 4) {
+                    bits = static_cast<uint64_t>(_mm_movemask_ps(_mm_castsi128_ps(eq)));
+                } else {
+                    // 64-bit lanes match when both 32-bit halves do.
+                    eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+                    bits = static_cast<uint64_t>(_mm_movemask_pd(_mm_castsi128_pd(eq)));
+                }
+                mask |= bits << i;
+            }
+            if constexpr (N < 64) mask &= (uint64_t{1} << N) - 1;
+            return mask ? static_cast<size_t>(std::countr_zero(mask)) : N;
+        }
+#endif
+        for (size_t i = 0; i < N; ++i) mask |= uint64_t{keys[i] == key} << i;
+        return mask ? static_cast<size_t>(std::countr_zero(mask)) : N;
+    }
+
+    constexpr size_t find(const K& key) const {
+        if constexpr (strategy == LookupStrategy::simd_scan) {
+            return find_scan(key);
+        } else {
+            return find_chain(key, std::make_index_sequence<N>{});
+        }
+    }
+
+public:
+    constexpr StaticLookup() = default;
+
+    static constexpr LookupStrategy lookup_strategy() { return strategy; }
+    static constexpr size_t size() { return N; }
+
+    // Retrieve the value associated with a key
+    constexpr std::optional<std::reference_wrapper<const V>> get(const K& key) const {
+        if constexpr (hashed) {
+            return table.get(key);
+        } else {
+            size_t i = find(key);
+            if (i == N) return std::nullopt;  // Key not found
+            return std::cref(values[i]);
+        }
+    }
+
+    constexpr bool contains(const K& key) const { return get(key).has_value(); }
+
+    // Build from exactly N distinct pairs; a duplicate key throws, which is
+    // a compile error inside a constant expression.
+    static constexpr StaticLookup from_nice_pairs(const std::array<std::pair<K, V>, N>& pairs) {
+        StaticLookup lookup;
+        if constexpr (hashed) {
+            lookup.table = Table::from_nice_pairs(pairs);
+        } else {
+            for (size_t i = 0; i < N; ++i) {
+                for (size_t j = 0; j < i; ++j) {
+                    if (pairs[j].first == pairs[i].first) {
+                        throw std::logic_error("Duplicate key in StaticLookup construction.");
+                    }
+                }
+                lookup.keys[i] = pairs[i].first;
+                lookup.values[i] = pairs[i].second;
+            }
+            for (size_t i = N; i < stored_keys; ++i) lookup.keys[i] = pairs[0].first;
+        }
+        return lookup;
+    }
+};
+
+// Deduce N from a braced list of pairs.
+template <typename K, typename V, size_t N>
+constexpr auto make_static_lookup(const std::pair<K, V> (&pairs)[N]) {
+    return StaticLookup<K, V, N>::from_nice_pairs(std::to_array(pairs));
+}
+
+template <LookupStrategy strategy, typename K, typename V, size_t N>
+constexpr auto make_static_lookup(const std::pair<K, V> (&pairs)[N]) {
+    return StaticLookup<K, V, N, strategy>::from_nice_pairs(std::to_array(pairs));
+}
+
+
+#endif // STATIC_LOOKUP_HPP
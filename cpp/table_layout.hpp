@@ -0,0 +1,79 @@
+#ifndef TABLE_LAYOUT_HPP
+#define TABLE_LAYOUT_HPP
+
+#include <cstddef>
+#include <type_traits>
+
+
+// How a HashTable stores its base tier, picked at compile time from K, V
+// and base_size by table_layout_traits:
+//
+//   inline_base  base slots are bare {key, value} entries plus an occupancy
+//                bit, so the first entry of a base bucket needs no
+//                allocation. Entries move between slots and overflow nodes
+//                as buckets fill, empty and migrate.
+//   node_base    base slots are chain heads, like heap buckets: every entry
+//                lives in a node and never moves once built, so K and V
+//                need not be movable and references stay valid across
+//                growth. An empty slot costs one pointer instead of an
+//                entry.
+//   direct       the key is its own bucket index. Only for integer or enum
+//                keys whose every value has a base slot: no hashing, no
+//                collisions and no growth.
+enum class TableLayout {
+    inline_base,
+    node_base,
+    direct,
+};
+
+namespace detail {
+
+template <typename K>
+constexpr size_t direct_key_range() {
+    if constexpr (std::is_enum_v<K>) {
+        return direct_key_range<std::underlying_type_t<K>>();
+    } else if constexpr (std::is_integral_v<K> && !std::is_same_v<K, bool> && sizeof(K) <= 2) {
+        return size_t{1} << (8 * sizeof(K));
+    } else {
+        return 0;
+    }
+}
+
+} // namespace detail
+
+// Number of distinct values of an integer or enum key of at most 16 bits,
+// which direct tables index by; 0 for any other key.
+template <typename K>
+inline constexpr size_t direct_key_range_v = detail::direct_key_range<K>();
+
+// Bucket of a key in a direct table: the key's bits as an unsigned integer.
+template <typename K>
+constexpr size_t direct_index(K key) {
+    using Integer = typename std::conditional_t<std::is_enum_v<K>, std::underlying_type<K>,
+                                                std::type_identity<K>>::type;
+    return static_cast<size_t>(static_cast<std::make_unsigned_t<Integer>>(key));
+}
+
+// Layout of HashTable<K, V, base_size, ...>. The default is direct when
+// every key value has a base slot; node_base for entries larger than a
+// cache line, whose empty base slots would waste the most, and for keys or
+// values without non-throwing moves, which inline slots rely on; otherwise
+// inline_base. Specialize it to force a layout for particular types:
+//
+//     template <size_t n>
+//     struct table_layout_traits<int, Session, n> {
+//         static constexpr TableLayout layout = TableLayout::node_base;
+//     };
+template <typename K, typename V, size_t base_size>
+struct table_layout_traits {
+    static constexpr TableLayout layout =
+        direct_key_range_v<K> != 0 && direct_key_range_v<K> <= base_size ? TableLayout::direct
+        : sizeof(K) + sizeof(V) > 64 ? TableLayout::node_base
+        : !std::is_nothrow_move_constructible_v<K> || !std::is_nothrow_move_assignable_v<K> ||
+          !std::is_nothrow_move_constructible_v<V> || !std::is_nothrow_move_assignable_v<V>
+            ? TableLayout::node_base
+            : TableLayout::inline_base;
+};
+
+
+#endif // TABLE_LAYOUT_HPP
@@ -0,0 +1,178 @@
+#ifndef TABLE_STATS_HPP
+#define TABLE_STATS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+
+
+// Instrumentation of a HashTable (its Stats parameter). The table reports
+// events to the policy:
+//
+//   on_lookup(probes, hit)   get/contains compared `probes` keys
+//   on_insert(probes)        insert/try_emplace/emplace compared `probes`
+//                            keys before inserting (or finding the key)
+//   on_grow(duration)        one resize (grow(), reserve(), rehash(), an
+//                            automatic grow or shrink, ...), timed
+//   on_allocate(bytes)       overflow nodes allocated / freed
+//   on_free(bytes)
+//   on_allocate_buckets(bytes)  heap bucket arrays allocated / freed
+//   on_free_buckets(bytes)
+//   on_clear()               the table released all its memory
+//
+// NoTableStats, the default, ignores everything: its members are empty
+// inline functions, it takes no space, and the probe counts fed to it are
+// dead code the compiler drops. TableStats records everything.
+
+// Snapshot returned by HashTable::stats().
+struct TableStatsSnapshot {
+    // probes[i]: operations that compared i keys; the last bucket counts
+    // histogram_size - 1 or more.
+    static constexpr size_t histogram_size = 16;
+    using Histogram = std::array<uint64_t, histogram_size>;
+
+    Histogram lookup_probes{};
+    Histogram insert_probes{};
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t grows = 0;
+    std::chrono::nanoseconds grow_time{0};
+    uint64_t node_bytes = 0;    // live overflow nodes
+    uint64_t bucket_bytes = 0;  // live heap bucket arrays
+    size_t size = 0;
+    size_t bucket_count = 0;
+    double load_factor = 0;
+
+    double hit_ratio() const {
+        const uint64_t lookups = hits + misses;
+        return lookups ? static_cast<double>(hits) / static_cast<double>(lookups) : 0;
+    }
+
+    // Call f(name, value) for every scalar metric and every non-empty
+    // histogram bucket ("lookup_probes.3", ...), e.g. to export them.
+    template <typename F>
+    void for_each_metric(F&& f) const {
+        f("size", static_cast<double>(size));
+        f("bucket_count", static_cast<double>(bucket_count));
+        f("load_factor", load_factor);
+        f("hits", static_cast<double>(hits));
+        f("misses", static_cast<double>(misses));
+        f("hit_ratio", hit_ratio());
+        f("grows", static_cast<double>(grows));
+        f("grow_seconds", std::chrono::duration<double>(grow_time).count());
+        f("node_bytes", static_cast<double>(node_bytes));
+        f("bucket_bytes", static_cast<double>(bucket_bytes));
+        const char* digits[] = {"0", "1", "2", "3", "4", "5", "6", "7",
+                                "8", "9", "10", "11", "12", "13", "14", "15+"};
+        static_assert(std::size(digits) == histogram_size);
+        for (size_t i = 0; i < histogram_size; ++i) {
+            if (lookup_probes[i]) {
+                f(std::string("lookup_probes.") + digits[i], static_cast<double>(lookup_probes[i]));
+            }
+        }
+        for (size_t i = 0; i < histogram_size; ++i) {
+            if (insert_probes[i]) {
+                f(std::string("insert_probes.") + digits[i], static_cast<double>(insert_probes[i]));
+            }
+        }
+    }
+};
+
+
+struct NoTableStats {
+    static constexpr bool enabled = false;
+
+    void on_lookup(size_t, bool) {}
+    void on_insert(size_t) {}
+    void on_grow(std::chrono::nanoseconds) {}
+    void on_allocate(size_t) {}
+    void on_free(size_t) {}
+    void on_allocate_buckets(size_t) {}
+    void on_free_buckets(size_t) {}
+    void on_clear() {}
+
+    void fill(TableStatsSnapshot&) const {}
+};
+
+
+// Counts with relaxed atomics, so const lookups may still run concurrently
+// (e.g. under a shared lock) even though they update the counters.
+class TableStats {
+    using Counter = std::atomic<uint64_t>;
+    static constexpr size_t histogram_size = TableStatsSnapshot::histogram_size;
+
+    std::array<Counter, histogram_size> lookup_probes{};
+    std::array<Counter, histogram_size> insert_probes{};
+    Counter hits{0};
+    Counter misses{0};
+    Counter grows{0};
+    Counter grow_nanoseconds{0};
+    Counter node_bytes{0};
+    Counter bucket_bytes{0};
+
+    static void add(Counter& counter, uint64_t n) { counter.fetch_add(n, std::memory_order_relaxed); }
+    static uint64_t read(const Counter& counter) { return counter.load(std::memory_order_relaxed); }
+
+    static size_t bin(size_t probes) { return probes < histogram_size ? probes : histogram_size - 1; }
+
+    void copy_from(const TableStats& other) {
+        for (size_t i = 0; i < histogram_size; ++i) {
+            lookup_probes[i].store(read(other.lookup_probes[i]), std::memory_order_relaxed);
+            insert_probes[i].store(read(other.insert_probes[i]), std::memory_order_relaxed);
+        }
+        hits.store(read(other.hits), std::memory_order_relaxed);
+        misses.store(read(other.misses), std::memory_order_relaxed);
+        grows.store(read(other.grows), std::memory_order_relaxed);
+        grow_nanoseconds.store(read(other.grow_nanoseconds), std::memory_order_relaxed);
+        node_bytes.store(read(other.node_bytes), std::memory_order_relaxed);
+        bucket_bytes.store(read(other.bucket_bytes), std::memory_order_relaxed);
+    }
+
+public:
+    static constexpr bool enabled = true;
+
+    TableStats() = default;
+    TableStats(const TableStats& other) { copy_from(other); }
+    TableStats& operator=(const TableStats& other) {
+        if (this != &other) copy_from(other);
+        return *this;
+    }
+
+    void on_lookup(size_t probes, bool hit) {
+        add(lookup_probes[bin(probes)], 1);
+        add(hit ? hits : misses, 1);
+    }
+    void on_insert(size_t probes) { add(insert_probes[bin(probes)], 1); }
+    void on_grow(std::chrono::nanoseconds duration) {
+        add(grows, 1);
+        add(grow_nanoseconds, static_cast<uint64_t>(duration.count()));
+    }
+    void on_allocate(size_t bytes) { add(node_bytes, bytes); }
+    void on_free(size_t bytes) { node_bytes.fetch_sub(bytes, std::memory_order_relaxed); }
+    void on_allocate_buckets(size_t bytes) { add(bucket_bytes, bytes); }
+    void on_free_buckets(size_t bytes) { bucket_bytes.fetch_sub(bytes, std::memory_order_relaxed); }
+    void on_clear() {
+        node_bytes.store(0, std::memory_order_relaxed);
+        bucket_bytes.store(0, std::memory_order_relaxed);
+    }
+
+    void fill(TableStatsSnapshot& snapshot) const {
+        for (size_t i = 0; i < histogram_size; ++i) {
+            snapshot.lookup_probes[i] = read(lookup_probes[i]);
+            snapshot.insert_probes[i] = read(insert_probes[i]);
+        }
+        snapshot.hits = read(hits);
+        snapshot.misses = read(misses);
+        snapshot.grows = read(grows);
+        snapshot.grow_time = std::chrono::nanoseconds(read(grow_nanoseconds));
+        snapshot.node_bytes = read(node_bytes);
+        snapshot.bucket_bytes = read(bucket_bytes);
+    }
+};
+
+
+#endif // TABLE_STATS_HPP
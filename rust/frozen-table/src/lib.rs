@@ -0,0 +1,355 @@
+//! Reader for frozen table images (`docs/frozen_format.md`), the files the
+//! C++ `frozen::freeze` / `frozen_gen` write and `MappedHashTable` (C++)
+//! and `c/frozen_table.h` (C) read.
+//!
+//! Lookups run on the image bytes in place: map the file with
+//! [`MappedFile`] and every process using it, whatever its language,
+//! shares the same pages.
+//!
+//! ```no_run
+//! use frozen_table::{FrozenTable, MappedFile};
+//!
+//! let file = MappedFile::open("colors.frozen")?;
+//! let colors = FrozenTable::new(file.as_bytes())?;
+//! if let Some(value) = colors.get(b"red")? {
+//!     let id = u32::from_le_bytes(value.try_into().unwrap());
+//! }
+//! # Ok::<(), Box<dyn std::error::Error>>(())
+//! ```
+//!
+//! Keys are looked up by their encoded bytes: strings as their bytes,
+//! integers as their little-endian bytes at their width
+//! (`&key.to_le_bytes()`).
+
+use std::fmt;
+
+pub const VERSION: u32 = 1;
+pub const HEADER_SIZE: usize = 80;
+pub const ENTRY_SIZE: usize = 32;
+const MAGIC: &[u8; 8] = b"CTHFROZ\0";
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Error {
+    /// Shorter than its header.
+    TooShort,
+    BadMagic,
+    UnsupportedVersion(u32),
+    /// Zero or not a power of two.
+    BadBucketCount,
+    /// A section, bucket or entry points outside the image.
+    OutOfBounds(&'static str),
+}
+
+impl fmt::Display for Error {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        match self {
+            Error::TooShort => write!(f, "invalid frozen table: shorter than its header"),
+            Error::BadMagic => write!(f, "invalid frozen table: bad magic"),
+            Error::UnsupportedVersion(v) => write!(f, "invalid frozen table: unsupported version {v}"),
+            Error::BadBucketCount => write!(f, "invalid frozen table: bucket count"),
+            Error::OutOfBounds(what) => write!(f, "invalid frozen table: {what} out of bounds"),
+        }
+    }
+}
+
+impl std::error::Error for Error {}
+
+fn load_u32(bytes: &[u8], at: usize) -> u32 {
+    u32::from_le_bytes(bytes[at..at + 4].try_into().unwrap())
+}
+
+fn load_u64(bytes: &[u8], at: usize) -> u64 {
+    u64::from_le_bytes(bytes[at..at + 8].try_into().unwrap())
+}
+
+const WYP: [u64; 4] = [0x2d358dccaa6c78a5, 0x8bb84b93962eacc9, 0x4b33a62ed433d4a3, 0x4d5a2da51de1aa47];
+
+fn mum(a: u64, b: u64) -> (u64, u64) {
+    let r = u128::from(a) * u128::from(b);
+    (r as u64, (r >> 64) as u64)
+}
+
+fn mix(a: u64, b: u64) -> u64 {
+    let (lo, hi) = mum(a, b);
+    lo ^ hi
+}
+
+/// wyhash (final4), bit for bit `hash_policy::wyhash` in C++.
+pub fn wyhash(key: &[u8], mut seed: u64) -> u64 {
+    let len = key.len();
+    seed ^= mix(seed ^ WYP[0], WYP[1]);
+    let (mut a, mut b);
+    if len <= 16 {
+        if len >= 4 {
+            let quarter = (len >> 3) << 2;
+            a = u64::from(load_u32(key, 0)) << 32 | u64::from(load_u32(key, quarter));
+            b = u64::from(load_u32(key, len - 4)) << 32 | u64::from(load_u32(key, len - 4 - quarter));
+        } else if len > 0 {
+            a = u64::from(key[0]) << 16 | u64::from(key[len >> 1]) << 8 | u64::from(key[len - 1]);
+            b = 0;
+        } else {
+            a = 0;
+            b = 0;
+        }
+    } else {
+        let (mut p, mut i) = (0, len);
+        if i >= 48 {
+            let (mut see1, mut see2) = (seed, seed);
+            while i >= 48 {
+                seed = mix(load_u64(key, p) ^ WYP[1], load_u64(key, p + 8) ^ seed);
+                see1 = mix(load_u64(key, p + 16) ^ WYP[2], load_u64(key, p + 24) ^ see1);
+                see2 = mix(load_u64(key, p + 32) ^ WYP[3], load_u64(key, p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            }
+            seed ^= see1 ^ see2;
+        }
+        while i > 16 {
+            seed = mix(load_u64(key, p) ^ WYP[1], load_u64(key, p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = load_u64(key, p + i - 16);
+        b = load_u64(key, p + i - 8);
+    }
+    (a, b) = mum(a ^ WYP[1], b ^ seed);
+    mix(a ^ WYP[0] ^ len as u64, b ^ WYP[1])
+}
+
+/// A frozen table read in place from its image bytes.
+#[derive(Debug, Clone, Copy)]
+pub struct FrozenTable<'a> {
+    seed: u64,
+    bucket_mask: u64,
+    entry_count: u64,
+    buckets: &'a [u8],
+    entries: &'a [u8],
+    blob: &'a [u8],
+}
+
+impl<'a> FrozenTable<'a> {
+    /// Check the header and every section against the image size, so a
+    /// truncated or corrupt image is rejected here rather than read out of
+    /// bounds later. Entry offsets are checked when an entry is read.
+    pub fn new(image: &'a [u8]) -> Result<Self, Error> {
+        if image.len() < HEADER_SIZE {
+            return Err(Error::TooShort);
+        }
+        if &image[..8] != MAGIC {
+            return Err(Error::BadMagic);
+        }
+        let version = load_u32(image, 8);
+        if version != VERSION {
+            return Err(Error::UnsupportedVersion(version));
+        }
+        let seed = load_u64(image, 16);
+        let bucket_count = load_u64(image, 24);
+        let entry_count = load_u64(image, 32);
+        let section = |offset: u64, size: Option<u64>, what| -> Result<&'a [u8], Error> {
+            let start = usize::try_from(offset).map_err(|_| Error::OutOfBounds(what))?;
+            let size = size
+                .and_then(|s| usize::try_from(s).ok())
+                .ok_or(Error::OutOfBounds(what))?;
+            let end = start.checked_add(size).ok_or(Error::OutOfBounds(what))?;
+            image.get(start..end).ok_or(Error::OutOfBounds(what))
+        };
+
+        if !bucket_count.is_power_of_two() {
+            return Err(Error::BadBucketCount);
+        }
+        if entry_count > u64::from(u32::MAX) {
+            return Err(Error::OutOfBounds("entries"));
+        }
+        let buckets = section(load_u64(image, 40), bucket_count.checked_add(1).and_then(|n| n.checked_mul(4)), "bucket array")?;
+        let entries = section(load_u64(image, 48), entry_count.checked_mul(ENTRY_SIZE as u64), "entries")?;
+        let blob = section(load_u64(image, 56), Some(load_u64(image, 64)), "blob")?;
+        if load_u32(buckets, 0) != 0 || u64::from(load_u32(buckets, buckets.len() - 4)) != entry_count {
+            return Err(Error::OutOfBounds("bucket array"));
+        }
+        Ok(FrozenTable { seed, bucket_mask: bucket_count - 1, entry_count, buckets, entries, blob })
+    }
+
+    pub fn len(&self) -> usize {
+        self.entry_count as usize
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.entry_count == 0
+    }
+
+    pub fn bucket_count(&self) -> usize {
+        (self.bucket_mask + 1) as usize
+    }
+
+    pub fn seed(&self) -> u64 {
+        self.seed
+    }
+
+    fn blob_slice(&self, offset: u64, size: u32) -> Result<&'a [u8], Error> {
+        let start = usize::try_from(offset).map_err(|_| Error::OutOfBounds("entry"))?;
+        let end = start.checked_add(size as usize).ok_or(Error::OutOfBounds("entry"))?;
+        self.blob.get(start..end).ok_or(Error::OutOfBounds("entry"))
+    }
+
+    /// Value bytes of `key`, borrowed from the image.
+    pub fn get(&self, key: &[u8]) -> Result<Option<&'a [u8]>, Error> {
+        let h = wyhash(key, self.seed);
+        let b = (h & self.bucket_mask) as usize;
+        let first = load_u32(self.buckets, 4 * b) as usize;
+        let last = load_u32(self.buckets, 4 * (b + 1)) as usize;
+        if last as u64 > self.entry_count || first > last {
+            return Err(Error::OutOfBounds("bucket"));
+        }
+        for entry in self.entries[first * ENTRY_SIZE..last * ENTRY_SIZE].chunks_exact(ENTRY_SIZE) {
+            if load_u64(entry, 0) != h {
+                continue;
+            }
+            if self.blob_slice(load_u64(entry, 8), load_u32(entry, 24))? != key {
+                continue;
+            }
+            return self.blob_slice(load_u64(entry, 16), load_u32(entry, 28)).map(Some);
+        }
+        Ok(None)
+    }
+
+    pub fn contains(&self, key: &[u8]) -> Result<bool, Error> {
+        self.get(key).map(|v| v.is_some())
+    }
+}
+
+#[cfg(unix)]
+mod mapped {
+    use std::ffi::c_void;
+    use std::fs::File;
+    use std::io;
+    use std::os::unix::io::AsRawFd;
+    use std::path::Path;
+
+    const PROT_READ: i32 = 1;
+    const MAP_SHARED: i32 = 1;
+
+    extern "C" {
+        fn mmap(addr: *mut c_void, len: usize, prot: i32, flags: i32, fd: i32, offset: isize) -> *mut c_void;
+        fn munmap(addr: *mut c_void, len: usize) -> i32;
+    }
+
+    /// A file mapped read-only and shared, unmapped on drop.
+    pub struct MappedFile {
+        ptr: *mut c_void,
+        len: usize,
+    }
+
+    // The mapping is read-only, so sharing it between threads is safe.
+    unsafe impl Send for MappedFile {}
+    unsafe impl Sync for MappedFile {}
+
+    impl MappedFile {
+        pub fn open(path: impl AsRef<Path>) -> io::Result<MappedFile> {
+            let file = File::open(path)?;
+            let len = usize::try_from(file.metadata()?.len())
+                .map_err(|_| io::Error::new(io::ErrorKind::InvalidData, "file too large to map"))?;
+            if len == 0 {
+                return Ok(MappedFile { ptr: std::ptr::null_mut(), len });
+            }
+            // SAFETY: a fresh read-only shared mapping of an open file;
+            // the descriptor may be closed once mmap returns.
+            let ptr = unsafe { mmap(std::ptr::null_mut(), len, PROT_READ, MAP_SHARED, file.as_raw_fd(), 0) };
+            if ptr as isize == -1 {
+                return Err(io::Error::last_os_error());
+            }
+            Ok(MappedFile { ptr, len })
+        }
+
+        pub fn as_bytes(&self) -> &[u8] {
+            if self.ptr.is_null() {
+                return &[];
+            }
+            // SAFETY: ptr maps len readable bytes for as long as self lives.
+            unsafe { std::slice::from_raw_parts(self.ptr as *const u8, self.len) }
+        }
+    }
+
+    impl Drop for MappedFile {
+        fn drop(&mut self) {
+            if !self.ptr.is_null() {
+                // SAFETY: unmapping the mapping created in open().
+                unsafe { munmap(self.ptr, self.len) };
+            }
+        }
+    }
+}
+
+#[cfg(unix)]
+pub use mapped::MappedFile;
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    const GOLDEN: &[u8] = include_bytes!("../../../testdata/frozen_v1.bin");
+    const GOLDEN_TSV: &str = include_str!("../../../testdata/frozen_v1.tsv");
+
+    #[test]
+    fn hash_vectors() {
+        let vectors: [(usize, u64, u64); 14] = [
+            (0, 0x93228a4de0eec5a2, 0x2ac44db3deb05300),
+            (1, 0x8e6d4af7d310c8c4, 0x033b5aab97d9c425),
+            (3, 0x78c4aa0c972a522d, 0xce9d66a797307f94),
+            (4, 0xe08aeeb68058fb32, 0xd97d61b5206c8513),
+            (8, 0xb4d6ac74d009e1d4, 0x3ed6827b249c2f37),
+            (15, 0x87edaf96d89a08ef, 0xa3945aeea738f410),
+            (16, 0x305fdea0ed4a2619, 0x9dbc2356533b4014),
+            (17, 0xd29ffdd201a46f9a, 0x56e46ac1a9175c52),
+            (47, 0xe2cb58f6ab8e4419, 0xff37cfbd5256d21c),
+            (48, 0xecbfb7ff9e3d9a97, 0x827717ed2564ebb4),
+            (49, 0x0691f11bac523a91, 0x7815fc5b6d4b56bc),
+            (96, 0x948137d69794b570, 0x174effdbb7ffa0b0),
+            (100, 0x77ed9a7dfb9ac9b7, 0x8ad7f73a16686981),
+            (256, 0x139c96a974ad43cb, 0xf9a18ee9194a4507),
+        ];
+        let bytes: Vec<u8> = (0..=255u8).collect();
+        for (len, seed0, seed42) in vectors {
+            assert_eq!(wyhash(&bytes[..len], 0), seed0, "len {len}, seed 0");
+            assert_eq!(wyhash(&bytes[..len], 42), seed42, "len {len}, seed 42");
+        }
+    }
+
+    #[test]
+    fn golden_image() {
+        let table = FrozenTable::new(GOLDEN).unwrap();
+        assert_eq!(table.seed(), 42);
+        let mut lines = 0;
+        for line in GOLDEN_TSV.lines().filter(|l| !l.is_empty()) {
+            let (key, value) = line.split_once('\t').unwrap();
+            let stored = table.get(key.as_bytes()).unwrap().expect(key);
+            assert_eq!(u32::from_le_bytes(stored.try_into().unwrap()), value.parse::<u32>().unwrap());
+            lines += 1;
+        }
+        assert_eq!(table.len(), lines);
+        assert_eq!(table.get(b"nope"), Ok(None));
+        assert_eq!(table.contains(b"red\0"), Ok(false));
+    }
+
+    #[test]
+    fn corrupt_images() {
+        assert_eq!(FrozenTable::new(&GOLDEN[..40]).unwrap_err(), Error::TooShort);
+        assert!(FrozenTable::new(&GOLDEN[..GOLDEN.len() - 8]).is_err());
+        let mut copy = GOLDEN.to_vec();
+        copy[8] = 2;
+        assert_eq!(FrozenTable::new(&copy).unwrap_err(), Error::UnsupportedVersion(2));
+        copy[8] = 1;
+        copy[24..32].copy_from_slice(&3u64.to_le_bytes());
+        assert_eq!(FrozenTable::new(&copy).unwrap_err(), Error::BadBucketCount);
+    }
+
+    #[cfg(unix)]
+    #[test]
+    fn mapped_file() {
+        let path = concat!(env!("CARGO_MANIFEST_DIR"), "/../../testdata/frozen_v1.bin");
+        let file = MappedFile::open(path).unwrap();
+        assert_eq!(file.as_bytes(), GOLDEN);
+        let table = FrozenTable::new(file.as_bytes()).unwrap();
+        assert!(table.contains(b"red").unwrap());
+        assert!(MappedFile::open("/nonexistent/frozen.bin").is_err());
+    }
+}